@@ -50,6 +50,8 @@ static renderer_t _renderer_pbr = {
   .entity_attributes  = renderer_callback_entity_attributes,
   .instance_update    = renderer_callback_instance_update,
   .render             = renderer_callback_render,
+  .buffer_mode        = RENDERER_BUFFER_RING,
+  .frustum_cull       = true,
 };
 renderer_t* renderer_pbr = &_renderer_pbr;
 
@@ -91,8 +93,11 @@ static keybind_t input_map[] = {
   { .name = IN_LEVEL_1, .key = '1' },
   { .name = IN_LEVEL_2, .key = '2' },
   { .name = IN_LEVEL_3, .key = '3' },
+  { .name = IN_LEVEL_4, .key = '4' },
   { .name = IN_TOGGLE_SHADER, .key = 'm' },
   { .name = IN_TOGGLE_GRID, .key = 'g' },
+  { .name = IN_TOGGLE_CLUSTERS, .key = 'l' },
+  { .name = IN_TOGGLE_CULLING, .key = 'k' },
   { .name = IN_TOGGLE_LOCK, .key = SDLK_ESCAPE },
   { .name = IN_TOGGLE_UI, .key = SDLK_F2 },
   { .name = IN_INCREASE, .key = SDLK_UP },
@@ -110,6 +115,7 @@ static scene_load_fn_t demo_scenes[] =
 { scene_load_gears
 , scene_load_wizard
 , scene_load_monument
+, scene_load_lights
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -155,7 +161,7 @@ static void cheesy_loading_animation(Game game, float dt) {
   mat4 projview = camera_projection_view(&game->camera);
 
   shader_bind(demo.shaders.loading);
-  int loc_pvm = shader_uniform_loc(demo.shaders.loading, "in_pvm_matrix");
+  int loc_pvm = shader_uniform_id(demo.shaders.loading, SV_IN_PVM_MATRIX);
 
   mat4 model = m4translation(v3f(0, 0, -3));
   model = m4mul(model, m4rotation(v3norm(v3f(1.f, 1.5f, -.7f)), cubespin));
@@ -340,30 +346,27 @@ void wasp_render(Game game) {
     shader = demo.shaders.warhol;
   }
 
-  Texture lights = tex_from_lights();
   shader_bind(shader);
-  int tex_sampler = shader_uniform_loc(shader, "samp_tex");
-  int norm_sampler = shader_uniform_loc(shader, "samp_norm");
-  int prop_sampler = shader_uniform_loc(shader, "samp_prop");
-  int depth_sampler = shader_uniform_loc(shader, "samp_depth");
-  int light_sampler = shader_uniform_loc(shader, "samp_light");
-  int loc_invproj = shader_uniform_loc(shader, "in_proj_inverse");
+  int tex_sampler = shader_uniform_id(shader, SV_SAMP_TEX);
+  int norm_sampler = shader_uniform_id(shader, SV_SAMP_NORM);
+  int prop_sampler = shader_uniform_id(shader, SV_SAMP_PROP);
+  int depth_sampler = shader_uniform_id(shader, SV_SAMP_DEPTH);
+  int light_sampler = shader_uniform_id(shader, SV_SAMP_LIGHT);
+  int light_count_loc = shader_uniform_id(shader, SV_IN_LIGHT_COUNT);
   tex_apply(demo.render_target->textures[0], 0, tex_sampler);
   tex_apply(demo.render_target->textures[1], 1, norm_sampler);
   tex_apply(demo.render_target->textures[2], 2, prop_sampler);
   tex_apply(demo.render_target->textures[3], 3, depth_sampler);
-  tex_apply(lights, 4, light_sampler);
-  glUniformMatrix4fv(loc_invproj, 1, 0, m4inverse(game->camera.projection).f);
+  light_buffer_bind(4, light_sampler, light_count_loc);
+  light_clusters_bind(shader, 5);
 
   model_render(demo.models.frame);
 
   if (!i2eq(game->resolution, game->window)) {
     rt_bind_clear_default();
     shader_bind(demo.shaders.pass);
-    int frame_sampler = shader_uniform_loc(demo.shaders.pass, "samp_frame");
+    int frame_sampler = shader_uniform_id(demo.shaders.pass, SV_SAMP_FRAME);
     tex_apply(demo.render_target_scaled->textures[0], 0, frame_sampler);
     model_render(demo.models.frame);
   }
-
-  tex_delete(&lights);
 }
@@ -117,6 +117,7 @@ enum demo_key_t {
   IN_LEVEL_1,
   IN_LEVEL_2,
   IN_LEVEL_3,
+  IN_LEVEL_4,
   LEVEL_COUNT,
 
   IN_JUMP,
@@ -138,6 +139,8 @@ enum demo_key_t {
   IN_RELOAD,
   IN_TOGGLE_SHADER,
   IN_TOGGLE_GRID,
+  IN_TOGGLE_CLUSTERS,
+  IN_TOGGLE_CULLING,
   IN_TOGGLE_LOCK,
   IN_TOGGLE_UI,
   IN_INCREASE,
@@ -153,6 +156,7 @@ enum demo_key_t {
 scene_unload_fn_t scene_load_gears(Game game);
 scene_unload_fn_t scene_load_wizard(Game game);
 scene_unload_fn_t scene_load_monument(Game game);
+scene_unload_fn_t scene_load_lights(Game game);
 
 ////////////////////////////////////////////////////////////////////////////////
 // Specialized event handlers
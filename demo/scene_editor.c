@@ -917,12 +917,12 @@ void _editor_panel_entity_model(Game game, Entity entity) {
 
       if (entity->model) {
 
-        Array_slice model_names = model_get_names_inst();
+        view_slice_t model_names = model_get_names_inst();
 
-        if (!arr_slice_is_null_or_empty(model_names)) {
+        if (view_slice_size(model_names) > 0) {
           if (igBeginCombo("##model_select", entity->model->name.begin, 0)) {
-            slice_t* arr_foreach(name, model_names) {
-              bool is_selected = slice_eq(*name, entity->material->name);
+            const slice_t* view_foreach(name, model_names) {
+              bool is_selected = slice_eq(*name, entity->model->name);
               if (igSelectable_Bool(name->begin, is_selected, 0, v2imzero)) {
                 Model new_model = model_get(*name);
                 entity_set_model(entity, new_model);
@@ -931,8 +931,6 @@ void _editor_panel_entity_model(Game game, Entity entity) {
             igEndCombo();
           }
         }
-
-        arr_slice_delete(&model_names);
       }
 
       igEndChild();
@@ -953,11 +951,11 @@ void _editor_panel_entity_material(Game game, Entity entity) {
       igBeginChild_Str("panel_material", v2imsubmenu, child_flags, 0);
 
       if (entity->material) {
-        Array_slice material_names = mat_get_names();
+        view_slice_t material_names = mat_get_names();
 
-        if (!arr_slice_is_null_or_empty(material_names)) {
+        if (view_slice_size(material_names) > 0) {
           if (igBeginCombo("##material_select", entity->material->name.begin, 0)) {
-            slice_t* arr_foreach(name, material_names) {
+            const slice_t* view_foreach(name, material_names) {
               bool is_selected = slice_eq(*name, entity->material->name);
               if (igSelectable_Bool(name->begin, is_selected, 0, v2imzero)) {
                 Material new_material = mat_get(*name);
@@ -967,8 +965,6 @@ void _editor_panel_entity_material(Game game, Entity entity) {
             igEndCombo();
           }
         }
-
-        arr_slice_delete(&material_names);
       }
       else {
         igText("None");
@@ -1036,6 +1032,13 @@ void _editor_panel_effect(Game game, ParticleEffect effect) {
       str_delete(&new_name);
     }
 
+    const particle_stats_t* stats = &effect->stats;
+    igText("Particles: %d / %d", (int)stats->count, (int)stats->capacity);
+    igText("Peak: %d", (int)stats->peak);
+    igText("Spawned: %d", (int)stats->spawned);
+    igText("Dropped: %d", (int)stats->dropped);
+    igText("Recycled: %d", (int)stats->recycled);
+    igText("Memory: %.1f KiB", (double)stats->bytes / 1024.0);
   }
 
   igEnd();
@@ -1280,6 +1283,10 @@ void behavior_grid_toggle(Game game, entity_t* e, float dt) {
     game->next_scene = 2;
   }
 
+  if (input_triggered(IN_LEVEL_4)) {
+    game->next_scene = 3;
+  }
+
   if (game->input.touch.count == 3 && game->input.touch.third->released) {
     vec2 pos = game->input.touch.third->pos;
     vec2 origin = game->input.touch.third->origin;
@@ -1387,9 +1394,12 @@ void behavior_attach_to_camera_target(Game game, entity_t* e, float dt) {
       game->demo->materials.renderite,
     };
 
-    vec3 ray = camera_ray(&game->camera, game->input.mouse.pos);
+    // stack onto whatever is under the cursor, or place on the ground plane
+    vec3 ray = v3norm(camera_ray(&game->camera, game->input.mouse.pos));
     float t;
-    if (v3ray_plane(game->camera.pos, ray, v3origin, v3up, &t)) {
+    if (entity_raycast(game->camera.pos, ray, CAMERA_DEFAULT_FAR, &t)
+    ||  v3ray_plane(game->camera.pos, ray, v3origin, v3up, &t)
+    ) {
       entity_add(&(entity_desc_t) {
         .model = game->demo->models.box,
         .material = mats[(uint)e->pos.x % 6],
@@ -1409,7 +1419,7 @@ void render_basic(Game game, entity_t* e) {
   Shader shader = game->demo->shaders.basic;
   if (!shader_bind(shader)) return;
 
-  int loc_pvm = shader_uniform_loc(shader, "in_pvm_matrix");
+  int loc_pvm = shader_uniform_id(shader, SV_IN_PVM_MATRIX);
 
   mat4 pvm = m4mul(game->camera.projview, entity_transform(e));
   glUniformMatrix4fv(loc_pvm, 1, GL_FALSE, pvm.f);
@@ -1437,16 +1447,16 @@ void render_pbr(Game game, entity_t* e) {
   // Per-object properties
 
   // Model positioning
-  int loc_pvm = shader_uniform_loc(shader, "in_pvm_matrix");
+  int loc_pvm = shader_uniform_id(shader, SV_IN_PVM_MATRIX);
 
   // Material properties
-  int loc_sampler_tex = shader_uniform_loc(shader, "samp_tex");
-  int loc_sampler_norm = shader_uniform_loc(shader, "samp_norm");
-  int loc_sampler_rough = shader_uniform_loc(shader, "samp_rough");
-  int loc_sampler_metal = shader_uniform_loc(shader, "samp_metal");
-  int loc_norm = shader_uniform_loc(shader, "in_normal_matrix");
-  int loc_props = shader_uniform_loc(shader, "in_weights");
-  int loc_tint = shader_uniform_loc(shader, "in_tint");
+  int loc_sampler_tex = shader_uniform_id(shader, SV_SAMP_TEX);
+  int loc_sampler_norm = shader_uniform_id(shader, SV_SAMP_NORM);
+  int loc_sampler_rough = shader_uniform_id(shader, SV_SAMP_ROUGH);
+  int loc_sampler_metal = shader_uniform_id(shader, SV_SAMP_METAL);
+  int loc_norm = shader_uniform_id(shader, SV_IN_NORMAL_MATRIX);
+  int loc_props = shader_uniform_id(shader, SV_IN_WEIGHTS);
+  int loc_tint = shader_uniform_id(shader, SV_IN_TINT);
 
   mat4 transform = entity_transform(e);
   mat4 pvm = m4mul(game->camera.projview, transform);
@@ -1473,7 +1483,7 @@ void render_pbr(Game game, entity_t* e) {
 
   model_render(e->model);
 
-  glBindTexture(GL_TEXTURE_2D, 0);
+  gl_bind_texture(GL_TEXTURE_2D, 0);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1713,7 +1723,7 @@ scene_unload_fn_t scene_load_gears(Game game) {
 
   //* Particle test
   ParticleEffect effect = ps_add_effect(
-    game->particle_system, S("test"), PF_DEFAULT, EF_DEFAULT
+    game->particle_system, S("test"), PF_DEFAULT, EF_PARALLEL | EF_SOA
   );
 
   effect->emitter_defaults.duration = 0;
@@ -1726,6 +1736,7 @@ scene_unload_fn_t scene_load_gears(Game game) {
   effect->emitter_defaults.particle_variance.duration = 1.f;
   effect->on_particle_update = pb_gravity;
   effect->emitter_defaults.dir = q4axang(v3x, PI / 2.f);
+  ps_set_effect_budget(effect, 256, PO_RECYCLE);
 
   ParticleEmitter emitter = ps_add_emitter(effect);
   emitter->entity_id = crate_id;
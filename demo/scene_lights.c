@@ -0,0 +1,190 @@
+/*******************************************************************************
+* MIT License
+*
+* Copyright (c) 2026 Curtis McCoy
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "demo.h"
+#include "light.h"
+#include "graphics.h"
+#include "utility.h"
+#include "str.h"
+
+#include <math.h>
+
+#define LIGHTS_GRID       32
+#define LIGHTS_COUNT      (LIGHTS_GRID * LIGHTS_GRID)
+#define LIGHTS_SPACING    12.f
+#define LIGHTS_PILLARS    24
+#define LIGHTS_LOG_TIME   2.f
+
+typedef struct scene_light_t {
+  slotkey_t id;
+  vec3      base;
+  float     phase;
+  float     speed;
+} scene_light_t;
+
+static scene_light_t scene_lights[LIGHTS_COUNT];
+
+static float stat_time = 0;
+static int stat_frames = 0;
+
+////////////////////////////////////////////////////////////////////////////////
+// Drifts the lights around their starting points and reports frame times
+////////////////////////////////////////////////////////////////////////////////
+
+void _behavior_lights_benchmark(Game game, entity_t* e, float dt) {
+  UNUSED(e);
+
+  float t = game->scene_time;
+
+  for (int i = 0; i < LIGHTS_COUNT; ++i) {
+    scene_light_t* sl = &scene_lights[i];
+    light_t* light = light_ref(sl->id);
+    if (!light) continue;
+
+    float a = t * sl->speed + sl->phase;
+    light->pos = v3add(sl->base, v3f(cosf(a) * 4.f, sinf(a * 2.f), sinf(a) * 4.f));
+  }
+
+  // Slow orbit around the middle of the field
+  float orbit = t * 0.1f;
+  float extent = LIGHTS_GRID * LIGHTS_SPACING * 0.6f;
+  game->camera.pos = v3f(cosf(orbit) * extent, 60.f, sinf(orbit) * extent);
+  camera_look_at(&game->camera, v3f(0, 0, 0));
+
+  if (input_triggered(IN_TOGGLE_CLUSTERS)) {
+    light_set_clustering(!light_get_clustering());
+    stat_time = 0;
+    stat_frames = 0;
+  }
+
+  stat_time += dt;
+  ++stat_frames;
+
+  if (stat_time >= LIGHTS_LOG_TIME) {
+    str_log("[Game.lights] {} lights, clustered: {}, avg frame: {:.2}ms",
+      light_count(), light_get_clustering() ? "yes" : "no",
+      stat_time * 1000.f / (float)stat_frames
+    );
+    stat_time = 0;
+    stat_frames = 0;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Scene unload function returned by the scene loader
+////////////////////////////////////////////////////////////////////////////////
+
+void _scene_unload_lights(Game game) {
+  UNUSED(game);
+  light_set_clustering(true);
+  gfx_set_vsync(true);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Loading function to initialize the scene
+////////////////////////////////////////////////////////////////////////////////
+
+scene_unload_fn_t scene_load_lights(Game game) {
+
+  demo_t* demo = game->demo;
+
+  // Uncapped frame rate so the timings reflect the lighting cost
+  gfx_set_vsync(false);
+  stat_time = 0;
+  stat_frames = 0;
+
+  game->camera.pos = v3f(0, 60, 200);
+  game->camera.front = v3front;
+  game->demo->target = v3origin;
+  camera_look_at(&game->camera, game->demo->target);
+
+  // Debug Renderer
+  entity_add(&(entity_desc_t) {
+    .model = demo->models.grid,
+    .onrender = render_debug,
+    .is_hidden = true,
+    .behavior = behavior_grid_toggle,
+  });
+
+  // Benchmark controller
+  entity_add(&(entity_desc_t) {
+    .behavior = _behavior_lights_benchmark,
+  });
+
+  float field = LIGHTS_GRID * LIGHTS_SPACING;
+
+  // Floor
+  entity_add(&(entity_desc_t) {
+    .model = demo->models.box,
+    .material = demo->materials.tiles,
+    .tint = b4white,
+    .pos = v3f(0, -field / 2.f, 0),
+    .scale = field,
+    .renderer = renderer_pbr,
+    .is_static = true,
+  });
+
+  // Pillars to catch the light
+  float pillar_spacing = field / LIGHTS_PILLARS;
+  for (int z = 0; z < LIGHTS_PILLARS; ++z) {
+    for (int x = 0; x < LIGHTS_PILLARS; ++x) {
+      vec3 pos = v3f(
+        ((float)x + 0.5f) * pillar_spacing - field / 2.f, 2.f,
+        ((float)z + 0.5f) * pillar_spacing - field / 2.f
+      );
+
+      entity_add(&(entity_desc_t) {
+        .model = demo->models.box,
+        .material = demo->materials.mudds,
+        .tint = b4white,
+        .pos = pos,
+        .scale = 4.f,
+        .renderer = renderer_pbr,
+        .is_static = true,
+      });
+    }
+  }
+
+  // A field of small, dim lights
+  for (int z = 0; z < LIGHTS_GRID; ++z) {
+    for (int x = 0; x < LIGHTS_GRID; ++x) {
+      scene_light_t* sl = &scene_lights[z * LIGHTS_GRID + x];
+
+      sl->base = v3f(
+        ((float)x + 0.5f) * LIGHTS_SPACING - field / 2.f, 3.f,
+        ((float)z + 0.5f) * LIGHTS_SPACING - field / 2.f
+      );
+      sl->phase = frand() * 6.283f;
+      sl->speed = frand_r(0.5f, 1.5f);
+
+      sl->id = light_add((light_t) {
+        .intensity = 20.0f,
+        .pos = sl->base,
+        .color = v3f(frand_r(0.2f, 1.f), frand_r(0.2f, 1.f), frand_r(0.2f, 1.f)),
+      });
+    }
+  }
+
+  return _scene_unload_lights;
+}
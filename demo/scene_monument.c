@@ -30,12 +30,14 @@
 #include "str.h"
 
 #define PLANE_SPEED_MIN 30.f
+#define CULL_LOG_TIME 2.f
 
 slotkey_t monument_light_left;
 slotkey_t monument_light_right;
 slotkey_t monument_light_spot;
 
 static float plane_speed = PLANE_SPEED_MIN;
+static float cull_log_time = 0;
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -143,6 +145,26 @@ void _behavior_camera_monument(Game game, entity_t* e, float dt) {
     light_spot->pos = game->camera.pos;
     light_spot->dir = game->camera.front;
   }
+
+  if (input_triggered(IN_TOGGLE_CULLING)) {
+    renderer_pbr->frustum_cull = !renderer_pbr->frustum_cull;
+    cull_log_time = CULL_LOG_TIME;
+  }
+
+  cull_log_time += dt;
+
+  if (cull_log_time >= CULL_LOG_TIME) {
+    renderer_stats_t stats = renderer_pbr->stats;
+    str_log("[Game.monument] Culling: {}, drawn: {}, culled: {} of {}",
+      renderer_pbr->frustum_cull ? "on" : "off",
+      stats.instances_drawn, stats.instances_culled, stats.instances_total
+    );
+    gl_state_stats_t gl_stats = gl_state_stats();
+    str_log("[Game.monument] GL state calls issued: {}, skipped: {}",
+      gl_stats.issued, gl_stats.skipped
+    );
+    cull_log_time = 0;
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -265,6 +265,7 @@ static void _wizard_baddies(Game game, entity_t* e, float dt) {
       .tint = v4cv(v4f(1.0f, 0.6f, 0.6f, 1.0f)),
       .renderer = renderer_pbr,
       .behavior = _behavior_baddy,
+      .is_parallel = true,
     });
   }
 }
@@ -0,0 +1,84 @@
+/*******************************************************************************
+* MIT License
+*
+* Copyright (c) 2026 Curtis McCoy
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#ifndef WASP_ASSET_H_
+#define WASP_ASSET_H_
+
+#include "types.h"
+#include "slice.h"
+
+// Registry of loaded assets keyed by their (normalized) file path, so each file
+//    is loaded once no matter how many users ask for it.
+//
+// An asset is kept alive by references:
+//    - explicit ones from asset_retain/asset_release, for owners that finish
+//      with it at a known time (a material with the images it's built from)
+//    - a scene hold from asset_hold, taken by loaders when the active scene
+//      asks for the asset. Holds taken at startup, before the first scene
+//      loads, keep the asset loaded for good.
+//
+// When a scene switch happens the next scene is loaded before the previous
+//    scene's holds are dropped, so anything both scenes use stays loaded.
+//    Once nothing references an asset, it's deleted with its free function.
+//    Assets registered without one stay cached for the next scene that wants
+//    them.
+
+typedef enum asset_type_t {
+  ASSET_IMAGE,
+  ASSET_MODEL,
+  ASSET_TYPES_COUNT
+} asset_type_t;
+
+typedef void (*asset_free_fn_t)(void* handle);
+
+// \brief Finds a loaded asset by path, without taking a reference.
+// \returns the asset's handle, or NULL if it's not loaded.
+void*   asset_get(asset_type_t type, slice_t path);
+
+// \brief Registers a newly loaded asset with no references yet.
+// \param free_fn deletes the asset when its last reference is released, or
+//    NULL to keep it cached instead.
+void    asset_insert(
+  asset_type_t type, slice_t path, void* handle, asset_free_fn_t free_fn
+);
+
+// \brief Drops the entry of an asset its owner deleted directly, so lookups
+//    stop returning it. The free function isn't called. Does nothing if the
+//    handle isn't registered, which is the case while it's being freed.
+void    asset_forget(asset_type_t type, const void* handle);
+
+void    asset_retain(asset_type_t type, slice_t path);
+void    asset_release(asset_type_t type, slice_t path);
+
+// \brief Marks an asset as used by the scene currently being loaded.
+void    asset_hold(asset_type_t type, slice_t path);
+
+// \brief Called around loading a scene. Ending the load drops the holds of
+//    the previous scene on everything the new one didn't ask for again.
+void    asset_scene_begin(void);
+void    asset_scene_end(void);
+
+index_t asset_count(asset_type_t type);
+
+#endif
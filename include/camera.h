@@ -72,6 +72,13 @@ typedef struct camera_t {
 
 } camera_t;
 
+// Clip planes extracted from a camera's projection-view matrix, in the order
+//    left, right, bottom, top, near, far. Normals point inward and are
+//    normalized, so the signed distance to a plane is dot(xyz, p) + w.
+typedef struct frustum_t {
+  vec4 planes[6];
+} frustum_t;
+
 camera_t camera_build_ortho(camera_orthographic_params_t);
 camera_t camera_build_persp(camera_perspective_params_t);
 
@@ -86,4 +93,7 @@ mat4 camera_view(const camera_t* camera);
 mat4 camera_projection_view(const camera_t* camera);
 vec3 camera_ray(const camera_t* camera, vec2 ndc_pos);
 
+frustum_t camera_frustum(const camera_t* camera);
+bool      frustum_test_sphere(const frustum_t* frustum, vec3 center, float r);
+
 #endif
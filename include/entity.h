@@ -73,6 +73,7 @@ typedef struct entity_desc_t {
   color4b             tint;
   bool                is_hidden;
   bool                is_static;
+  bool                is_parallel; // behavior can run on a job thread
 
   renderer_t*         renderer;
 
@@ -117,6 +118,13 @@ typedef struct entity_t {
   bool                CONST is_static;
   bool                CONST is_dirty_renderer;
   bool                CONST is_dirty_static;
+  bool                CONST is_pending_bounds; // waiting on its model to load
+
+  // Behaviors flagged as parallel run after the others, spread across the job
+  //    threads. They may only modify their own entity and read others; adding
+  //    entities or changing their renderer, model, or material isn't allowed.
+  //    Dirty flags and removals are deferred and applied in actor order.
+  bool                CONST is_parallel;
 
   // Actions and event callbacks
   entity_update_fn_t        behavior;
@@ -131,9 +139,11 @@ void      entity_remove(slotkey_t entity_id);
 index_t   entity_count(void);
 Entity    entity_ref(slotkey_t entity_id);
 Entity    entity_next(slotkey_t* entity_id);
+Entity    entity_raycast(vec3 origin, vec3 dir, float max_dist, float* t);
 
 void      entity_set_parent(Entity, const Entity new_parent);
 void      entity_set_behavior(Entity, entity_update_fn_t behavior);
+void      entity_set_parallel(Entity, bool is_parallel);
 void      entity_set_onrender(Entity, entity_render_fn_t onrender);
 
 mat4      entity_transform(Entity);
@@ -47,12 +47,56 @@ typedef struct _opaque_File_t {
   slice_t       CONST slice;
 }* File;
 
+// \brief Called with each chunk of a streamed file in order, on the main
+//    thread from file_loading_manager. The chunk is only valid during the
+//    call, and the file must not be deleted from inside it.
+// \param last Set on the final call, which is always made (with an empty
+//    chunk for an empty file) unless reading fails.
+// \returns false to stop reading early, closing the stream.
+typedef bool (*file_chunk_fn_t)(
+  File file, slice_t chunk, bool last, void* data
+);
+
+#define FILE_STREAM_CHUNK_DEFAULT (256 << 10)
+
 File        file_new(slice_t filename, file_mode_t mode);
 
+// \brief Reads a file in fixed-size chunks through one reused buffer, passing
+//    each chunk to `fn` as it arrives instead of holding the whole file.
+//    The file's data stays empty. Its status is S_LOADING while reading, then
+//    S_READY once the last chunk is consumed, S_CLOSED if the consumer
+//    stopped early, or an error status.
+// \param chunk_size Bytes per chunk, or 0 for FILE_STREAM_CHUNK_DEFAULT.
+File        file_new_stream(
+  slice_t filename, index_t chunk_size, file_chunk_fn_t fn, void* data
+);
+
 void        file_loading_manager(void);
 index_t     file_loading_count(void);
 
 void        file_delete(File*);
 span_byte_t file_release_data(File);
 
+// \brief Mounts a .wpak asset pack so later file_new calls for reading are
+//    served from it. Natively the pack is memory-mapped and packed files are
+//    ready immediately, with their data pointing into the mapping. On the web
+//    the pack is fetched as one request, and files requested before it
+//    arrives wait for it instead of being fetched on their own.
+// \returns false if the pack couldn't be mapped or isn't a valid pack.
+bool        file_mount_pack(slice_t filename);
+
+// \brief Unmounts every pack. Files loaded from a pack must be deleted (or
+//    have had their data released) before this is called.
+void        file_unmount_packs(void);
+
+// \brief Finds a file in the mounted packs without creating a File. Off the
+//    main thread, hold file_packs_lock for as long as the data is used.
+// \param out Set to the file's contents when found.
+bool        file_pack_lookup(slice_t filename, slice_t* out);
+
+// \brief Keeps the packs from being mounted or unmounted until the matching
+//    file_packs_unlock, so other threads can read from them safely.
+void        file_packs_lock(void);
+void        file_packs_unlock(void);
+
 #endif
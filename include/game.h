@@ -41,6 +41,7 @@
 typedef struct _opaque_Game_t* Game;
 typedef struct _opaque_Graphics_t* Graphics;
 typedef struct _opaque_ParticleSystem_t* ParticleSystem;
+typedef struct _opaque_Spatial_t* Spatial;
 
 typedef void (*event_resize_window_fn_t)(Game game);
 
@@ -83,6 +84,7 @@ typedef struct _opaque_Game_t {
   // systems
   Graphics      CONST graphics;
   ParticleSystem CONST particle_system;
+  Spatial       CONST spatial;    // bounds of visible entities with models
 
   // game setup
   input_t             input;
@@ -41,4 +41,72 @@
 
 #endif
 
+#include "types.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Shadow state cache
+////////////////////////////////////////////////////////////////////////////////
+
+// Counts of cached calls passed through to GL or dropped as redundant
+typedef struct gl_state_stats_t {
+  index_t issued;
+  index_t skipped;
+} gl_state_stats_t;
+
+// \brief Cached versions of the GL binding and capability calls. Each one only
+//    reaches GL when it would change the current state. All engine code binds
+//    through these so the shadow copy stays in sync with the context; raw GL
+//    calls for the same state need a gl_state_invalidate() afterwards.
+void    gl_use_program(GLuint program);
+void    gl_bind_vertex_array(GLuint array);
+void    gl_bind_buffer(GLenum target, GLuint buffer);
+void    gl_bind_framebuffer(GLenum target, GLuint framebuffer);
+void    gl_active_texture(GLenum unit);
+void    gl_bind_texture(GLenum target, GLuint texture);
+void    gl_enable(GLenum cap);
+void    gl_disable(GLenum cap);
+
+// \brief Deleting objects through these clears any cached bindings to them,
+//    since GL may hand out the same names again.
+void    gl_delete_program(GLuint program);
+void    gl_delete_vertex_arrays(GLsizei n, const GLuint* arrays);
+void    gl_delete_buffers(GLsizei n, const GLuint* buffers);
+void    gl_delete_framebuffers(GLsizei n, const GLuint* framebuffers);
+void    gl_delete_textures(GLsizei n, const GLuint* textures);
+
+// \brief Forgets all cached state so the next call of each kind is issued.
+//    Use after code outside the engine (UI libraries, etc) touches GL.
+void    gl_state_invalidate(void);
+
+// \brief Closes the frame's call counters. gl_state_stats returns the counts
+//    for the last completed frame.
+void    gl_state_frame_end(void);
+gl_state_stats_t gl_state_stats(void);
+
+////////////////////////////////////////////////////////////////////////////////
+// WebGL command batching
+////////////////////////////////////////////////////////////////////////////////
+
+#ifdef __WASM__
+
+// \brief Opts into recording GL state changes and draws into a command buffer
+//    that JS replays in a single call, instead of crossing into JS for each
+//    one. The buffer is flushed at the end of every frame, when it fills up,
+//    and before any GL call that isn't recorded (uploads, queries, creating
+//    and deleting objects), so call order is unchanged. WebGL only.
+void    gl_batch_enable(bool enable);
+void    gl_batch_flush(void);
+
+// \brief Number of calls made from wasm into the JS GL bindings during the
+//    last frame, to compare batched and unbatched modes.
+index_t gl_batch_crossings(void);
+
+#else
+
+static inline void gl_batch_enable(bool enable) { UNUSED(enable); }
+static inline void gl_batch_flush(void) { }
+static inline index_t gl_batch_crossings(void) { return 0; }
+
+#endif
+
 #endif
@@ -34,8 +34,14 @@ typedef struct _opaque_Graphics_t {
   span_renderer_t renderers;
 }* Graphics;
 
+// Uniform block binding point of the FrameConstants block, which holds the
+//    camera matrices, inverse projection, scene time, frame time and render
+//    resolution. Any shader declaring the block gets it bound here.
+#define GFX_FRAME_BINDING 0
+
 Graphics gfx_new(void);
 void gfx_delete(Graphics* gfx);
+void gfx_update_frame(Graphics, Game);
 void gfx_render(Graphics, Game);
 void gfx_clear_instances(Graphics);
 
@@ -38,6 +38,14 @@ typedef enum img_type_t {
   IMG_DATA,
 } img_type_t;
 
+// \brief Order in which queued images are decoded; images with the same
+//    priority are decoded in the order they were requested
+typedef enum img_priority_t {
+  IMG_PRIORITY_LOW,
+  IMG_PRIORITY_NORMAL,
+  IMG_PRIORITY_HIGH,
+} img_priority_t;
+
 typedef struct _opaque_Image_t {
   slice_t       CONST filename;
   img_type_t    CONST type;
@@ -68,6 +76,12 @@ Image img_copy(Image);
 //Image img_copy_resize(Image, vec2i size, int channels);
 
 index_t img_loading_count(void);
+void    img_loading_manager(void);
+void    img_loading_shutdown(void);
+
+// \brief Changes where a still-loading image sits in the decode queue. Has no
+//    effect once decoding has started.
+void    img_set_priority(Image, img_priority_t);
 
 void  img_delete(Image* image);
 void  img_resolve(Image);
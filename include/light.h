@@ -28,6 +28,7 @@
 #include "types.h"
 #include "vec.h"
 #include "slotkey.h"
+#include "shader.h"
 
 typedef struct light_t {
   vec3 pos;
@@ -38,6 +39,7 @@ typedef struct light_t {
   float radius;
   float spot_outer;
   float spot_inner;
+  float range; // culling distance, 0 derives one from intensity
 } light_t;
 
 
@@ -53,6 +55,25 @@ light_t*  light_ref(slotkey_t id);
 void      light_remove(slotkey_t id);
 void      light_clear(void);
 
+// \brief Binds the persistent view-space light buffer to a texture slot for a
+//    deferred lighting pass, and sets the number of valid rows in it.
+// \param slot Texture unit to bind the light data to.
+// \param sampler Uniform location of the light data sampler.
+// \param count_uniform Uniform location of the light count integer.
+void      light_buffer_bind(uint slot, int sampler, int count_uniform);
+
+// \brief Binds the clustered light grid and light index textures to two
+//    consecutive texture slots, along with the cluster parameters the shader
+//    needs to find the cluster a fragment belongs to.
+// \param shader The bound lighting shader.
+// \param slot First of the two texture units to use.
+void      light_clusters_bind(Shader shader, uint slot);
+
+// \brief Toggles clustered light culling. While disabled, the lighting pass
+//    is told to walk the full light list instead.
+void      light_set_clustering(bool enabled);
+bool      light_get_clustering(void);
+
 #ifdef WASP_TEXTURE_H_
 #include "texture.h"
 #endif
@@ -45,6 +45,7 @@ typedef struct mat_params_t {
     };
   };
   vec2i atlas_dimensions;
+  bool  translucent;  // drawn after opaque groups, sorted back to front
 } mat_params_t;
 
 typedef struct _opaque_Material_t {
@@ -91,6 +92,13 @@ typedef struct _opaque_Material_t {
 //    - "test_r.jpg"  - roughness map
 //    - "test_m.jpg"  - metallic map
 //
+// \brief A ".ktx2" extension loads block compressed maps instead, from files
+//    named for the best compression family the context supports, for example
+//    "test_n.bc.ktx2" on desktop or "test_n.astc.ktx2" on mobile browsers (see
+//    tex_compression_preferred). A family in the name is used instead, as in
+//    "test.raw.ktx2" for maps baked by tools/asset_bake.c. Array layers and
+//    mips come from the file.
+//
 // \returns a new single layer material.
 Material    mat_new(slice_t name, mat_params_t);
 
@@ -116,11 +124,19 @@ Material    mat_new_multi(slice_t name, mat_params_t, view_slice_t filenames);
 // \brief Gets a material by name. This name does _not_ include the
 //    file extension.
 Material    mat_get(slice_t name);
-Array_slice mat_get_names(void);
+
+// \brief Lists the names of all materials. The list is owned by the material
+//    registry and stays valid until the next material is created, so it
+//    shouldn't be deleted.
+view_slice_t mat_get_names(void);
 
 void        mat_delete(Material* material);
 
 void        mat_loading_manager(void);
+
+// \brief Moves a loading material's images to the front of the decode queue,
+//    used by the renderer for materials that are actually being drawn
+void        mat_prioritize(Material);
 index_t     mat_loading_count(void);
 
 void        mat_bind(Material);
@@ -86,13 +86,28 @@ typedef struct model_sprites_t {
   vec2i grid;
 } model_sprites_t;
 
+// One command of an indirect draw, in the layout glMultiDrawElementsIndirect
+//    reads. Non-indexed models store base_instance in the base_vertex slot,
+//    which is where glMultiDrawArraysIndirect reads it from.
+typedef struct model_draw_cmd_t {
+  uint count;
+  uint instance_count;
+  uint first;
+  uint base_vertex;
+  uint base_instance;
+} model_draw_cmd_t;
+
+// Bounds are a model-space sphere used for culling; a radius of zero or less
+//    means the model has no meaningful bounds and is never culled.
 #define MODEL_PROPS                   \
   CONST model_type_t    type;         \
   CONST slice_t         name;         \
   CONST status_t        status;       \
   CONST vertex_format_t format;       \
   CONST index_t         vert_count;   \
-  CONST index_t         index_count   //
+  CONST index_t         index_count;  \
+  CONST vec3            bounds_center;\
+  CONST float           bounds_radius //
 
 typedef struct _opaque_Model_t {
   MODEL_PROPS;
@@ -108,6 +123,11 @@ Model       model_new_sprites(vec2i dim);
 Model       model_new_grid(model_grid_param_t grid);
 Model       model_new_grid_default(int extent);
 Model       model_new_load_obj(slice_t filename);
+
+// \brief Loads a mesh from either a text OBJ or a binary .wmesh file (see
+//    tools/mesh_convert.c), detected from the file contents. Binary meshes
+//    are uploaded directly from the file buffer.
+Model       model_new_load_mesh(slice_t filename);
 Model       model_new_from_obj(slice_t obj_text);
 
 void        model_delete(Model* model);
@@ -116,12 +136,36 @@ void        model_bind(const Model model);
 void        model_render(Model model);
 void        model_render_instanced(const Model model, index_t count);
 
+// \brief Indirect draws, for drawing runs of instances out of a larger instance
+//    buffer. Only models using the plain instanced draw (meshes and cubes)
+//    support them, and never on WebGL2.
+bool        model_can_render_indirect(const Model model);
+
+// \brief Command drawing instances [base, base + count) of the model.
+model_draw_cmd_t model_draw_cmd(const Model model, index_t base, index_t count);
+
+// \brief Draws draw_count commands from the bound GL_DRAW_INDIRECT_BUFFER.
+void        model_render_indirect(const Model model, index_t draw_count);
+
+// \brief Checks on loading models. Mesh files are parsed on job threads, and
+//    only the GPU upload happens here, limited to the budget set below.
 void        model_loading_manager(void);
 index_t     model_loading_count(void);
 
+// \brief Sets how many bytes of mesh data model_loading_manager uploads per
+//    call (4 MiB by default). Larger meshes are streamed in over several
+//    frames. Zero or less uploads everything as soon as it's parsed.
+void        model_set_upload_budget(index_t bytes);
+
+// \brief Gets a loaded model by name in constant time. If several models
+//    share a name, the first one to finish loading is returned.
 Model       model_get(slice_t name);
-Array_slice model_get_names(void);
-Array_slice model_get_names_inst(void);
+
+// \brief Lists the names of loaded models (or only those that can be drawn
+//    instanced). The list is owned by the model registry and stays valid
+//    until the next model finishes loading, so it shouldn't be deleted.
+view_slice_t model_get_names(void);
+view_slice_t model_get_names_inst(void);
 
 void        model_sprites_add(
               Model spr, vec2 pos, vec2 scale, index_t frame, bool mirror);
@@ -39,7 +39,14 @@ typedef enum effect_flags_t {
   EF_TRANSLUCENT  = 0b0000'0010,
   EF_MODEL        = 0b0000'0100,
   EF_COLOR        = 0b0000'1000,
-  EF_RIBBON       = 0b0001'0000
+  EF_RIBBON       = 0b0001'0000,
+  // particle updates are split across the job threads, so the effect's
+  //    on_particle_update must be thread-safe (no shared RNG or state)
+  EF_PARALLEL     = 0b0010'0000,
+  // particles are stored as separate position/velocity/age streams and
+  //    updated with SIMD kernels; pb_gravity runs as a kernel, other update
+  //    callbacks operate on a per-particle copy and are much slower
+  EF_SOA          = 0b0100'0000
 } effect_flags_t;
 
 typedef enum particle_format_t {
@@ -53,6 +60,14 @@ typedef enum particle_format_t {
   PF_SUPPORTED_MAX
 } particle_format_t;
 
+// \brief What an effect with a budget does when an emitter tries to spawn past
+//    the effect's capacity
+typedef enum particle_overflow_t {
+  PO_DROP_NEW,        // new particles are not spawned
+  PO_RECYCLE,         // live particles are replaced round-robin, which
+                      //    approximates oldest first while the pool is full
+} particle_overflow_t;
+
 typedef enum emitter_shape_t {
   ES_POINT,
   ES_SPHERE,
@@ -114,6 +129,16 @@ typedef struct particle_t {
   };
 } particle_t;
 
+typedef struct particle_stats_t {
+  index_t   count;      // live particles
+  index_t   peak;       // highest live count seen
+  index_t   capacity;   // pool size from the budget, 0 if unbounded
+  index_t   spawned;    // total particles created, including recycled ones
+  index_t   dropped;    // spawns skipped by PO_DROP_NEW
+  index_t   recycled;   // particles replaced by PO_RECYCLE
+  size_t    bytes;      // approximate size of the particle storage
+} particle_stats_t;
+
 typedef struct _opaque_Shader_t*  Shader;
 typedef struct texture_t*         Texture;
 typedef struct _opaque_Model_t*   Model;
@@ -146,7 +171,6 @@ typedef struct emitter_defaults_t {
   quat                dir;
   emitter_shape_t     shape;
   vec3                size;
-  index_t             budget;
   float               rate;
   float               rate_variance;
   float               duration;
@@ -182,7 +206,6 @@ typedef struct particle_emitter_t {
           float           inner_radius;
         };
       };
-      index_t             budget;
       float               rate;
       float               rate_variance;
       float               duration;
@@ -201,6 +224,9 @@ struct _opaque_ParticleEffect_t {
   effect_flags_t      CONST flags;
   particle_format_t   CONST format;
   ParticleSystem      CONST system;
+  index_t             CONST budget;
+  particle_overflow_t CONST overflow;
+  particle_stats_t    CONST stats;
 
   Shader              shader;
   Texture             texture;
@@ -234,6 +260,12 @@ ParticleEffect  ps_get_effect(ParticleSystem, slice_t name);
 Array_slice     ps_get_effect_names(ParticleSystem);
 bool            ps_set_effect_name(ParticleEffect, slice_t);
 
+// \brief Allocates a fixed pool of `budget` particles for the effect so that
+//    spawning never reallocates. Existing particles are cleared. A budget of
+//    0 returns the effect to unbounded growth.
+void            ps_set_effect_budget(ParticleEffect,
+                  index_t budget, particle_overflow_t);
+
 ParticleEmitter ps_add_emitter(ParticleEffect);
 ParticleEmitter ps_get_emitter(ParticleSystem, slotkey_t emitter_id);
 ParticleEmitter ps_get_next_emitter(ParticleSystem, slotkey_t* emitter_id_iter);
@@ -26,6 +26,7 @@
 #define WASP_RENDERER_H_
 
 #include "types.h"
+#include "array.h"
 
 #include "model.h"
 #include "material.h"
@@ -53,7 +54,7 @@ typedef void      (*renderer_entity_unregister_fn_t)(Entity);
 // Called when directly accessing per-entity instance attributes
 typedef void*     (*renderer_entity_attributes_fn_t)(Entity, bool modify);
 
-// Called when a render group has instances updated (non-negative update range)
+// Called when a render group has instances updated (dirty ranges or full)
 typedef void      (*renderer_instance_update_fn_t)(render_group_t*);
 
 // Called once per frame after the entities are processed 
@@ -81,6 +82,50 @@ typedef struct render_group_key_t {
 
 #include "packedmap.h"
 
+// Maximum number of disjoint dirty ranges tracked per group before the closest
+//    ranges start getting merged together
+#define RENDER_GROUP_MAX_RANGES 8
+
+typedef struct render_range_t {
+  index_t low;
+  index_t high; // inclusive
+} render_range_t;
+
+// Number of instance buffers cycled through by dynamic groups in ring mode
+#define RENDER_GROUP_RING_SIZE 3
+
+// Streaming instance storage for dynamic groups. On native GL with buffer
+//    storage support, each slot is a persistently mapped buffer guarded by a
+//    fence; otherwise (WebGL2) a single buffer is orphaned on each update.
+typedef struct render_ring_t {
+  uint    vaos[RENDER_GROUP_RING_SIZE];
+  uint    buffers[RENDER_GROUP_RING_SIZE];
+  void*   mapped[RENDER_GROUP_RING_SIZE];
+  void*   fences[RENDER_GROUP_RING_SIZE];
+  index_t capacity;
+  index_t current;
+  bool    active;
+  bool    persistent;
+} render_ring_t;
+
+// Instances that passed frustum culling this frame. Dynamic groups in ring
+//    mode write a compacted copy into their ring, and static groups keep their
+//    full instance buffer and draw runs of it through an indirect command list
+//    where available. Otherwise the compacted copy goes into its own buffer.
+typedef struct render_visible_t {
+  uint    vao;
+  uint    buffer;
+  uint    commands;   // indirect draw commands, one per run of instances
+  index_t command_count;
+  index_t capacity;
+  index_t count;
+  index_t* indices;   // instance indices that were visible last upload
+  void*   data;       // staging for the compacted attributes or commands
+  bool    active;     // the group was drawn through the culled path
+  bool    stale;      // instance data changed since the last upload
+  bool    indirect;   // drawn through the command list
+} render_visible_t;
+
 typedef struct render_group_t {
   union {
     render_group_key_t key;
@@ -93,9 +138,12 @@ typedef struct render_group_t {
   PackedMap instances;
   uint vao;
   uint instance_buffer;
-  index_t update_range_low;
-  index_t update_range_high;
+  index_t buffer_capacity;
+  render_range_t update_ranges[RENDER_GROUP_MAX_RANGES];
+  index_t update_range_count;
   bool update_full;
+  render_ring_t ring;
+  render_visible_t visible;
 } render_group_t;
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -110,6 +158,27 @@ typedef struct render_group_t {
 #undef key_type
 #undef con_type
 
+// How instance data for dynamic (non-static) groups gets sent to the GPU
+typedef enum renderer_buffer_mode_t {
+  RENDERER_BUFFER_SINGLE,   // one buffer, updated in place
+  RENDERER_BUFFER_RING,     // triple-buffered ring, never waits on the GPU
+} renderer_buffer_mode_t;
+
+// Entry in a renderer's draw list, which is kept sorted by key so groups
+//    sharing GPU state are drawn one after another (see renderer.c)
+typedef struct render_draw_t {
+  uint64_t        key;
+  render_group_t* group;
+} render_draw_t;
+
+// Per-frame counts from the last call to the renderer's render function
+typedef struct renderer_stats_t {
+  index_t instances_total;
+  index_t instances_drawn;
+  index_t instances_culled;
+  index_t groups_culled;
+} renderer_stats_t;
+
 typedef struct renderer_t {
   const char* const               name;
   renderer_entity_register_fn_t   entity_register;
@@ -121,9 +190,16 @@ typedef struct renderer_t {
   HMap_rg                         groups;
   Shader                          shader;
   RenderTarget                    render_target;
+  renderer_buffer_mode_t          buffer_mode;
+  bool                            frustum_cull;
+  renderer_stats_t                stats;
+  Array                           draw_list;
+  index_t                         draw_list_translucent;
+  bool                            draw_list_dirty;
 } renderer_t;
 
 void      renderer_clear_instances(renderer_t*);
+void      render_group_mark_dirty(render_group_t*, index_t index);
 
 void      renderer_entity_register(renderer_t*, Entity);
 void      renderer_entity_update(Entity);
@@ -28,11 +28,51 @@
 #include "types.h"
 #include "slice.h"
 #include "status.h"
+#include "array_slice.h"
 #include "instance_attributes.h"
 #include "vertex.h"
 
 typedef struct _opaque_Material_t* Material;
 
+// Interned uniform and attribute names. The names used by the engine and its
+//    built-in shaders have fixed ids; other names get one from
+//    shader_var_intern, which stays the same for the life of the program.
+typedef enum shader_var_t {
+  SV_NONE,
+
+  // uniforms
+  SV_IN_PV_MATRIX,
+  SV_IN_VIEW_MATRIX,
+  SV_IN_PVM_MATRIX,
+  SV_IN_NORMAL_MATRIX,
+  SV_IN_PROJ_INVERSE,
+  SV_IN_WEIGHTS,
+  SV_IN_TINT,
+  SV_IN_LIGHT_COUNT,
+  SV_IN_CLUSTER_DIMS,
+  SV_IN_CLUSTER_DEPTH,
+  SV_IN_CLUSTER_ENABLED,
+  SV_SAMP_TEX,
+  SV_SAMP_NORM,
+  SV_SAMP_ROUGH,
+  SV_SAMP_METAL,
+  SV_SAMP_PROP,
+  SV_SAMP_DEPTH,
+  SV_SAMP_LIGHT,
+  SV_SAMP_LIGHT_GRID,
+  SV_SAMP_LIGHT_INDEX,
+  SV_SAMP_FRAME,
+
+  // instance attributes
+  SV_MODEL_MATRIX,
+  SV_MODEL_TINT,
+  SV_MODEL_MATERIAL_INDEX,
+  SV_MODEL_POS,
+  SV_MODEL_SCALE,
+
+  SV_BUILTIN_COUNT,
+} shader_var_t;
+
 typedef struct _opaque_Shader_t {
   slice_t             CONST name;
   status_t            CONST status;
@@ -47,8 +87,14 @@ Shader  shader_new_from_files(slice_t name, slice_t vert_file, slice_t frag_name
 
 void    shader_loading_manager(void);
 index_t shader_loading_count(void);
-//Array_slice shader_list(void);
-//Shader  shader_get(slice_t name);
+
+// \brief Gets a shader by name, or NULL if none was created with it.
+Shader  shader_get(slice_t name);
+
+// \brief Lists the names of all shaders. The list is owned by the shader
+//    registry and stays valid until a shader is created or deleted, so it
+//    shouldn't be deleted.
+view_slice_t shader_get_names(void);
 
 void    shader_load_async(Shader);
 void    shader_build(Shader);
@@ -58,9 +104,25 @@ void    shader_set_uniform(Shader);
 void    shader_bind_material(Shader, Material);
 void    shader_delete(Shader* shader);
 
+// \brief Gets the id for a uniform or attribute name, adding it if needed.
+//    Look names up once and keep the id, rather than every frame.
+shader_var_t shader_var_intern(slice_t name);
+
+// \brief Gets a uniform or attribute location by interned name. Active
+//    uniforms and attributes are listed when the shader links, so this is an
+//    array lookup. Returns -1 if the shader doesn't use the name.
+int     shader_uniform_id(Shader, shader_var_t id);
+int     shader_attribute_id(Shader, shader_var_t id);
+
+// \brief Same as above by name, interning it first.
 int     shader_uniform_loc(Shader, const char* name);
 int     shader_attribute_loc(Shader, const char* name);
 
+// \brief Assigns a uniform block to a fixed binding point in every shader
+//    that declares it, including shaders linked later, so one buffer bound
+//    with glBindBufferBase can feed all of them.
+void    shader_block_binding(slice_t block_name, uint binding);
+
 void    shader_check_updates(void);
 
 #endif
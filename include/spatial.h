@@ -0,0 +1,100 @@
+/*******************************************************************************
+* MIT License
+*
+* Copyright (c) 2026 Curtis McCoy
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#ifndef WASP_SPATIAL_H_
+#define WASP_SPATIAL_H_
+
+#include "types.h"
+#include "vec.h"
+#include "slotkey.h"
+#include "camera.h"
+
+typedef struct aabb_t {
+  vec3 min;
+  vec3 max;
+} aabb_t;
+
+// \brief Called for each item overlapping a query volume.
+// \return false to stop the query early.
+typedef bool (*spatial_visit_fn_t)(slotkey_t id, void* data);
+
+// \brief Called for each item whose bounds the ray passes through, nearest
+//    bounds first. Lets the caller do an exact test against the item.
+// \param t In: distance where the ray enters the item's bounds. Out: distance
+//    of the actual hit, if there is one.
+// \return true if the item was hit.
+typedef bool (*spatial_ray_fn_t)(
+  slotkey_t id, vec3 origin, vec3 dir, float* t, void* data
+);
+
+typedef struct spatial_hit_t {
+  slotkey_t id;
+  float     t;
+} spatial_hit_t;
+
+// \brief Dynamic bounding volume hierarchy of axis-aligned boxes keyed by
+//    slotkey, for broad-phase ray, overlap and visibility queries.
+//
+// \brief Leaves store their bounds padded by a margin, so items that move a
+//    little don't need to be re-inserted every time they're updated. The tree
+//    is rebalanced with rotations as items are inserted and removed.
+typedef struct _opaque_Spatial_t {
+  index_t CONST size;
+  index_t CONST height;
+}* Spatial;
+
+Spatial spatial_new(void);
+void    spatial_delete(Spatial* spatial);
+void    spatial_clear(Spatial spatial);
+
+// \brief Inserts an item or moves an existing one to new bounds.
+void    spatial_update(Spatial spatial, slotkey_t id, aabb_t bounds);
+void    spatial_remove(Spatial spatial, slotkey_t id);
+bool    spatial_contains(Spatial spatial, slotkey_t id);
+
+// \brief Each query visits the items whose (unpadded) bounds overlap the given
+//    volume, and returns the number of items visited.
+index_t spatial_query_aabb(
+  Spatial spatial, aabb_t box, spatial_visit_fn_t fn, void* data
+);
+index_t spatial_query_sphere(
+  Spatial spatial, vec3 center, float radius, spatial_visit_fn_t fn, void* data
+);
+index_t spatial_query_frustum(
+  Spatial spatial, const frustum_t* frustum, spatial_visit_fn_t fn, void* data
+);
+
+// \brief Finds the closest item along a ray.
+// \param dir Normalized ray direction.
+// \param max_t Maximum distance along the ray.
+// \param fn Optional exact test per item, if NULL the item bounds are the hit.
+// \param hit Output for the closest hit, if any.
+bool    spatial_raycast(
+  Spatial spatial, vec3 origin, vec3 dir, float max_t,
+  spatial_ray_fn_t fn, void* data, spatial_hit_t* hit
+);
+
+aabb_t  aabb_from_sphere(vec3 center, float radius);
+
+#endif
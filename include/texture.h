@@ -41,9 +41,29 @@ typedef enum tex_format_t {
   TF_RGB_10_A_2,
   TF_DEPTH_32,
   TF_DEPTH_16,
+  TF_R_32_UINT,
+  TF_RG_32_UINT,
+  // Block compressed formats, only loaded from KTX2 files (see tex_from_ktx2)
+  TF_BC1_RGBA,
+  TF_BC3_RGBA,
+  TF_BC4_R,
+  TF_BC5_RG,
+  TF_BC7_RGBA,
+  TF_ETC2_RGB,
+  TF_ETC2_RGBA,
+  TF_ASTC_4X4_RGBA,
   TF_SUPPORTED_MAX
 } tex_format_t;
 
+// \brief Families of block compressed formats. Desktop GL has BC, while
+//    mobile browsers usually only have ETC2 and/or ASTC.
+typedef enum tex_compression_t {
+  TEX_COMPRESSION_NONE,
+  TEX_COMPRESSION_BC,
+  TEX_COMPRESSION_ETC2,
+  TEX_COMPRESSION_ASTC,
+} tex_compression_t;
+
 typedef enum tex_filtering_t {
   TEX_FILTERING_LINEAR,
   TEX_FILTERING_CLAMP
@@ -85,10 +105,31 @@ extern tex_params_t tex_params_default;
 // Gets the equivalent texture format of a loaded image
 tex_format_t img_format(Image);
 
+// \brief Gets which compression family a format belongs to, if any
+tex_compression_t tex_format_compression(tex_format_t);
+
+// \brief Checks if the GL context can sample the format. Uncompressed formats
+//    are always supported, compressed ones depend on the available extensions.
+bool    tex_format_supported(tex_format_t);
+
+// \brief Best compression family the context supports, checked in the order
+//    BC, ASTC, ETC2. Returns TEX_COMPRESSION_NONE if none of them are.
+tex_compression_t tex_compression_preferred(void);
+
+// \brief Size in bytes of a single 2D image of the format, accounting for
+//    4x4 blocks in compressed formats.
+index_t tex_format_data_size(tex_format_t, vec2i size);
+
 Texture tex_from_image(Image);
 Texture tex_from_image_params(Image, tex_params_t);
 Texture tex_from_image_atlas(Image, vec2i dim);
 Texture tex_from_data(tex_format_t, vec2i size, const void* data);
+
+// \brief Creates a texture array from a KTX2 file containing block compressed
+//    or baked 8-bit data (see tools/asset_bake.c), uploaded as-is along with
+//    the file's mip levels. Returns NULL if the file is invalid or its format
+//    isn't supported.
+Texture tex_from_ktx2(slice_t name, slice_t data);
 Texture tex_generate(tex_format_t, vec2i size);
 Texture tex_generate_atlas(tex_format_t, vec2i size, index_t layers);
 Texture tex_get_default_white(void);
@@ -100,6 +141,7 @@ void    tex_set_filtering(Texture, tex_filtering_t);
 void    tex_set_wrapping(Texture, tex_wrapping_t);
 void    tex_set_atlas_layer(Texture, index_t layer, Image);
 void    tex_set_atlas_layer_color(Texture, index_t layer, color4);
+void    tex_set_data_region(Texture, vec2i offset, vec2i size, const void*);
 void    tex_generate_mips(Texture);
 void    tex_apply(Texture, uint slot, int sampler);
 void    tex_delete(Texture*);
@@ -29,4 +29,54 @@
 
 bool thread_is_main(void);
 
+////////////////////////////////////////////////////////////////////////////////
+// Job system
+////////////////////////////////////////////////////////////////////////////////
+
+typedef void (*job_fn_t)(void* data);
+typedef void (*job_range_fn_t)(index_t begin, index_t end, void* data);
+
+// \brief Number of submitted jobs that haven't finished yet. Same layout as
+//    SDL_AtomicInt, which is what the implementation treats it as.
+typedef struct job_counter_t {
+  int value;
+} job_counter_t;
+
+// \brief Starts the worker threads. Each thread owns a job queue, and threads
+//    that run out of work steal from the others. Without workers (or on WASM),
+//    jobs run immediately on the calling thread.
+// \param worker_count Number of workers to start, or 0 for one less than the
+//    number of logical cores (the calling thread also runs jobs while waiting).
+void    jobs_init(index_t worker_count);
+void    jobs_shutdown(void);
+
+// \brief Number of threads that run jobs, including the main thread.
+index_t jobs_thread_count(void);
+
+// \brief Index of the calling thread in [0, jobs_thread_count), 0 for main.
+index_t jobs_thread_index(void);
+
+// \brief Queues a job on the calling thread's queue.
+// \param counter Optional counter, incremented now and decremented when the
+//    job finishes.
+void    jobs_submit(job_fn_t fn, void* data, job_counter_t* counter);
+
+// \brief Queues a long-running job (like asset parsing) that only the workers
+//    pick up, so it never ends up running inline inside a jobs_wait on the
+//    main thread. Runs immediately when there are no workers.
+void    jobs_submit_background(
+          job_fn_t fn, void* data, job_counter_t* counter);
+
+// \brief Runs queued jobs on the calling thread until the counter hits zero.
+void    jobs_wait(job_counter_t* counter);
+
+// \brief True once the counter has hit zero. Unlike jobs_wait this never
+//    blocks or runs jobs, so the main thread can poll it once per frame.
+bool    jobs_done(job_counter_t* counter);
+
+// \brief Splits [0, count) into chunks of chunk_size and runs them across the
+//    job threads, returning once all of them have finished.
+void    jobs_parallel_for(
+          index_t count, index_t chunk_size, job_range_fn_t fn, void* data);
+
 #endif
@@ -185,6 +185,9 @@ typedef ptrdiff_t GLintptr;
 #define GL_ACTIVE_UNIFORM_MAX_LENGTH      0x8B87
 #define GL_ACTIVE_ATTRIBUTES              0x8B89
 #define GL_ACTIVE_ATTRIBUTE_MAX_LENGTH    0x8B8A
+#define GL_ACTIVE_UNIFORM_BLOCKS          0x8A36
+#define GL_UNIFORM_BUFFER                 0x8A11
+#define GL_INVALID_INDEX                  0xFFFFFFFFu
 #define GL_SHADING_LANGUAGE_VERSION       0x8B8C
 #define GL_CURRENT_PROGRAM                0x8B8D
 #define GL_NEVER                          0x0200
@@ -342,17 +345,32 @@ typedef ptrdiff_t GLintptr;
 #define GL_RGB10_A2                       0x8059
 #define GL_RED                            0x1903
 #define GL_RG                             0x8227
+#define GL_R32UI                          0x8236
+#define GL_RG32UI                         0x823C
+#define GL_RED_INTEGER                    0x8D94
+#define GL_RG_INTEGER                     0x8228
 #define GL_DEPTH24_STENCIL8               0x88F0
 #define GL_DEPTH_COMPONENT24              0x81A6
 #define GL_DEPTH_COMPONENT32F             0x8CAC
 #define GL_DEPTH_STENCIL_ATTACHMENT       0x821A
 #define GL_DRAW_FRAMEBUFFER_BINDING       0x8CA6
 #define GL_UNSIGNED_INT_2_10_10_10_REV    0x8368
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT  0x83F1
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT  0x83F3
+#define GL_COMPRESSED_RED_RGTC1           0x8DBB
+#define GL_COMPRESSED_RG_RGTC2            0x8DBD
+#define GL_COMPRESSED_RGBA_BPTC_UNORM     0x8E8C
+#define GL_COMPRESSED_RGB8_ETC2           0x9274
+#define GL_COMPRESSED_RGBA8_ETC2_EAC      0x9278
+#define GL_COMPRESSED_RGBA_ASTC_4x4_KHR   0x93B0
 
 #define GL_UNPACK_FLIP_Y_WEBGL            0x9240
 
 GLenum  glGetError(void);
 void    glGetIntegerv(GLenum pname, GLint * data);
+
+// Enables a WebGL extension, returning false if it isn't available
+GLboolean glGetExtensionWEBGL(const GLchar* name);
 void    glViewport(GLint x, GLint y, GLsizei width, GLsizei height);
 void    glEnable(GLenum cap);
 void    glDisable(GLenum cap);
@@ -379,6 +397,14 @@ void    glDeleteProgram(GLuint program);
 
 GLint   glGetAttribLocation(GLuint program, const GLchar* name);
 GLint   glGetUniformLocation(GLuint program, const GLchar* name);
+void    glGetActiveUniform(
+          GLuint program, GLuint index, GLsizei max, GLsizei* out_length,
+          GLint* size, GLenum* type, GLchar* name);
+void    glGetActiveAttrib(
+          GLuint program, GLuint index, GLsizei max, GLsizei* out_length,
+          GLint* size, GLenum* type, GLchar* name);
+GLuint  glGetUniformBlockIndex(GLuint program, const GLchar* name);
+void    glUniformBlockBinding(GLuint program, GLuint index, GLuint binding);
 void    glUniform1i(GLint loc, GLint v0);
 void    glUniform2fv(GLint loc, GLsizei count, const GLfloat* value);
 void    glUniform3fv(GLint loc, GLsizei count, const GLfloat* value);
@@ -392,6 +418,7 @@ void    glBufferData(GLenum tgt, GLsizeiptr size, const void* src, GLenum use);
 void    glBufferSubData(
           GLenum target, GLintptr offset, GLsizeiptr size, const void* data);
 void    glDeleteBuffers(GLsizei n, const GLuint* buffers);
+void    glBindBufferBase(GLenum target, GLuint index, GLuint buffer);
 
 void    glGenVertexArrays(GLsizei n, GLuint* arrays);
 void    glBindVertexArray(GLuint array);
@@ -419,6 +446,10 @@ void    glTexImage2D(
           GLenum target, GLint level, GLint internalFormat,
           GLsizei width, GLsizei height, GLint border, GLenum format,
           GLenum type, const void* data);
+void    glTexSubImage2D(
+          GLenum target, GLint level, GLint xoffset, GLint yoffset,
+          GLsizei width, GLsizei height, GLenum format, GLenum type,
+          const void* pixels);
 void    glTexStorage3D(
           GLenum target, GLsizei levels, GLenum internalformat,
           GLsizei width, GLsizei height, GLsizei depth);
@@ -427,6 +458,11 @@ void    glTexSubImage3D(
           GLint xoffset, GLint yoffset, GLint zoffset,
           GLsizei width, GLsizei height, GLsizei depth,
           GLenum format, GLenum type, const void* pixels);
+void    glCompressedTexSubImage3D(
+          GLenum target, GLint level,
+          GLint xoffset, GLint yoffset, GLint zoffset,
+          GLsizei width, GLsizei height, GLsizei depth,
+          GLenum format, GLsizei imageSize, const void* data);
 void    glGenerateMipmap(GLenum target);
 void    glTexParameteri(GLenum target, GLenum pname, GLint param);
 void    glPixelStorei(GLenum pname, GLint param);
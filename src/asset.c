@@ -0,0 +1,215 @@
+/*******************************************************************************
+* MIT License
+*
+* Copyright (c) 2026 Curtis McCoy
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "asset.h"
+
+#include "str.h"
+
+#include <stdlib.h>
+
+typedef struct asset_entry_t {
+  String          path;
+  void*           handle;
+  asset_free_fn_t free_fn;
+  index_t         refs;
+  index_t         scene;  // generation of the scene holding it, or -1
+  bool            pinned; // held at startup, so never released
+} asset_entry_t;
+
+#define con_type asset_entry_t*
+#define con_prefix asset
+#include "map.h"
+#undef con_prefix
+#undef con_type
+
+static HMap_asset _assets[ASSET_TYPES_COUNT] = { 0 };
+static index_t    _scene_generation = 0;
+
+////////////////////////////////////////////////////////////////////////////////
+
+// "./res/a.png" and "res/a.png" are the same file
+static slice_t _asset_key(slice_t path) {
+  while (path.size >= 2 && path.begin[0] == '.' && path.begin[1] == '/') {
+    path.begin += 2;
+    path.size -= 2;
+  }
+  return path;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static asset_entry_t* _asset_find(asset_type_t type, slice_t path) {
+  assert(type >= 0 && type < ASSET_TYPES_COUNT);
+  if (!_assets[type]) return NULL;
+  return map_asset_get_or_default(_assets[type], _asset_key(path), NULL);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void _asset_unref(asset_type_t type, asset_entry_t* entry) {
+  assert(entry->refs > 0);
+  if (--entry->refs > 0 || !entry->free_fn) return;
+
+  map_asset_remove(_assets[type], entry->path->slice);
+  entry->free_fn(entry->handle);
+  str_delete(&entry->path);
+  free(entry);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void* asset_get(asset_type_t type, slice_t path) {
+  asset_entry_t* entry = _asset_find(type, path);
+  return entry ? entry->handle : NULL;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void asset_insert(
+  asset_type_t type, slice_t path, void* handle, asset_free_fn_t free_fn
+) {
+  assert(type >= 0 && type < ASSET_TYPES_COUNT);
+  assert(handle);
+  assert(!_asset_find(type, path));
+
+  if (!_assets[type]) _assets[type] = map_asset_new();
+
+  asset_entry_t* entry = malloc(sizeof(asset_entry_t));
+  assert(entry);
+
+  *entry = (asset_entry_t) {
+    .path = str_copy(_asset_key(path)),
+    .handle = handle,
+    .free_fn = free_fn,
+    .refs = 0,
+    .scene = -1,
+    .pinned = false,
+  };
+
+  map_asset_insert(_assets[type], entry->path->slice, entry);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void asset_forget(asset_type_t type, const void* handle) {
+  assert(type >= 0 && type < ASSET_TYPES_COUNT);
+  if (!_assets[type] || !handle) return;
+
+  // Only keyed by path, but this only happens when a model is deleted by hand
+  asset_entry_t* found = NULL;
+  asset_entry_t** map_foreach(pentry, _assets[type]) {
+    if ((*pentry)->handle == handle) found = *pentry;
+  }
+
+  if (!found) return;
+
+  map_asset_remove(_assets[type], found->path->slice);
+  str_delete(&found->path);
+  free(found);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void asset_retain(asset_type_t type, slice_t path) {
+  asset_entry_t* entry = _asset_find(type, path);
+  assert(entry);
+  ++entry->refs;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void asset_release(asset_type_t type, slice_t path) {
+  asset_entry_t* entry = _asset_find(type, path);
+  assert(entry);
+  _asset_unref(type, entry);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void asset_hold(asset_type_t type, slice_t path) {
+  asset_entry_t* entry = _asset_find(type, path);
+  assert(entry);
+
+  // Assets loaded at startup, before the first scene, stay loaded for good
+  if (_scene_generation == 0) {
+    if (!entry->pinned) ++entry->refs;
+    entry->pinned = true;
+    return;
+  }
+
+  if (entry->scene == _scene_generation) return;
+
+  // A hold left over from the previous scene carries over to this one
+  if (entry->scene != _scene_generation - 1) ++entry->refs;
+  entry->scene = _scene_generation;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Scene switching
+////////////////////////////////////////////////////////////////////////////////
+
+void asset_scene_begin(void) {
+  ++_scene_generation;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void asset_scene_end(void) {
+  index_t previous = _scene_generation - 1;
+
+  for (index_t type = 0; type < ASSET_TYPES_COUNT; ++type) {
+    if (!_assets[type]) continue;
+
+    // Collect first, releasing can remove entries from the map
+    index_t count = 0;
+    asset_entry_t** expired = malloc(
+      sizeof(asset_entry_t*) * MAX(_assets[type]->size, 1)
+    );
+    assert(expired);
+
+    asset_entry_t** map_foreach(pentry, _assets[type]) {
+      if ((*pentry)->scene == previous) expired[count++] = *pentry;
+    }
+
+    for (index_t i = 0; i < count; ++i) {
+      expired[i]->scene = -1;
+      _asset_unref(type, expired[i]);
+    }
+
+    if (count) {
+      str_log("[Asset.scene] Released {} assets from the previous scene",
+        count
+      );
+    }
+
+    free(expired);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+index_t asset_count(asset_type_t type) {
+  assert(type >= 0 && type < ASSET_TYPES_COUNT);
+  return _assets[type] ? _assets[type]->size : 0;
+}
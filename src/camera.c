@@ -181,3 +181,47 @@ vec3 camera_ray(const camera_t* camera, vec2 ndc_pos) {
   );
   return mv3mul(m3transpose(m43(camera->view)), vec);
 }
+
+////////////////////////////////////////////////////////////////////////////////
+// Extract the view frustum planes from the projection-view matrix
+////////////////////////////////////////////////////////////////////////////////
+
+// Gribb/Hartmann: each plane is the 4th row of the matrix plus or minus one of
+//    the other rows. The matrices are column-major, so row i is the i-th
+//    component of each column.
+frustum_t camera_frustum(const camera_t* camera) {
+  const mat4* m = &camera->projview;
+  frustum_t ret;
+
+  for (int axis = 0; axis < 3; ++axis) {
+    for (int side = 0; side < 2; ++side) {
+      float sign = side ? -1.f : 1.f;
+      vec4 plane;
+
+      for (int col = 0; col < 4; ++col) {
+        plane.f[col] = m->col[col].f[3] + sign * m->col[col].f[axis];
+      }
+
+      float len = v3mag(plane.xyz);
+      if (len > 0) {
+        for (int i = 0; i < 4; ++i) plane.f[i] /= len;
+      }
+
+      ret.planes[axis * 2 + side] = plane;
+    }
+  }
+
+  return ret;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Test if a sphere is at least partially inside the frustum
+////////////////////////////////////////////////////////////////////////////////
+
+bool frustum_test_sphere(const frustum_t* frustum, vec3 center, float r) {
+  for (int i = 0; i < 6; ++i) {
+    const vec4* plane = &frustum->planes[i];
+    if (v3dot(plane->xyz, center) + plane->w < -r) return false;
+  }
+  return true;
+}
@@ -1,3 +1,15 @@
+// Per-frame values written by gfx_update_frame, must match frame_constants_t
+//    in graphics.c. Shaders loaded from files declare the same block.
+#define SHADER_FRAME_CONSTANTS "\
+layout(std140) uniform FrameConstants {\n\
+  highp mat4  in_pv_matrix;\n\
+  highp mat4  in_view_matrix;\n\
+  highp mat4  in_proj_matrix;\n\
+  highp mat4  in_proj_inverse;\n\
+  highp vec2  in_resolution;\n\
+  highp float in_time;\n\
+  highp float in_frame_time;\n\
+};\n"
 
 static const char shader_basic_vert[] = "\
 #version 300 es\n\
@@ -25,8 +37,8 @@ static const char shader_particle_vert[] = "\
 layout(location = 0) in vec3 position;\n\
 layout(location = 1) in vec2 uv;\n\
 layout(location = 5) in vec3 model_pos;\n\
-layout(location = 11) in float model_scale;\n\
-uniform mat4 in_pv_matrix;\n\
+layout(location = 11) in float model_scale;\n"
+SHADER_FRAME_CONSTANTS "\
 out highp vec2 vUV;\n\
 void main() {\n\
   vec4 final = vec4(model_pos + position * model_scale, 1.0);\n\
@@ -54,9 +54,9 @@ static bool draw_init_gl() {
   const void* color_offset = (void*)sizeof(vec3);
 
   glGenVertexArrays(1, &gl_vao);
-  glBindVertexArray(gl_vao);
+  gl_bind_vertex_array(gl_vao);
   glGenBuffers(1, &gl_buffer);
-  glBindBuffer(GL_ARRAY_BUFFER, gl_buffer);
+  gl_bind_buffer(GL_ARRAY_BUFFER, gl_buffer);
   glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vert), 0);
   glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Vert), color_offset);
   glEnableVertexAttribArray(0);
@@ -167,14 +167,14 @@ void draw_render() {
   int size_lines = (int)geometry->size;
   Vert* draw_buffer = geometry->begin;
 
-  glBindVertexArray(gl_vao);
-  glBindBuffer(GL_ARRAY_BUFFER, gl_buffer);
+  gl_bind_vertex_array(gl_vao);
+  gl_bind_buffer(GL_ARRAY_BUFFER, gl_buffer);
   glBufferData(GL_ARRAY_BUFFER, size_bytes, draw_buffer, GL_STATIC_DRAW);
 
   glDrawArrays(GL_LINES, 0, size_lines);
 
-  glBindVertexArray(0);
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  gl_bind_vertex_array(0);
+  gl_bind_buffer(GL_ARRAY_BUFFER, 0);
 
   draw_default_state();
   arr_vert_clear(geometry);
@@ -182,7 +182,7 @@ void draw_render() {
 
 void draw_cleanup() {
   arr_vert_delete(&geometry);
-  glDeleteBuffers(1, &gl_buffer);
-  glDeleteVertexArrays(1, &gl_vao);
+  gl_delete_buffers(1, &gl_buffer);
+  gl_delete_vertex_arrays(1, &gl_vao);
   gl_buffer = 0; gl_vao = 0;
 }
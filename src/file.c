@@ -26,19 +26,90 @@
 #include "file.h"
 #undef MCLIB_INTERNAL_IMPL
 
+#include "loaders/wpack.h"
+
+#include "array.h"
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "SDL3/SDL.h"
 
+#ifndef __WASM__
+# ifdef _WIN32
+#   include <Windows.h>
+# else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+# endif
+#endif
+
 typedef struct File_Internal {
   struct _opaque_File_t pub;
   String        name_internal;
   SDL_AsyncIO*  stream;
   byte*         buffer;
   index_t       size;
+  bool          packed;   // buffer points into a mounted pack, not owned
+  bool          reading;  // an SDL read into buffer hasn't reported back yet
+  bool          deleted;  // freed by file_loading_manager once reading is done
+
+  // Streaming reads, where buffer only holds the chunk being consumed
+  file_chunk_fn_t chunk_fn;
+  void*         chunk_data;
+  index_t       chunk_size;
+  index_t       stream_offset;
 } File_Internal;
 
+// Mounted asset packs, searched most recently mounted first
+#define FILE_PACKS_MAX 8
+
+typedef struct file_pack_t {
+  String        name;
+  wpack_t       pack;
+  bool          ready;
+#ifdef __WASM__
+  File          file;
+#else
+  void*         mapping;
+  index_t       mapping_size;
+# ifdef _WIN32
+  HANDLE        handle;
+  HANDLE        map_handle;
+# endif
+#endif
+} file_pack_t;
+
+#ifdef __WASM__
+# include "wasp.h"
+
+extern SDL_AsyncIO* js_file_create(File_Internal*, const char* name, int len);
+extern void         js_file_open_async(SDL_AsyncIO* stream);
+extern bool         js_file_read(
+  SDL_AsyncIO* stream, void* dst, index_t offset, index_t size
+);
+extern void         js_file_close(SDL_AsyncIO* stream);
+#endif
+
+static file_pack_t _packs[FILE_PACKS_MAX];
+static index_t _pack_count = 0;
+
+#ifndef __WASM__
+// Image decoders look up packs from their own threads, so the main thread only
+//    changes the pack table while holding this for writing
+static SDL_RWLock* _packs_lock = NULL;
+#endif
+
+// Streams whose data is already in memory (packed, or fetched on the web) are
+//    fed to their consumers from file_loading_manager
+static array_t _streams_array = {
+  .element_size = sizeof(File_Internal*)
+};
+static Array _streams = &_streams_array;
+
 #ifndef __WASM__
 static char* _sdl_modes[FM_COUNT] = {
   "r",
@@ -95,6 +166,7 @@ File_Internal* _file_new(slice_t filename, file_mode_t mode) {
 
 void _file_assign_buffer(File_Internal* file, void* buffer, index_t size) {
   file->buffer = buffer;
+  file->size = size;
 
   // Connect the public data handles for the file data
   file->pub.slice = (slice_t) {
@@ -110,10 +182,199 @@ void _file_assign_buffer(File_Internal* file, void* buffer, index_t size) {
 
 ////////////////////////////////////////////////////////////////////////////////
 
+static void _file_free(File_Internal* file) {
+  if (file->buffer && !file->packed) free(file->buffer);
+  str_delete(&file->name_internal);
+  free(file);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool file_pack_lookup(slice_t filename, slice_t* out) {
+  assert(out);
+
+  for (index_t i = _pack_count - 1; i >= 0; --i) {
+    if (!_packs[i].ready) continue;
+    if (wpack_find(&_packs[i].pack, filename, out)) return true;
+  }
+
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static bool _file_open_packed(File_Internal* file) {
+  if (file->pub.mode != FM_READ) return false;
+
+  slice_t data;
+  if (!file_pack_lookup(file->pub.name, &data)) return false;
+
+  file->packed = true;
+
+  if (file->chunk_fn) {
+    file->buffer = (byte*)data.begin;
+    file->size = data.size;
+    arr_insert_back(_streams, &file);
+    return true;
+  }
+
+  _file_assign_buffer(file, (void*)data.begin, data.size);
+  file->pub.status = S_READY;
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Streaming reads
+////////////////////////////////////////////////////////////////////////////////
+
+static File_Internal* _file_new_stream(
+  slice_t filename, index_t chunk_size, file_chunk_fn_t fn, void* data
+) {
+  assert(fn);
+
+  File_Internal* ret = _file_new(filename, FM_READ);
+  ret->chunk_fn = fn;
+  ret->chunk_data = data;
+  ret->chunk_size = chunk_size > 0 ? chunk_size : FILE_STREAM_CHUNK_DEFAULT;
+
+  // A stream counts as loading until its consumer has seen the last chunk
+  ret->pub.status = S_LOADING;
+  ++_async_loading_count;
+
+  return ret;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void _file_stream_end(File_Internal* file, status_t status) {
+  if (file->buffer && !file->packed) free(file->buffer);
+  file->buffer = NULL;
+  file->packed = false;
+  file->pub.status = status;
+
+  --_async_loading_count;
+  assert(_async_loading_count >= 0);
+
+  if (file->stream) {
 #ifndef __WASM__
+    SDL_CloseAsyncIO(file->stream, false, _sdl_queue, NULL);
+#else
+    js_file_close(file->stream);
+#endif
+    file->stream = NULL;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static bool _file_stream_deliver(
+  File_Internal* file, const void* chunk, index_t size
+) {
+  slice_t data = { .begin = chunk, .size = size };
+  file->stream_offset += size;
+
+  bool last = file->stream_offset >= file->size;
+  bool more = file->chunk_fn((File)file, data, last, file->chunk_data);
+
+  if (!last && more) return true;
+
+  _file_stream_end(file, last ? S_READY : S_CLOSED);
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Each stream is handed one chunk per call, the same as when a native read
+//    completes, so a large packed or fetched file is spread over several frames
+static void _file_streams_pump(void) {
+  index_t i = _streams->size;
+
+  // Consumers can open or delete streams, so stay within the current size
+  while ((i = MIN(i, _streams->size)) > 0) {
+    File_Internal* file = ((File_Internal**)_streams->begin)[--i];
+    arr_remove_unstable(_streams, i);
+
+    index_t size = MIN(file->chunk_size, file->size - file->stream_offset);
+    const byte* chunk = file->buffer;
+
+    if (file->packed) {
+      chunk += file->stream_offset;
+    }
+#ifdef __WASM__
+    else if (size && !js_file_read(
+      file->stream, file->buffer, file->stream_offset, size
+    )) {
+      str_log("[File.stream] Failed to read from file: {}", file->pub.name);
+      _file_stream_end(file, S_FAILED);
+      continue;
+    }
+#endif
+
+    if (_file_stream_deliver(file, chunk, size)) {
+      arr_insert_back(_streams, &file);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __WASM__
+
+static bool _file_stream_read(File_Internal* file) {
+  index_t size = MIN(file->chunk_size, file->size - file->stream_offset);
+
+  file->reading = SDL_ReadAsyncIO(
+    file->stream, file->buffer, file->stream_offset, size, _sdl_queue, file
+  );
+
+  return file->reading;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+File file_new_stream(
+  slice_t filename, index_t chunk_size, file_chunk_fn_t fn, void* data
+) {
+  File_Internal* ret = _file_new_stream(filename, chunk_size, fn, data);
+
+  if (_file_open_packed(ret)) return (File)ret;
+
+  str_log("[File.stream] Streaming: {}", filename);
+
+  ret->stream = SDL_AsyncIOFromFile(ret->name_internal->begin, "r");
+  ret->size = ret->stream ? SDL_GetAsyncIOSize(ret->stream) : -1;
+
+  if (ret->size < 0) {
+    str_log("[File.stream] Failed to open file: {}", filename);
+    _file_stream_end(ret, S_FAILED);
+    return (File)ret;
+  }
+
+  // Empty files still get their one (last) call from file_loading_manager
+  if (ret->size == 0) {
+    arr_insert_back(_streams, &ret);
+    return (File)ret;
+  }
+
+  ret->buffer = malloc(MIN(ret->chunk_size, ret->size));
+  assert(ret->buffer);
+
+  if (!_file_stream_read(ret)) {
+    str_log("[File.stream] Could not start loading file: {}", filename);
+    _file_stream_end(ret, S_FAILED);
+  }
+
+  return (File)ret;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 File file_new(slice_t filename, file_mode_t mode) {
   File_Internal* ret = _file_new(filename, mode);
 
+  if (_file_open_packed(ret)) return (File)ret;
+
   str_log("[File.new] Loading: {}", filename);
 
   ret->stream = SDL_AsyncIOFromFile(
@@ -134,14 +395,15 @@ File file_new(slice_t filename, file_mode_t mode) {
     ret->buffer = malloc(ret->size);
     ++_async_loading_count;
 
-    bool async_started = SDL_ReadAsyncIO(
+    ret->reading = SDL_ReadAsyncIO(
       ret->stream, ret->buffer, 0, ret->size, _sdl_queue, ret
     );
 
-    if (async_started) {
+    if (ret->reading) {
       ret->pub.status = S_LOADING;
     }
     else {
+      --_async_loading_count;
       ret->pub.status = S_FAILED;
       str_log("[File.new] Could not start loading file: {}", filename);
     }
@@ -151,29 +413,54 @@ File file_new(slice_t filename, file_mode_t mode) {
 }
 #else
 
-#include "wasp.h"
+// Files requested while a pack is still downloading wait here until the pack
+//    is ready, so they can be served from it instead of fetched separately.
+static array_t _pending_files_array = {
+  .element_size = sizeof(File_Internal*)
+};
+static Array _pending_files = &_pending_files_array;
 
-extern SDL_AsyncIO* js_file_create(File_Internal*, const char* name, int len);
-extern void         js_file_open_async(SDL_AsyncIO* stream);
-extern bool         js_file_read(SDL_AsyncIO* stream, void* dst, index_t size);
-extern void         js_file_close(SDL_AsyncIO* stream);
+static void _file_fetch(File_Internal* file) {
+  slice_t name = file->name_internal->slice;
+  file->stream = js_file_create(file, name.begin, name.size);
+  assert(file->stream);
+
+  js_file_open_async(file->stream);
+}
 
 void export(file_open_async_done)(File_Internal* file, index_t size) {
   assert(file);
   assert(file->pub.status == S_LOADING);
 
-  --_async_loading_count;
-
   if (!size) {
     str_log("[File.read] Failed to open file: {}", file->pub.name);
-    file->pub.status = S_NOT_FOUND;
+
+    if (file->chunk_fn) {
+      _file_stream_end(file, S_NOT_FOUND);
+    }
+    else {
+      --_async_loading_count;
+      file->pub.status = S_NOT_FOUND;
+    }
+    return;
+  }
+
+  // Streams read from the fetched data a chunk at a time, so only one chunk
+  //    of it is ever copied into wasm memory at once
+  if (file->chunk_fn) {
+    file->size = size;
+    file->buffer = malloc(MIN(file->chunk_size, size));
+    assert(file->buffer);
+    arr_insert_back(_streams, &file);
     return;
   }
 
+  --_async_loading_count;
+
   file->buffer = malloc(size);
   assert(file->buffer);
 
-  if (!js_file_read(file->stream, file->buffer, size)) {
+  if (!js_file_read(file->stream, file->buffer, 0, size)) {
     str_log("[File.read] Failed to read from file: {}", file->pub.name);
     file->pub.status = S_FAILED;
     return;
@@ -184,18 +471,45 @@ void export(file_open_async_done)(File_Internal* file, index_t size) {
   file->pub.status = S_READY;
 }
 
+static bool _file_packs_loading(void) {
+  for (index_t i = 0; i < _pack_count; ++i) {
+    if (!_packs[i].ready) return true;
+  }
+  return false;
+}
+
 File file_new(slice_t filename, file_mode_t mode) {
   assert(mode == FM_READ);
   File_Internal* ret = _file_new(filename, mode);
 
-  slice_t name = ret->name_internal->slice;
-  ret->stream = js_file_create(ret, name.begin, name.size);
-  assert(ret->stream);
+  if (_file_open_packed(ret)) return (File)ret;
 
   ret->pub.status = S_LOADING;
   ++_async_loading_count;
 
-  js_file_open_async(ret->stream);
+  if (_file_packs_loading()) {
+    arr_insert_back(_pending_files, &ret);
+  }
+  else {
+    _file_fetch(ret);
+  }
+
+  return (File)ret;
+}
+
+File file_new_stream(
+  slice_t filename, index_t chunk_size, file_chunk_fn_t fn, void* data
+) {
+  File_Internal* ret = _file_new_stream(filename, chunk_size, fn, data);
+
+  if (_file_open_packed(ret)) return (File)ret;
+
+  if (_file_packs_loading()) {
+    arr_insert_back(_pending_files, &ret);
+  }
+  else {
+    _file_fetch(ret);
+  }
 
   return (File)ret;
 }
@@ -205,20 +519,44 @@ File file_new(slice_t filename, file_mode_t mode) {
 ////////////////////////////////////////////////////////////////////////////////
 
 void file_loading_manager(void) {
+  _file_streams_pump();
+
 #ifndef __WASM__
   SDL_AsyncIOOutcome result;
 
   while (SDL_GetAsyncIOResult(_sdl_queue, &result)) {
     File_Internal* file = result.userdata;
 
-    // If we closed a stream successfully, remove its now invalid pointer
-    if (result.type == SDL_ASYNCIO_TASK_CLOSE) {
-      file->stream = NULL;
+    // Reads are the only tasks queued with a file attached
+    if (result.type != SDL_ASYNCIO_TASK_READ) continue;
+    assert(file && file->reading);
+    file->reading = false;
+
+    // The file was deleted mid-read, and can be freed now that SDL is done
+    if (file->deleted) {
+      _file_free(file);
       continue;
     }
 
-    // If we're not reading, skip to the next one
-    if (result.type != SDL_ASYNCIO_TASK_READ) continue;
+    if (file->chunk_fn) {
+      if (result.result != SDL_ASYNCIO_COMPLETE
+      ||  result.bytes_transferred == 0
+      ) {
+        str_log("[File.stream] Failed reading file: {}", file->pub.name);
+        _file_stream_end(file, S_FAILED);
+        continue;
+      }
+
+      bool more = _file_stream_deliver(
+        file, result.buffer, (index_t)result.bytes_transferred
+      );
+
+      if (more && !_file_stream_read(file)) {
+        str_log("[File.stream] Failed reading file: {}", file->pub.name);
+        _file_stream_end(file, S_FAILED);
+      }
+      continue;
+    }
 
     --_async_loading_count;
     assert(_async_loading_count >= 0);
@@ -233,8 +571,50 @@ void file_loading_manager(void) {
     file->pub.status = S_READY;
 
     bool should_flush = file->pub.mode != FM_READ;
-    SDL_CloseAsyncIO(file->stream, should_flush, _sdl_queue, file);
+    SDL_CloseAsyncIO(file->stream, should_flush, _sdl_queue, NULL);
+    file->stream = NULL;
+  }
+#else
+  bool packs_changed = false;
+
+  for (index_t i = 0; i < _pack_count; ++i) {
+    file_pack_t* pack = &_packs[i];
+    if (pack->ready || pack->file->status == S_LOADING) continue;
+
+    if (pack->file->status != S_READY
+    ||  !wpack_parse(pack->file->slice, &pack->pack)
+    ) {
+      str_log("[File.pack] Failed to mount pack: {}", pack->name);
+      file_delete(&pack->file);
+      str_delete(&pack->name);
+      memmove(pack, pack + 1, (--_pack_count - i) * sizeof(file_pack_t));
+      --i;
+      packs_changed = true;
+      continue;
+    }
+
+    str_log("[File.pack] Mounted: {} ({} files)",
+      pack->name, pack->pack.entry_count
+    );
+    pack->ready = true;
+    packs_changed = true;
+  }
+
+  if (!packs_changed || _file_packs_loading()) return;
+
+  // All packs are settled, serve waiting files from them or fetch them
+  File_Internal** arr_foreach(pfile, _pending_files) {
+    File_Internal* file = *pfile;
+
+    if (_file_open_packed(file)) {
+      if (!file->chunk_fn) --_async_loading_count;
+    }
+    else {
+      _file_fetch(file);
+    }
   }
+
+  arr_clear(_pending_files);
 #endif
 }
 
@@ -244,6 +624,191 @@ index_t file_loading_count(void) {
   return _async_loading_count;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Asset packs
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __WASM__
+
+static bool _file_pack_map(file_pack_t* pack) {
+  const char* filename = pack->name->begin;
+
+# ifdef _WIN32
+  pack->handle = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL,
+    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL
+  );
+  if (pack->handle == INVALID_HANDLE_VALUE) return false;
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(pack->handle, &size) || size.QuadPart == 0) {
+    CloseHandle(pack->handle);
+    return false;
+  }
+
+  pack->map_handle = CreateFileMappingA(
+    pack->handle, NULL, PAGE_READONLY, 0, 0, NULL
+  );
+  pack->mapping = pack->map_handle
+    ? MapViewOfFile(pack->map_handle, FILE_MAP_READ, 0, 0, 0)
+    : NULL;
+
+  if (!pack->mapping) {
+    if (pack->map_handle) CloseHandle(pack->map_handle);
+    CloseHandle(pack->handle);
+    return false;
+  }
+
+  pack->mapping_size = (index_t)size.QuadPart;
+# else
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0) return false;
+
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size == 0) {
+    close(fd);
+    return false;
+  }
+
+  void* mapping = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd); // the mapping keeps its own reference to the file
+
+  if (mapping == MAP_FAILED) return false;
+
+  pack->mapping = mapping;
+  pack->mapping_size = (index_t)info.st_size;
+# endif
+
+  return true;
+}
+
+static void _file_pack_unmap(file_pack_t* pack) {
+# ifdef _WIN32
+  UnmapViewOfFile(pack->mapping);
+  CloseHandle(pack->map_handle);
+  CloseHandle(pack->handle);
+# else
+  munmap(pack->mapping, pack->mapping_size);
+# endif
+  pack->mapping = NULL;
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __WASM__
+
+// Created on first use, since a decoder thread may get to it before any mount
+static SDL_RWLock* _file_packs_rwlock(void) {
+  SDL_RWLock* lock = SDL_GetAtomicPointer((void**)&_packs_lock);
+  if (lock) return lock;
+
+  lock = SDL_CreateRWLock();
+  assert(lock);
+
+  if (!SDL_CompareAndSwapAtomicPointer((void**)&_packs_lock, NULL, lock)) {
+    SDL_DestroyRWLock(lock);
+  }
+
+  return SDL_GetAtomicPointer((void**)&_packs_lock);
+}
+
+void file_packs_lock(void) {
+  SDL_LockRWLockForReading(_file_packs_rwlock());
+}
+
+void file_packs_unlock(void) {
+  SDL_UnlockRWLock(_file_packs_rwlock());
+}
+
+#else
+
+void file_packs_lock(void) { }
+void file_packs_unlock(void) { }
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool file_mount_pack(slice_t filename) {
+  assert(!slice_is_empty(filename));
+
+  if (_pack_count >= FILE_PACKS_MAX) {
+    str_log("[File.pack] Too many packs mounted for: {}", filename);
+    return false;
+  }
+
+  file_pack_t* pack = &_packs[_pack_count];
+  *pack = (file_pack_t) {
+    .name = str_copy(filename),
+    .ready = false,
+  };
+
+#ifndef __WASM__
+  if (!_file_pack_map(pack)) {
+    str_log("[File.pack] Failed to map pack: {}", filename);
+    str_delete(&pack->name);
+    return false;
+  }
+
+  slice_t data = { .begin = pack->mapping, .size = pack->mapping_size };
+
+  if (!wpack_parse(data, &pack->pack)) {
+    str_log("[File.pack] Not a valid pack: {}", filename);
+    _file_pack_unmap(pack);
+    str_delete(&pack->name);
+    return false;
+  }
+
+  str_log("[File.pack] Mounted: {} ({} files)",
+    filename, pack->pack.entry_count
+  );
+  pack->ready = true;
+#else
+  // The whole pack is fetched as one request, and files requested until it
+  //    arrives wait for it in file_loading_manager
+  File_Internal* file = _file_new(filename, FM_READ);
+  file->pub.status = S_LOADING;
+  ++_async_loading_count;
+  _file_fetch(file);
+  pack->file = (File)file;
+#endif
+
+  // The new slot is only visible to lookups once the count includes it
+#ifndef __WASM__
+  SDL_LockRWLockForWriting(_file_packs_rwlock());
+  ++_pack_count;
+  SDL_UnlockRWLock(_file_packs_rwlock());
+#else
+  ++_pack_count;
+#endif
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void file_unmount_packs(void) {
+  // Waits for any decoder still reading from a mapping
+#ifndef __WASM__
+  SDL_LockRWLockForWriting(_file_packs_rwlock());
+#endif
+
+  for (index_t i = 0; i < _pack_count; ++i) {
+#ifndef __WASM__
+    _file_pack_unmap(&_packs[i]);
+#else
+    file_delete(&_packs[i].file);
+#endif
+    str_delete(&_packs[i].name);
+  }
+
+  _pack_count = 0;
+
+#ifndef __WASM__
+  SDL_UnlockRWLock(_file_packs_rwlock());
+#endif
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Closing and deleting
 ////////////////////////////////////////////////////////////////////////////////
@@ -251,9 +816,29 @@ index_t file_loading_count(void) {
 void file_delete(File* _file) {
   if (!_file || !*_file) return;
   File_Internal* file = (File_Internal*)*_file;
+  *_file = NULL;
+
+  // Whatever it was waiting on, a deleted file is no longer loading
+  if (file->pub.status == S_LOADING) {
+    --_async_loading_count;
+    assert(_async_loading_count >= 0);
+  }
+
+  for (index_t i = 0; i < _streams->size; ++i) {
+    if (((File_Internal**)_streams->begin)[i] != file) continue;
+    arr_remove_unstable(_streams, i);
+    break;
+  }
 
-  if (file->buffer) free(file->buffer);
+#ifdef __WASM__
+  for (index_t i = 0; i < _pending_files->size; ++i) {
+    if (((File_Internal**)_pending_files->begin)[i] != file) continue;
+    arr_remove_unstable(_pending_files, i);
+    break;
+  }
+#endif
 
+  // SDL closes the stream only after any read still in flight
   if (file->stream) {
 #ifndef __WASM__
     assert(_sdl_queue);
@@ -261,12 +846,16 @@ void file_delete(File* _file) {
 #else
     js_file_close(file->stream);
 #endif
+    file->stream = NULL;
   }
 
-  str_delete(&file->name_internal);
+  // That read still writes into the buffer and reports back with this file
+  if (file->reading) {
+    file->deleted = true;
+    return;
+  }
 
-  free(file);
-  *_file = NULL;
+  _file_free(file);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -275,10 +864,19 @@ span_byte_t file_release_data(File _file) {
   File_Internal* file = (File_Internal*)_file;
   assert(file);
 
-  if (file->pub.status != S_READY) return span_byte_empty;
+  if (file->pub.status != S_READY || file->chunk_fn) return span_byte_empty;
 
   span_byte_t ret = span_byte(file->buffer, file->size);
 
+  // Packed data belongs to the pack, so the caller gets its own copy
+  if (file->packed) {
+    byte* copy = malloc(MAX(file->size, 1));
+    assert(copy);
+    memcpy(copy, file->buffer, file->size);
+    ret = span_byte(copy, file->size);
+    file->packed = false;
+  }
+
   file->buffer = NULL;
   file->size = 0;
   file->pub.data = span_byte_empty.view;
@@ -29,6 +29,9 @@
 #include "light.h"
 #include "graphics.h"
 #include "particles.h"
+#include "spatial.h"
+#include "thread.h"
+#include "asset.h"
 #include "wasp.h"
 
 #define con_type struct entity_t
@@ -65,7 +68,25 @@ typedef struct render_key_t {
 #undef con_prefix
 #undef con_type
 
+// Entity changes made by behaviors running on job threads. Each chunk of
+//    parallel actors records into its own buffer, and the buffers are merged
+//    in chunk order so the result doesn't depend on thread timing.
+typedef struct entity_commands_t {
+  Array_id updates;
+  Array_id removals;
+} entity_commands_t;
+
+#define con_type entity_commands_t
+#define con_prefix cmd
+#include "array.h"
+#undef con_prefix
+#undef con_type
+
 #include <stdlib.h>
+#include <math.h> // sqrtf
+
+// Number of parallel behaviors run by each job
+#define GAME_PARALLEL_CHUNK 64
 
 ////////////////////////////////////////////////////////////////////////////////
 // Internal Game struct
@@ -78,9 +99,12 @@ typedef struct Game_Internal {
   SlotMap_entity entities;
 
   Array_bk entity_actors;   // entities with attached behaviors
+  Array_bk entity_actors_parallel; // this frame's parallel behaviors
+  Array_cmd entity_commands; // deferred changes per parallel chunk
   Array_rk entity_render_updates; // entities with an onrender to update
   Array_id entity_updates;  // entities that have transforms to update
   Array_id entity_removals; // ids of entities to remove at end of frame
+  Array_id entity_bounds_pending; // entities waiting on a model to load
 
 } Game_Internal;
 
@@ -92,6 +116,7 @@ typedef struct Game_Internal {
 
 static Game _game_instance_primary = NULL;
 static thread_local Game _game_instance_local = NULL;
+static thread_local entity_commands_t* _entity_commands = NULL;
 
 #ifdef __WASM__
 int export(canary)(int _) {
@@ -128,6 +153,8 @@ static void _game_scene_close(Game_Internal* game) {
   arr_bk_clear(game->entity_actors);
   arr_id_clear(game->entity_updates);
   arr_id_clear(game->entity_removals);
+  arr_id_clear(game->entity_bounds_pending);
+  spatial_clear(game->pub.spatial);
 
   // Clear out instance data from the renderers
   gfx_clear_instances(game->pub.graphics);
@@ -163,10 +190,13 @@ static void _game_scene_switch(Game_Internal* game) {
   game->pub.scene_time = 0.0f;
   game->pub.frame_time = 0.016f;
 
-  // Load the next scene
+  // Load the next scene. Assets it asks for that the last scene also used are
+  //    still loaded, and only the leftovers are released after.
   scene_load_fn_t load_scene = span_scene_get(game->pub.scenes, game->pub.next_scene);
   assert(load_scene);
+  asset_scene_begin();
   game->scene_unload = load_scene((Game)game);
+  asset_scene_end();
   game->pub.scene = game->pub.next_scene;
   game->pub.next_scene = -1;
 }
@@ -207,6 +237,7 @@ Game game_new(String title, vec2i window_size) {
       .scene_time = 0,
       .graphics = gfx_new(),
       .particle_system = ps_new(),
+      .spatial = spatial_new(),
       .input = {
         .triggered = input_triggered,
         .pressed = input_pressed,
@@ -229,9 +260,12 @@ Game game_new(String title, vec2i window_size) {
     },
     .entities = smap_entity_new(),
     .entity_actors = arr_bk_new(),
+    .entity_actors_parallel = arr_bk_new(),
+    .entity_commands = arr_cmd_new(),
     .entity_render_updates = arr_rk_new(),
     .entity_updates = arr_id_new(),
     .entity_removals = arr_id_new(),
+    .entity_bounds_pending = arr_id_new(),
   };
 
   Game p_ret = (Game)ret;
@@ -263,8 +297,16 @@ void game_delete(Game* _game) {
   _game_scene_close(game);
   smap_entity_delete(&game->entities);
   arr_bk_delete(&game->entity_actors);
+  arr_bk_delete(&game->entity_actors_parallel);
+  entity_commands_t* arr_foreach(cmds, game->entity_commands) {
+    arr_id_delete(&cmds->updates);
+    arr_id_delete(&cmds->removals);
+  }
+  arr_cmd_delete(&game->entity_commands);
   arr_id_delete(&game->entity_removals);
   arr_id_delete(&game->entity_updates);
+  arr_id_delete(&game->entity_bounds_pending);
+  spatial_delete(&game->pub.spatial);
   if (_game_instance_primary == *_game) _game_instance_primary = NULL;
   if (_game_instance_local == *_game) _game_instance_local = NULL;
   free(game);
@@ -320,19 +362,86 @@ static void _game_entity_remove_execute(Game_Internal* game, slotkey_t key) {
 
     // remove registrations from renderer, physics, etc queues here
     renderer_entity_unregister(entity);
+    spatial_remove(game->pub.spatial, entity->id);
 
     // remove from the primary list of game entities
     smap_entity_remove(game->entities, entity->id);
   }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Spatial index bounds for entities
+////////////////////////////////////////////////////////////////////////////////
+
+// World-space bounding sphere from the model's bounds, false if the entity has
+//    no model or the model has no usable bounds
+static bool _entity_bounds(Entity e, vec3* center, float* radius) {
+  if (!e->model || e->model->bounds_radius <= 0) return false;
+  mat4 transform = entity_transform(e);
+  *center = mv4mul(transform, p34(e->model->bounds_center)).xyz;
+  *radius = e->model->bounds_radius * fabsf(e->scale);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void _game_entity_spatial_update(Game_Internal* game, Entity e) {
+  vec3 center;
+  float radius;
+
+  // mesh bounds aren't known until the model is built, so check again later
+  if (e->model && e->model->status != S_READY && e->model->status != S_ERROR) {
+    if (!e->is_pending_bounds) {
+      e->is_pending_bounds = true;
+      arr_id_push_back(game->entity_bounds_pending, e->id);
+    }
+    return;
+  }
+
+  if (!e->is_hidden && _entity_bounds(e, &center, &radius)) {
+    spatial_update(game->pub.spatial, e->id, aabb_from_sphere(center, radius));
+  }
+  else {
+    spatial_remove(game->pub.spatial, e->id);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void _game_entity_spatial_pending(Game_Internal* game) {
+  for (index_t i = 0; i < game->entity_bounds_pending->size; ) {
+    slotkey_t key = game->entity_bounds_pending->begin[i];
+    Entity e = smap_entity_ref(game->entities, key);
+
+    if (e && e->model && e->model->status != S_READY
+    &&  e->model->status != S_ERROR
+    ) {
+      ++i;
+      continue;
+    }
+
+    arr_id_remove_unstable(game->entity_bounds_pending, i);
+    if (!e) continue;
+
+    e->is_pending_bounds = false;
+    _game_entity_spatial_update(game, e);
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Per-entity update functions
 ////////////////////////////////////////////////////////////////////////////////
 
 static void _game_entity_update_execute(Game_Internal* game, slotkey_t key) {
   Entity e = smap_entity_ref(game->entities, key);
-  if (!e || !e->renderer || !e->is_dirty_renderer) return;
+  if (!e || !e->is_dirty_renderer) return;
+
+  _game_entity_spatial_update(game, e);
+
+  if (!e->renderer) {
+    e->is_dirty_renderer = false;
+    return;
+  }
 
   if (e->render_id.hash) {
     if (!e->is_hidden) {
@@ -351,6 +460,69 @@ static void _game_entity_update_execute(Game_Internal* game, slotkey_t key) {
   e->is_dirty_static = false;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Parallel behavior updates
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct behavior_batch_t {
+  Game_Internal*  game;
+  float           dt;
+} behavior_batch_t;
+
+static void _game_behavior_chunk(index_t begin, index_t end, void* data) {
+  behavior_batch_t* batch = data;
+  Game_Internal* game = batch->game;
+  index_t chunk = begin / GAME_PARALLEL_CHUNK;
+
+  // job threads need the local game for the entity functions to work
+  game_set_local((Game)game);
+  _entity_commands = &game->entity_commands->begin[chunk];
+
+  for (index_t i = begin; i < end; ++i) {
+    behavior_key_t key = game->entity_actors_parallel->begin[i];
+    Entity entity = smap_entity_ref(game->entities, key.entity_id);
+    entity->behavior((Game)game, entity, batch->dt);
+  }
+
+  _entity_commands = NULL;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void _game_update_parallel(Game_Internal* game, float dt) {
+  index_t count = game->entity_actors_parallel->size;
+  if (!count) return;
+
+  index_t chunks = (count + GAME_PARALLEL_CHUNK - 1) / GAME_PARALLEL_CHUNK;
+  while (game->entity_commands->size < chunks) {
+    arr_cmd_push_back(game->entity_commands, (entity_commands_t) {
+      .updates = arr_id_new(),
+      .removals = arr_id_new(),
+    });
+  }
+
+  behavior_batch_t batch = { .game = game, .dt = dt };
+  jobs_parallel_for(count, GAME_PARALLEL_CHUNK, _game_behavior_chunk, &batch);
+
+  // merging in chunk order keeps the queues in actor order
+  for (index_t i = 0; i < chunks; ++i) {
+    entity_commands_t* cmds = &game->entity_commands->begin[i];
+
+    slotkey_t* arr_foreach(key, cmds->updates) {
+      arr_id_push_back(game->entity_updates, *key);
+    }
+
+    arr_foreach(key, cmds->removals) {
+      arr_id_push_back(game->entity_removals, *key);
+    }
+
+    arr_id_clear(cmds->updates);
+    arr_id_clear(cmds->removals);
+  }
+
+  arr_bk_clear(game->entity_actors_parallel);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Per-frame call to update entity behaviors and clear input changes
 ////////////////////////////////////////////////////////////////////////////////
@@ -382,10 +554,20 @@ void game_update(Game _game, float dt) {
       continue;
     }
 
-    entity->behavior(_game, entity, dt);
+    if (entity->is_parallel) {
+      arr_bk_push_back(game->entity_actors_parallel, key);
+    }
+    else {
+      entity->behavior(_game, entity, dt);
+    }
+
     ++i;
   }
 
+  // Behaviors flagged as parallel-safe run across the job threads once the
+  //    serial ones are done, and their deferred changes are merged in.
+  _game_update_parallel(game, dt);
+
   // Remove all the entities that were flagged for removal by either by their
   //    own behaviors or by another entity or system.
   // If an ondelete function causes more entities to be deleted, those entities
@@ -402,6 +584,7 @@ void game_update(Game _game, float dt) {
     _game_entity_update_execute(game, *key);
   }
   arr_id_clear(game->entity_updates);
+  _game_entity_spatial_pending(game);
 
   // Execute the particle system simulation
   ps_update(game->pub.particle_system, dt);
@@ -418,6 +601,7 @@ void game_render(Game _game) {
   GAME_INTERNAL;
   game->pub.camera.projview = camera_projection_view(&game->pub.camera);
   game->pub.camera.view = camera_view(&game->pub.camera);
+  gfx_update_frame(game->pub.graphics, _game);
 
   for (index_t i = 0; i < game->entity_render_updates->size; ) {
     render_key_t key = game->entity_render_updates->begin[i];
@@ -456,6 +640,7 @@ vec2i game_get_window_size(void) {
 slotkey_t entity_add(const entity_desc_t* proto) {
   Game_Internal* game = game_get_local_internal();
   assert(proto);
+  assert(!_entity_commands); // not from parallel behaviors
 
   slotkey_t key;
   entity_t* entity = smap_entity_emplace(game->entities, &key);
@@ -496,6 +681,7 @@ slotkey_t entity_add(const entity_desc_t* proto) {
     .tint = b4white,
     .is_hidden = proto->is_hidden,
     .is_static = proto->is_static,
+    .is_parallel = proto->is_parallel,
     .behavior = proto->behavior,
     .onrender = proto->onrender,
     .oncreate = proto->oncreate,
@@ -525,6 +711,9 @@ slotkey_t entity_add(const entity_desc_t* proto) {
     entity_set_material_index(entity, proto->material_index);
   }
 
+  // Add it to the spatial index if it has bounds
+  _game_entity_spatial_update(game, entity);
+
   // Run on-create callback
   if (entity->oncreate) {
     entity->oncreate((Game)game, entity);
@@ -538,6 +727,11 @@ slotkey_t entity_add(const entity_desc_t* proto) {
 ////////////////////////////////////////////////////////////////////////////////
 
 void entity_remove(slotkey_t id) {
+  if (_entity_commands) {
+    arr_id_push_back(_entity_commands->removals, id);
+    return;
+  }
+
   Game_Internal* game = game_get_local_internal();
   arr_id_push_back(game->entity_removals, id);
 }
@@ -563,12 +757,55 @@ entity_t* entity_ref(slotkey_t id) {
   return smap_entity_ref(game->entities, id);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Finds the closest entity whose bounding sphere the ray passes through
+////////////////////////////////////////////////////////////////////////////////
+
+static bool _entity_ray_test(
+  slotkey_t id, vec3 origin, vec3 dir, float* t, void* data
+) {
+  Game_Internal* game = data;
+  Entity e = smap_entity_ref(game->entities, id);
+  vec3 center;
+  float radius;
+  if (!e || !_entity_bounds(e, &center, &radius)) return false;
+
+  vec3 oc = v3sub(origin, center);
+  float b = v3dot(oc, dir);
+  float c = v3dot(oc, oc) - radius * radius;
+  float disc = b * b - c;
+  if (disc < 0) return false;
+
+  // starting inside the sphere counts as a hit at the origin
+  float hit = c <= 0 ? 0 : -b - sqrtf(disc);
+  if (hit < 0) return false;
+
+  *t = hit;
+  return true;
+}
+
+Entity entity_raycast(vec3 origin, vec3 dir, float max_dist, float* t) {
+  Game_Internal* game = game_get_local_internal();
+  spatial_hit_t hit;
+
+  dir = v3norm(dir);
+  if (!spatial_raycast(game->pub.spatial
+  , origin, dir, max_dist, _entity_ray_test, game, &hit
+  )) {
+    return NULL;
+  }
+
+  if (t) *t = hit.t;
+  return smap_entity_ref(game->entities, hit.id);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Setters for entity properties
 ////////////////////////////////////////////////////////////////////////////////
 
 void entity_set_behavior(Entity entity, entity_update_fn_t behavior) {
   assert(entity);
+  assert(!_entity_commands);
   if (entity->behavior == behavior) return;
   entity->behavior = behavior;
   if (!behavior) return;
@@ -579,6 +816,7 @@ void entity_set_behavior(Entity entity, entity_update_fn_t behavior) {
 
 void entity_set_onrender(Entity entity, entity_render_fn_t onrender) {
   assert(entity);
+  assert(!_entity_commands);
   if (entity->onrender == onrender) return;
   entity->onrender = onrender;
   if (!onrender) return;
@@ -598,14 +836,26 @@ mat4 entity_transform(Entity entity) {
 
 static void _entity_set_dirty(Entity entity) {
   if (!entity->is_dirty_renderer) {
-    Game_Internal* game = game_get_local_internal();
     entity->is_dirty_renderer = true;
+
+    if (_entity_commands) {
+      arr_id_push_back(_entity_commands->updates, entity->id);
+      return;
+    }
+
+    Game_Internal* game = game_get_local_internal();
     arr_id_add_back(game->entity_updates, entity->id);
   }
 }
 
+void entity_set_parallel(Entity entity, bool is_parallel) {
+  assert(entity);
+  entity->is_parallel = is_parallel;
+}
+
 void entity_set_renderer(Entity entity, renderer_t* renderer) {
   assert(entity);
+  assert(!_entity_commands);
   if (!renderer) {
     renderer_entity_unregister(entity);
   }
@@ -637,6 +887,7 @@ void entity_set_static(Entity entity, bool is_static) {
 void entity_set_model(Entity entity, Model model) {
   assert(entity);
   assert(model);
+  assert(!_entity_commands);
   if (model == entity->model) return;
 
   if (entity->renderer) {
@@ -647,11 +898,14 @@ void entity_set_model(Entity entity, Model model) {
   else {
     entity->model = model;
   }
+
+  _entity_set_dirty(entity);
 }
 
 void entity_set_material(Entity entity, Material material) {
   assert(entity);
   assert(material);
+  assert(!_entity_commands);
   if (material == entity->material) return;
 
   if (entity->renderer) {
@@ -0,0 +1,272 @@
+/*******************************************************************************
+* MIT License
+*
+* Copyright (c) 2026 Curtis McCoy
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "gl.h"
+
+#include <string.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// Shadow copy of the context state touched by the engine
+////////////////////////////////////////////////////////////////////////////////
+
+// Binding value meaning "not known", forcing the next bind through to GL
+#define GL_STATE_UNKNOWN ((GLuint)~0u)
+#define GL_STATE_TEXTURE_UNITS 16
+
+typedef enum gl_state_target_t {
+  GL_STATE_TEXTURE_2D,
+  GL_STATE_TEXTURE_2D_ARRAY,
+  GL_STATE_TEXTURE_CUBE_MAP,
+  GL_STATE_TEXTURE_TARGET_COUNT,
+} gl_state_target_t;
+
+// Capabilities tracked for gl_enable/gl_disable, others pass straight through
+static const GLenum _gl_state_caps[] = {
+  GL_BLEND, GL_CULL_FACE, GL_DEPTH_TEST, GL_SCISSOR_TEST, GL_STENCIL_TEST,
+  GL_POLYGON_OFFSET_FILL,
+};
+
+#define GL_STATE_CAP_COUNT (sizeof(_gl_state_caps) / sizeof(GLenum))
+
+// Zero matches the state of a freshly created context: nothing bound, unit 0
+//    active, and every tracked capability disabled.
+static struct {
+  GLuint  program;
+  GLuint  vertex_array;
+  GLuint  array_buffer;
+  GLuint  element_buffer;
+  GLuint  framebuffer;
+  GLuint  unit;
+  GLuint  textures[GL_STATE_TEXTURE_UNITS][GL_STATE_TEXTURE_TARGET_COUNT];
+  int8_t  caps[GL_STATE_CAP_COUNT]; // 0 disabled, 1 enabled, -1 unknown
+} _gl = { 0 };
+
+static gl_state_stats_t _gl_frame = { 0 };
+static gl_state_stats_t _gl_last_frame = { 0 };
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Returns true if the cached value had to change, in which case the caller
+//    issues the real call
+static inline bool _gl_state_set(GLuint* cached, GLuint value) {
+  if (*cached == value) {
+    ++_gl_frame.skipped;
+    return false;
+  }
+  *cached = value;
+  ++_gl_frame.issued;
+  return true;
+}
+
+static GLuint* _gl_state_buffer(GLenum target) {
+  switch (target) {
+    case GL_ARRAY_BUFFER:         return &_gl.array_buffer;
+    case GL_ELEMENT_ARRAY_BUFFER: return &_gl.element_buffer;
+    default:                      return NULL;
+  }
+}
+
+static int _gl_state_texture_target(GLenum target) {
+  switch (target) {
+    case GL_TEXTURE_2D:           return GL_STATE_TEXTURE_2D;
+    case GL_TEXTURE_2D_ARRAY:     return GL_STATE_TEXTURE_2D_ARRAY;
+    case GL_TEXTURE_CUBE_MAP:     return GL_STATE_TEXTURE_CUBE_MAP;
+    default:                      return -1;
+  }
+}
+
+static int _gl_state_cap(GLenum cap) {
+  for (size_t i = 0; i < GL_STATE_CAP_COUNT; ++i) {
+    if (_gl_state_caps[i] == cap) return (int)i;
+  }
+  return -1;
+}
+
+// Deleted names revert any binding to them back to zero
+static void _gl_state_forget(GLuint* cached, GLsizei n, const GLuint* names) {
+  for (GLsizei i = 0; i < n; ++i) {
+    if (names[i] && *cached == names[i]) *cached = 0;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Cached binds
+////////////////////////////////////////////////////////////////////////////////
+
+void gl_use_program(GLuint program) {
+  if (_gl_state_set(&_gl.program, program)) glUseProgram(program);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void gl_bind_vertex_array(GLuint array) {
+  if (!_gl_state_set(&_gl.vertex_array, array)) return;
+
+  // the element buffer binding belongs to the vertex array
+  _gl.element_buffer = GL_STATE_UNKNOWN;
+  glBindVertexArray(array);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void gl_bind_buffer(GLenum target, GLuint buffer) {
+  GLuint* cached = _gl_state_buffer(target);
+
+  if (!cached) ++_gl_frame.issued;
+  else if (!_gl_state_set(cached, buffer)) return;
+
+  glBindBuffer(target, buffer);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void gl_bind_framebuffer(GLenum target, GLuint framebuffer) {
+  if (target != GL_FRAMEBUFFER) {
+    _gl.framebuffer = GL_STATE_UNKNOWN;
+    ++_gl_frame.issued;
+  }
+  else if (!_gl_state_set(&_gl.framebuffer, framebuffer)) return;
+
+  glBindFramebuffer(target, framebuffer);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void gl_active_texture(GLenum unit) {
+  GLuint index = unit - GL_TEXTURE0;
+  assert(index < GL_STATE_TEXTURE_UNITS);
+  if (_gl_state_set(&_gl.unit, index)) glActiveTexture(unit);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void gl_bind_texture(GLenum target, GLuint texture) {
+  int index = _gl_state_texture_target(target);
+
+  if (index < 0 || _gl.unit >= GL_STATE_TEXTURE_UNITS) ++_gl_frame.issued;
+  else if (!_gl_state_set(&_gl.textures[_gl.unit][index], texture)) return;
+
+  glBindTexture(target, texture);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void gl_enable(GLenum cap) {
+  int index = _gl_state_cap(cap);
+
+  if (index >= 0) {
+    if (_gl.caps[index] == 1) {
+      ++_gl_frame.skipped;
+      return;
+    }
+    _gl.caps[index] = 1;
+  }
+
+  ++_gl_frame.issued;
+  glEnable(cap);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void gl_disable(GLenum cap) {
+  int index = _gl_state_cap(cap);
+
+  if (index >= 0) {
+    if (_gl.caps[index] == 0) {
+      ++_gl_frame.skipped;
+      return;
+    }
+    _gl.caps[index] = 0;
+  }
+
+  ++_gl_frame.issued;
+  glDisable(cap);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Deletion
+////////////////////////////////////////////////////////////////////////////////
+
+void gl_delete_program(GLuint program) {
+  // a deleted program stays in use until replaced, but its name can be reused
+  if (program && _gl.program == program) _gl.program = GL_STATE_UNKNOWN;
+  glDeleteProgram(program);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void gl_delete_vertex_arrays(GLsizei n, const GLuint* arrays) {
+  GLuint vertex_array = _gl.vertex_array;
+  _gl_state_forget(&_gl.vertex_array, n, arrays);
+  if (vertex_array != _gl.vertex_array) _gl.element_buffer = GL_STATE_UNKNOWN;
+  glDeleteVertexArrays(n, arrays);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void gl_delete_buffers(GLsizei n, const GLuint* buffers) {
+  _gl_state_forget(&_gl.array_buffer, n, buffers);
+  _gl_state_forget(&_gl.element_buffer, n, buffers);
+  glDeleteBuffers(n, buffers);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void gl_delete_framebuffers(GLsizei n, const GLuint* framebuffers) {
+  _gl_state_forget(&_gl.framebuffer, n, framebuffers);
+  glDeleteFramebuffers(n, framebuffers);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void gl_delete_textures(GLsizei n, const GLuint* textures) {
+  for (index_t unit = 0; unit < GL_STATE_TEXTURE_UNITS; ++unit) {
+    for (index_t t = 0; t < GL_STATE_TEXTURE_TARGET_COUNT; ++t) {
+      _gl_state_forget(&_gl.textures[unit][t], n, textures);
+    }
+  }
+  glDeleteTextures(n, textures);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Cache control and counters
+////////////////////////////////////////////////////////////////////////////////
+
+void gl_state_invalidate(void) {
+  // every field is a GLuint except the capabilities, where -1 is all bits set
+  memset(&_gl, 0xFF, sizeof(_gl));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void gl_state_frame_end(void) {
+  _gl_last_frame = _gl_frame;
+  _gl_frame = (gl_state_stats_t){ 0 };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+gl_state_stats_t gl_state_stats(void) {
+  return _gl_last_frame;
+}
@@ -33,12 +33,108 @@
 #undef con_prefix
 #undef con_type
 
-#include <stdlib.h> // malloc, free
-#include <string.h> // memcpy
+#include "texture.h"
+#include "gl.h"
+
+#include "shader.h"
+
+#include <stdlib.h> // malloc, realloc, free
+#include <string.h> // memcpy, memcmp, memset
+#include <math.h>   // sqrtf, logf, powf, tanf
+
+////////////////////////////////////////////////////////////////////////////////
+// Per-light row layout of the light data texture (3 RGBA32F texels per light)
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma pack(1)
+typedef struct light_img_t {
+  vec3 pos;
+  float radius;
+
+  vec2 dir_oct;
+  float spot_outer;
+  float spot_inner;
+
+  vec3 color;
+  float range;
+} light_img_t;
+#pragma pack()
+
+#define LIGHT_BUFFER_MIN_CAPACITY 16
+
+// Radiance below which a light is considered to no longer contribute, used to
+//    derive a culling range for lights that don't specify one.
+#define LIGHT_CUTOFF_RADIANCE 0.01f
+
+// Persistent GPU copy of the scene lights, transformed to view space. The
+//    texture only gets reallocated when the light count outgrows its capacity,
+//    otherwise only the rows that changed since the last frame are uploaded.
+typedef struct light_buffer_t {
+  Texture       texture;
+  light_img_t*  rows;
+  index_t       capacity;
+  index_t       count;
+  mat4          view;
+  bool          dirty;
+} light_buffer_t;
+
+// Lights are binned into a froxel grid (screen tiles x exponential depth
+//    slices) so the lighting pass only has to walk the lights that can reach
+//    each cluster rather than every light in the scene.
+#define LIGHT_CLUSTER_X     16
+#define LIGHT_CLUSTER_Y     9
+#define LIGHT_CLUSTER_Z     24
+#define LIGHT_CLUSTER_COUNT (LIGHT_CLUSTER_X * LIGHT_CLUSTER_Y * LIGHT_CLUSTER_Z)
+#define LIGHT_INDEX_WIDTH   1024
+
+typedef struct light_cluster_bounds_t {
+  vec3          min;
+  vec3          max;
+} light_cluster_bounds_t;
+
+typedef struct light_clusters_t {
+  Texture       grid;       // RG32UI: (offset, count) per cluster
+  Texture       indices;    // R32UI: light indices, LIGHT_INDEX_WIDTH per row
+  uint*         grid_data;
+  uint*         index_data;
+  index_t       index_capacity;
+  uint*         pairs;      // (cluster, light) pairs gathered while binning
+  index_t       pair_capacity;
+  light_cluster_bounds_t* bounds;
+  mat4          projection;
+  float         depth_scale;
+  float         depth_bias;
+  bool          enabled;
+  bool          dirty;
+} light_clusters_t;
+
+// Contents of the FrameConstants uniform block, laid out to match std140:
+//
+//    layout(std140) uniform FrameConstants {
+//      highp mat4  in_pv_matrix;
+//      highp mat4  in_view_matrix;
+//      highp mat4  in_proj_matrix;
+//      highp mat4  in_proj_inverse;
+//      highp vec2  in_resolution;
+//      highp float in_time;
+//      highp float in_frame_time;
+//    };
+typedef struct frame_constants_t {
+  mat4  projview;
+  mat4  view;
+  mat4  projection;
+  mat4  proj_inverse;
+  vec2  resolution;
+  float time;
+  float frame_time;
+} frame_constants_t;
 
 typedef struct Graphics_Internal {
   span_renderer_t renderers;
   SlotMap_light lights;
+  light_buffer_t light_buffer;
+  light_clusters_t light_clusters;
+  uint frame_buffer;
 } Graphics_Internal;
 
 #define GRAPHICS_INTERNAL                                                     \
@@ -54,7 +150,11 @@ Graphics gfx_new(void) {
   assert(ret);
   *ret = (Graphics_Internal){
     .lights = smap_light_new(),
+    .light_buffer.dirty = true,
+    .light_clusters.enabled = true,
+    .light_clusters.dirty = true,
   };
+  shader_block_binding(S("FrameConstants"), GFX_FRAME_BINDING);
   return (Graphics)ret;
 }
 
@@ -66,9 +166,55 @@ void gfx_delete(Graphics* gfx) {
   if (!gfx || !*gfx) return;
   Graphics_Internal* graphics = (Graphics_Internal*)*gfx;
   smap_light_delete(&graphics->lights);
+  if (graphics->light_buffer.texture) {
+    tex_delete(&graphics->light_buffer.texture);
+  }
+  free(graphics->light_buffer.rows);
+  light_clusters_t* clusters = &graphics->light_clusters;
+  if (clusters->grid) tex_delete(&clusters->grid);
+  if (clusters->indices) tex_delete(&clusters->indices);
+  free(clusters->grid_data);
+  free(clusters->index_data);
+  free(clusters->pairs);
+  free(clusters->bounds);
+  if (graphics->frame_buffer) gl_delete_buffers(1, &graphics->frame_buffer);
+  free(graphics);
   *gfx = NULL;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Uploads the per-frame constants shared by all shaders
+////////////////////////////////////////////////////////////////////////////////
+
+void gfx_update_frame(Graphics _gfx, Game game) {
+  GRAPHICS_INTERNAL;
+
+  frame_constants_t frame = {
+    .projview = game->camera.projview,
+    .view = game->camera.view,
+    .projection = game->camera.projection,
+    .proj_inverse = m4inverse(game->camera.projection),
+    .resolution = v2f((float)game->resolution.w, (float)game->resolution.h),
+    .time = game->scene_time,
+    .frame_time = game->frame_time,
+  };
+
+  if (!gfx->frame_buffer) {
+    glGenBuffers(1, &gfx->frame_buffer);
+    gl_bind_buffer(GL_UNIFORM_BUFFER, gfx->frame_buffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(frame), &frame, GL_DYNAMIC_DRAW);
+
+    // the binding point keeps the buffer, so it only needs to be set once
+    glBindBufferBase(GL_UNIFORM_BUFFER, GFX_FRAME_BINDING, gfx->frame_buffer);
+  }
+  else {
+    gl_bind_buffer(GL_UNIFORM_BUFFER, gfx->frame_buffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(frame), &frame);
+  }
+
+  gl_bind_buffer(GL_UNIFORM_BUFFER, 0);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Iterates the list of renderers in order and executes their render functions
 ////////////////////////////////////////////////////////////////////////////////
@@ -80,34 +226,41 @@ static void _renderer_update_instances(renderer_t* renderer) {
       continue;
     }
 
-    if (group->update_full) {
-      assert(group->instances->size <= SK_INDEX_MAX);
-      group->update_range_low = 0;
-      group->update_range_high = group->instances->size - 1;
-      group->update_full = false;
-    }
-
-    if (group->update_range_low >= 0) {
-      if (group->update_range_high >= group->instances->size) {
-        // possible when items are removed from the list
-        group->update_range_high = group->instances->size - 1;
-      }
+    assert(group->instances->size <= SK_INDEX_MAX);
 
-      if (group->update_range_low <= group->update_range_high) {
-        renderer->instance_update(group);
-      }
+    // drop or clip ranges past the end (possible when items are removed)
+    index_t size = group->instances->size;
+    index_t count = 0;
+    for (index_t i = 0; i < group->update_range_count; ++i) {
+      render_range_t range = group->update_ranges[i];
+      if (range.low >= size) continue;
+      range.high = MIN(range.high, size - 1);
+      group->update_ranges[count++] = range;
+    }
+    group->update_range_count = count;
 
-      group->update_range_low = -1;
-      group->update_range_high = -1;
+    if (group->update_full || group->update_range_count > 0) {
+      renderer->instance_update(group);
     }
+
+    group->update_range_count = 0;
+    group->update_full = false;
   }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
+static bool _gfx_update_light_buffer(Graphics_Internal* gfx, Game game);
+static void _gfx_update_light_clusters(Graphics_Internal* gfx, Game game);
+
 void gfx_render(Graphics _gfx, Game game) {
   GRAPHICS_INTERNAL;
 
+  if (_gfx_update_light_buffer(gfx, game)) {
+    gfx->light_clusters.dirty = true;
+  }
+  _gfx_update_light_clusters(gfx, game);
+
   renderer_t** span_foreach(renderer_ptr, gfx->renderers) {
     renderer_t* renderer = *renderer_ptr;
 
@@ -160,6 +313,7 @@ void gfx_clear_instances(Graphics gfx) {
 
 slotkey_t light_add(light_t light) {
   LIGHT_INTERNAL;
+  graphics->light_buffer.dirty = true;
   return smap_light_insert(graphics->lights, &light);
 }
 
@@ -172,8 +326,11 @@ index_t light_count(void) {
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// Handing out a mutable reference is treated as a modification, so the light
+//    buffer gets re-checked for changes on the next frame.
 light_t* light_ref(slotkey_t light_id) {
   LIGHT_INTERNAL;
+  graphics->light_buffer.dirty = true;
   return smap_light_ref(graphics->lights, light_id);
 }
 
@@ -181,6 +338,7 @@ light_t* light_ref(slotkey_t light_id) {
 
 void light_remove(slotkey_t light_id) {
   LIGHT_INTERNAL;
+  graphics->light_buffer.dirty = true;
   smap_light_remove(graphics->lights, light_id);
 }
 
@@ -188,6 +346,7 @@ void light_remove(slotkey_t light_id) {
 
 void light_clear(void) {
   LIGHT_INTERNAL;
+  graphics->light_buffer.dirty = true;
   smap_light_clear(graphics->lights);
 }
 
@@ -195,19 +354,34 @@ void light_clear(void) {
 // Build a data texture representing light data for the scene
 ////////////////////////////////////////////////////////////////////////////////
 
-#pragma pack(1)
-typedef struct light_img_t {
-  vec3 pos;
-  float radius;
+static light_img_t _light_to_view_row(const light_t* light, mat4 view) {
+  vec2 dir = v2zero;
+  if (!v3eq(light->dir, v3zero)) {
+    dir = v3oct(mv4mul(view, v34(light->dir)).xyz);
+  }
 
-  vec2 dir_oct;
-  float spot_outer;
-  float spot_inner;
+  vec3 color = v3scale(light->color, light->intensity);
 
-  vec3 color;
-  float _unused;
-} light_img_t;
-#pragma pack()
+  // Without an explicit range, find where the light's brightest channel falls
+  //    below the cutoff (spherical emitters fall off as ~PI*r^2/d^2).
+  float range = light->range;
+  if (range <= 0.0f) {
+    float power = MAX(MAX(color.x, color.y), color.z);
+    float area = MAX(1.0f, 3.14159265f * light->radius * light->radius);
+    range = sqrtf(MAX(power, 0.0f) * area / LIGHT_CUTOFF_RADIANCE);
+    range += light->radius;
+  }
+
+  return (light_img_t) {
+    .pos = mv4mul(view, p34(light->pos)).xyz,
+    .radius = light->radius,
+    .dir_oct = dir,
+    .spot_outer = light->spot_outer,
+    .spot_inner = light->spot_inner,
+    .color = color,
+    .range = range,
+  };
+}
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -218,20 +392,7 @@ Texture tex_from_lights(void) {
   assert(buffer);
 
   const light_t* smap_foreach_index(light, i, graphics->lights) {
-    vec2 dir = v2zero;
-    if (!v3eq(light->dir, v3zero)) {
-      dir = v3oct(mv4mul(game->camera.view, v34(light->dir)).xyz);
-    }
-
-    buffer[i] = (light_img_t) {
-      .pos = mv4mul(game->camera.view, p34(light->pos)).xyz,
-      .radius = light->radius,
-      .dir_oct = dir,
-      .spot_outer = light->spot_outer,
-      .spot_inner = light->spot_inner,
-      .color = v3scale(light->color, light->intensity),
-      ._unused = 0.0f,
-    };
+    buffer[i] = _light_to_view_row(light, game->camera.view);
   }
 
   vec2i tex_size = v2i(3, (int)graphics->lights->size);
@@ -240,6 +401,451 @@ Texture tex_from_lights(void) {
   return texture;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Keeps the persistent light texture in sync with the scene lights
+////////////////////////////////////////////////////////////////////////////////
+
+static void _light_buffer_reserve(light_buffer_t* buffer, index_t count) {
+  if (count <= buffer->capacity && buffer->texture) return;
+
+  index_t capacity = MAX(buffer->capacity, LIGHT_BUFFER_MIN_CAPACITY);
+  while (capacity < count) capacity *= 2;
+
+  light_img_t* rows = realloc(buffer->rows, capacity * sizeof(light_img_t));
+  assert(rows);
+  buffer->rows = rows;
+  buffer->capacity = capacity;
+
+  if (buffer->texture) {
+    tex_delete(&buffer->texture);
+  }
+
+  buffer->texture = tex_generate(TF_RGBA_32, v2i(3, (int)capacity));
+  tex_set_name(buffer->texture, S("tex_lights"));
+
+  // Everything needs to be re-sent to the new texture
+  buffer->count = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static bool _gfx_update_light_buffer(Graphics_Internal* gfx, Game game) {
+  light_buffer_t* buffer = &gfx->light_buffer;
+  mat4 view = game->camera.view;
+
+  bool view_changed = memcmp(&buffer->view, &view, sizeof(mat4)) != 0;
+  if (!buffer->dirty && !view_changed && buffer->texture) return false;
+
+  index_t count = gfx->lights->size;
+  index_t prev_count = buffer->count;
+  _light_buffer_reserve(buffer, count);
+  bool full = buffer->count == 0;
+
+  index_t low = -1;
+  index_t high = -1;
+
+  // Rows are compared against what was last uploaded so lights that weren't
+  //    touched (and didn't move relative to the camera) don't get re-sent.
+  const light_t* smap_foreach_index(light, i, gfx->lights) {
+    light_img_t row = _light_to_view_row(light, view);
+
+    if (!full && i < prev_count) {
+      if (memcmp(&buffer->rows[i], &row, sizeof(light_img_t)) == 0) continue;
+    }
+
+    buffer->rows[i] = row;
+    if (low < 0) low = i;
+    high = i;
+  }
+
+  if (low >= 0) {
+    tex_set_data_region(buffer->texture
+    , v2i(0, (int)low)
+    , v2i(3, (int)(high - low + 1))
+    , &buffer->rows[low]
+    );
+  }
+
+  buffer->count = count;
+  buffer->view = view;
+  buffer->dirty = false;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Binds the light buffer for a deferred lighting pass
+////////////////////////////////////////////////////////////////////////////////
+
+void light_buffer_bind(uint slot, int sampler, int count_uniform) {
+  LIGHT_INTERNAL;
+  light_buffer_t* buffer = &graphics->light_buffer;
+
+  if (!buffer->texture) {
+    _light_buffer_reserve(buffer, LIGHT_BUFFER_MIN_CAPACITY);
+  }
+
+  tex_apply(buffer->texture, slot, sampler);
+  glUniform1i(count_uniform, (GLint)buffer->count);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Clustered light culling
+////////////////////////////////////////////////////////////////////////////////
+
+static void _camera_depth_range(const camera_t* camera, float* near, float* far) {
+  if (camera->type == CAMERA_ORTHOGRAPHIC) {
+    *near = camera->orthographic.near;
+    *far = camera->orthographic.far;
+  }
+  else {
+    *near = camera->perspective.near;
+    *far = camera->perspective.far;
+  }
+  *near = MAX(*near, 0.0001f);
+  *far = MAX(*far, *near * 1.001f);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static inline vec3 _v3min(vec3 a, vec3 b) {
+  return v3f(MIN(a.x, b.x), MIN(a.y, b.y), MIN(a.z, b.z));
+}
+
+static inline vec3 _v3max(vec3 a, vec3 b) {
+  return v3f(MAX(a.x, b.x), MAX(a.y, b.y), MAX(a.z, b.z));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// View-space point at a given normalized device xy and (positive) view depth
+static vec3 _cluster_view_point(const camera_t* camera, vec2 ndc, float depth) {
+  if (camera->type == CAMERA_ORTHOGRAPHIC) {
+    const camera_orthographic_params_t* o = &camera->orthographic;
+    float x = o->left + (ndc.x * 0.5f + 0.5f) * (o->right - o->left);
+    float y = o->bottom + (ndc.y * 0.5f + 0.5f) * (o->top - o->bottom);
+    return v3f(x, y, -depth);
+  }
+
+  float half_height = tanf(camera->perspective.fov / 2.0f);
+  float half_width = half_height * camera->perspective.aspect;
+  return v3f(ndc.x * depth * half_width, ndc.y * depth * half_height, -depth);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void _light_clusters_build_bounds(
+  light_clusters_t* clusters, const camera_t* camera
+) {
+  float near, far;
+  _camera_depth_range(camera, &near, &far);
+
+  float log_ratio = logf(far / near);
+  clusters->depth_scale = (float)LIGHT_CLUSTER_Z / log_ratio;
+  clusters->depth_bias = -(float)LIGHT_CLUSTER_Z * logf(near) / log_ratio;
+
+  for (int z = 0; z < LIGHT_CLUSTER_Z; ++z) {
+    float d0 = near * powf(far / near, (float)z / LIGHT_CLUSTER_Z);
+    float d1 = near * powf(far / near, (float)(z + 1) / LIGHT_CLUSTER_Z);
+
+    for (int y = 0; y < LIGHT_CLUSTER_Y; ++y) {
+      float y0 = (float)y / LIGHT_CLUSTER_Y * 2.0f - 1.0f;
+      float y1 = (float)(y + 1) / LIGHT_CLUSTER_Y * 2.0f - 1.0f;
+
+      for (int x = 0; x < LIGHT_CLUSTER_X; ++x) {
+        float x0 = (float)x / LIGHT_CLUSTER_X * 2.0f - 1.0f;
+        float x1 = (float)(x + 1) / LIGHT_CLUSTER_X * 2.0f - 1.0f;
+
+        vec3 corners[8] = {
+          _cluster_view_point(camera, v2f(x0, y0), d0),
+          _cluster_view_point(camera, v2f(x1, y0), d0),
+          _cluster_view_point(camera, v2f(x0, y1), d0),
+          _cluster_view_point(camera, v2f(x1, y1), d0),
+          _cluster_view_point(camera, v2f(x0, y0), d1),
+          _cluster_view_point(camera, v2f(x1, y0), d1),
+          _cluster_view_point(camera, v2f(x0, y1), d1),
+          _cluster_view_point(camera, v2f(x1, y1), d1),
+        };
+
+        light_cluster_bounds_t bounds = { corners[0], corners[0] };
+        for (int i = 1; i < 8; ++i) {
+          bounds.min = _v3min(bounds.min, corners[i]);
+          bounds.max = _v3max(bounds.max, corners[i]);
+        }
+
+        index_t c = (z * LIGHT_CLUSTER_Y + y) * LIGHT_CLUSTER_X + x;
+        clusters->bounds[c] = bounds;
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void _light_clusters_init(light_clusters_t* clusters) {
+  if (clusters->grid) return;
+
+  clusters->grid_data = malloc(LIGHT_CLUSTER_COUNT * 2 * sizeof(uint));
+  clusters->bounds = malloc(LIGHT_CLUSTER_COUNT * sizeof(*clusters->bounds));
+  assert(clusters->grid_data);
+  assert(clusters->bounds);
+  memset(clusters->grid_data, 0, LIGHT_CLUSTER_COUNT * 2 * sizeof(uint));
+
+  vec2i grid_size = v2i(LIGHT_CLUSTER_X, LIGHT_CLUSTER_Y * LIGHT_CLUSTER_Z);
+  clusters->grid = tex_generate(TF_RG_32_UINT, grid_size);
+  tex_set_name(clusters->grid, S("tex_light_grid"));
+
+  clusters->index_capacity = LIGHT_INDEX_WIDTH;
+  clusters->index_data = malloc(clusters->index_capacity * sizeof(uint));
+  assert(clusters->index_data);
+  clusters->indices = tex_generate(TF_R_32_UINT, v2i(LIGHT_INDEX_WIDTH, 1));
+  tex_set_name(clusters->indices, S("tex_light_indices"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void _light_clusters_push_pair(
+  light_clusters_t* clusters, index_t* count, index_t cluster, index_t light
+) {
+  if (*count >= clusters->pair_capacity) {
+    index_t capacity = MAX(clusters->pair_capacity * 2, LIGHT_INDEX_WIDTH);
+    uint* pairs = realloc(clusters->pairs, capacity * 2 * sizeof(uint));
+    assert(pairs);
+    clusters->pairs = pairs;
+    clusters->pair_capacity = capacity;
+  }
+
+  clusters->pairs[*count * 2 + 0] = (uint)cluster;
+  clusters->pairs[*count * 2 + 1] = (uint)light;
+  ++*count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static inline bool _sphere_hits_aabb(
+  vec3 center, float radius, const light_cluster_bounds_t* box
+) {
+  vec3 closest = _v3max(box->min, _v3min(center, box->max));
+  vec3 diff = v3sub(center, closest);
+  return v3dot(diff, diff) <= radius * radius;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static inline int _cluster_tile(float ndc, int tiles) {
+  int tile = (int)floorf((ndc * 0.5f + 0.5f) * (float)tiles);
+  return tile < 0 ? 0 : (tile >= tiles ? tiles - 1 : tile);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Conservative tile range covered by a view-space box spanning depths d0..d1
+static void _cluster_tile_range(
+  const camera_t* camera, vec3 center, float radius, float d0, float d1,
+  int out_min[2], int out_max[2]
+) {
+  vec2 lo = v2f(1.0f, 1.0f);
+  vec2 hi = v2f(-1.0f, -1.0f);
+  float xs[2] = { center.x - radius, center.x + radius };
+  float ys[2] = { center.y - radius, center.y + radius };
+
+  if (camera->type == CAMERA_ORTHOGRAPHIC) {
+    const camera_orthographic_params_t* o = &camera->orthographic;
+    for (int i = 0; i < 2; ++i) {
+      float nx = (xs[i] - o->left) / (o->right - o->left) * 2.0f - 1.0f;
+      float ny = (ys[i] - o->bottom) / (o->top - o->bottom) * 2.0f - 1.0f;
+      lo = v2f(MIN(lo.x, nx), MIN(lo.y, ny));
+      hi = v2f(MAX(hi.x, nx), MAX(hi.y, ny));
+    }
+  }
+  else {
+    float half_height = tanf(camera->perspective.fov / 2.0f);
+    float half_width = half_height * camera->perspective.aspect;
+    float ds[2] = { d0, d1 };
+    for (int d = 0; d < 2; ++d) {
+      for (int i = 0; i < 2; ++i) {
+        float nx = xs[i] / (ds[d] * half_width);
+        float ny = ys[i] / (ds[d] * half_height);
+        lo = v2f(MIN(lo.x, nx), MIN(lo.y, ny));
+        hi = v2f(MAX(hi.x, nx), MAX(hi.y, ny));
+      }
+    }
+  }
+
+  out_min[0] = _cluster_tile(lo.x, LIGHT_CLUSTER_X);
+  out_min[1] = _cluster_tile(lo.y, LIGHT_CLUSTER_Y);
+  out_max[0] = _cluster_tile(hi.x, LIGHT_CLUSTER_X);
+  out_max[1] = _cluster_tile(hi.y, LIGHT_CLUSTER_Y);
+
+  if (hi.x < -1.0f || lo.x > 1.0f || hi.y < -1.0f || lo.y > 1.0f) {
+    out_max[0] = out_min[0] - 1; // fully off-screen, empty range
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void _gfx_update_light_clusters(Graphics_Internal* gfx, Game game) {
+  light_clusters_t* clusters = &gfx->light_clusters;
+  const light_buffer_t* buffer = &gfx->light_buffer;
+  const camera_t* camera = &game->camera;
+
+  if (!clusters->enabled) return;
+
+  _light_clusters_init(clusters);
+
+  mat4 projection = camera->projection;
+  if (memcmp(&clusters->projection, &projection, sizeof(mat4)) != 0) {
+    _light_clusters_build_bounds(clusters, camera);
+    clusters->projection = projection;
+    clusters->dirty = true;
+  }
+
+  if (!clusters->dirty) return;
+  clusters->dirty = false;
+
+  float near, far;
+  _camera_depth_range(camera, &near, &far);
+
+  // Gather (cluster, light) pairs for every cluster each light's sphere hits
+  index_t pair_count = 0;
+  for (index_t i = 0; i < buffer->count; ++i) {
+    const light_img_t* row = &buffer->rows[i];
+    vec3 center = row->pos;
+    float radius = row->range;
+
+    float d0 = -center.z - radius;
+    float d1 = -center.z + radius;
+    if (d1 < near || d0 > far) continue;
+    d0 = MAX(d0, near);
+    d1 = MIN(d1, far);
+
+    int z0 = (int)floorf(logf(d0) * clusters->depth_scale + clusters->depth_bias);
+    int z1 = (int)floorf(logf(d1) * clusters->depth_scale + clusters->depth_bias);
+    z0 = MAX(z0, 0);
+    z1 = MIN(z1, LIGHT_CLUSTER_Z - 1);
+
+    int tile_min[2] = { 0, 0 };
+    int tile_max[2] = { LIGHT_CLUSTER_X - 1, LIGHT_CLUSTER_Y - 1 };
+
+    // Lights overlapping the near plane can't be projected, so they get
+    //    tested against every tile instead.
+    if (-center.z - radius > near) {
+      _cluster_tile_range(camera, center, radius, d0, d1, tile_min, tile_max);
+    }
+
+    for (int z = z0; z <= z1; ++z) {
+      for (int y = tile_min[1]; y <= tile_max[1]; ++y) {
+        for (int x = tile_min[0]; x <= tile_max[0]; ++x) {
+          index_t c = (z * LIGHT_CLUSTER_Y + y) * LIGHT_CLUSTER_X + x;
+          if (!_sphere_hits_aabb(center, radius, &clusters->bounds[c])) {
+            continue;
+          }
+          _light_clusters_push_pair(clusters, &pair_count, c, i);
+        }
+      }
+    }
+  }
+
+  // Counting sort the pairs into per-cluster ranges of the index list
+  uint* grid = clusters->grid_data;
+  memset(grid, 0, LIGHT_CLUSTER_COUNT * 2 * sizeof(uint));
+
+  for (index_t p = 0; p < pair_count; ++p) {
+    ++grid[clusters->pairs[p * 2] * 2 + 1];
+  }
+
+  uint offset = 0;
+  for (index_t c = 0; c < LIGHT_CLUSTER_COUNT; ++c) {
+    grid[c * 2] = offset;
+    offset += grid[c * 2 + 1];
+    grid[c * 2 + 1] = 0;
+  }
+
+  if (pair_count > clusters->index_capacity) {
+    index_t capacity = clusters->index_capacity;
+    while (capacity < pair_count) capacity *= 2;
+
+    uint* indices = realloc(clusters->index_data, capacity * sizeof(uint));
+    assert(indices);
+    clusters->index_data = indices;
+    clusters->index_capacity = capacity;
+
+    tex_delete(&clusters->indices);
+    vec2i size = v2i(LIGHT_INDEX_WIDTH, (int)(capacity / LIGHT_INDEX_WIDTH));
+    clusters->indices = tex_generate(TF_R_32_UINT, size);
+    tex_set_name(clusters->indices, S("tex_light_indices"));
+  }
+
+  for (index_t p = 0; p < pair_count; ++p) {
+    uint* cell = &grid[clusters->pairs[p * 2] * 2];
+    clusters->index_data[cell[0] + cell[1]++] = clusters->pairs[p * 2 + 1];
+  }
+
+  tex_set_data_region(clusters->grid
+  , v2i(0, 0)
+  , clusters->grid->size
+  , grid
+  );
+
+  if (pair_count > 0) {
+    int rows = (int)((pair_count + LIGHT_INDEX_WIDTH - 1) / LIGHT_INDEX_WIDTH);
+
+    // pad the last partial row so whole rows can be uploaded
+    index_t padded = (index_t)rows * LIGHT_INDEX_WIDTH;
+    for (index_t p = pair_count; p < padded; ++p) {
+      clusters->index_data[p] = 0;
+    }
+
+    tex_set_data_region(clusters->indices
+    , v2i(0, 0)
+    , v2i(LIGHT_INDEX_WIDTH, rows)
+    , clusters->index_data
+    );
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Binds the light cluster grid and index list for a deferred lighting pass
+////////////////////////////////////////////////////////////////////////////////
+
+void light_clusters_bind(Shader shader, uint slot) {
+  LIGHT_INTERNAL;
+  light_clusters_t* clusters = &graphics->light_clusters;
+
+  _light_clusters_init(clusters);
+
+  int grid_sampler = shader_uniform_id(shader, SV_SAMP_LIGHT_GRID);
+  int index_sampler = shader_uniform_id(shader, SV_SAMP_LIGHT_INDEX);
+  int loc_dims = shader_uniform_id(shader, SV_IN_CLUSTER_DIMS);
+  int loc_depth = shader_uniform_id(shader, SV_IN_CLUSTER_DEPTH);
+  int loc_enabled = shader_uniform_id(shader, SV_IN_CLUSTER_ENABLED);
+
+  tex_apply(clusters->grid, slot, grid_sampler);
+  tex_apply(clusters->indices, slot + 1, index_sampler);
+
+  vec3 dims = v3f(LIGHT_CLUSTER_X, LIGHT_CLUSTER_Y, LIGHT_CLUSTER_Z);
+  vec2 depth = v2f(clusters->depth_scale, clusters->depth_bias);
+  glUniform3fv(loc_dims, 1, dims.f);
+  glUniform2fv(loc_depth, 1, depth.f);
+  glUniform1i(loc_enabled, clusters->enabled ? 1 : 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Enables or disables clustered light culling (for comparison/debugging)
+////////////////////////////////////////////////////////////////////////////////
+
+void light_set_clustering(bool enabled) {
+  LIGHT_INTERNAL;
+  graphics->light_clusters.enabled = enabled;
+  graphics->light_clusters.dirty = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool light_get_clustering(void) {
+  LIGHT_INTERNAL;
+  return graphics->light_clusters.enabled;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 #ifdef __WASM__
@@ -26,18 +26,59 @@
 #include "image.h"
 #include "str.h"
 
+typedef enum img_load_state_t {
+  IMG_LOAD_NONE,
+  IMG_LOAD_QUEUED,
+  IMG_LOAD_DECODING,
+  IMG_LOAD_DONE,
+} img_load_state_t;
+
 typedef struct Image_Internal {
   struct _opaque_Image_t pub;
 
   String filename_internal;
+
+  // decode queue bookkeeping (native only), guarded by the decoder's lock
+  img_load_state_t  load_state;
+  img_priority_t    priority;
+  uint64_t          sequence;
+  index_t           queue_index;
+  bool              cancelled;
 } Image_Internal;
 
 #ifndef __WASM__
 # define STB_IMAGE_IMPLEMENTATION
 # include "stb_image.h"
 # include "SDL3/SDL.h"
-
-static SDL_AtomicInt _img_loading_count = { 0 };
+# include "file.h"
+
+// Upper bound on decode workers regardless of core count, decoding is mostly
+//    memory and disk bound past a few threads
+#define IMG_DECODE_MAX_THREADS 4
+
+typedef struct img_decoder_t {
+  SDL_Mutex*        lock;
+  SDL_Semaphore*    wake;
+  SDL_Thread*       threads[IMG_DECODE_MAX_THREADS];
+  index_t           thread_count;
+  bool              quit;
+
+  // pending decodes as a binary max-heap on (priority, -sequence)
+  Image_Internal**  queue;
+  index_t           queue_size;
+  index_t           queue_capacity;
+  uint64_t          next_sequence;
+
+  // decodes finished by workers, waiting for img_loading_manager
+  Image_Internal**  done;
+  index_t           done_size;
+  index_t           done_capacity;
+} img_decoder_t;
+
+static img_decoder_t _img_decoder = { 0 };
+
+// only touched on the main thread
+static index_t _img_loading_count = 0;
 
 #else
 # include <string.h>
@@ -203,40 +244,315 @@ Image img_new_str(String filename) {
   return (Image)ret;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+
+// The browser decodes images itself and reports back through
+//    img_open_async_done, so there's no queue to manage here.
+void img_loading_manager(void) { }
+
+void img_loading_shutdown(void) { }
+
+void img_set_priority(Image img, img_priority_t priority) {
+  UNUSED(img);
+  UNUSED(priority);
+}
+
 #else
 
 ////////////////////////////////////////////////////////////////////////////////
-// Asynchronously load an image from a file (Native/SDL)
+// Decode queue (Native/SDL)
 ////////////////////////////////////////////////////////////////////////////////
 
-static int SDLCALL _img_load_async(void* data) {
-  assert(data);
-  Image_Internal* img = data;
+static bool _img_queue_before(Image_Internal* a, Image_Internal* b) {
+  if (a->priority != b->priority) return a->priority > b->priority;
+  return a->sequence < b->sequence;
+}
+
+static void _img_queue_set(index_t i, Image_Internal* img) {
+  _img_decoder.queue[i] = img;
+  img->queue_index = i;
+}
 
-  img->pub.handle = stbi_load(img->pub.filename.begin, 
-    &img->pub.width, &img->pub.height, &img->pub.channels, 0
-  );
+static void _img_queue_sift_up(index_t i) {
+  Image_Internal* img = _img_decoder.queue[i];
 
-  if (img->pub.handle) {
-    img->pub.status = S_READY;
-    str_log("[Image.load] Loaded: ({} x {}) {}"
-    , img->pub.width, img->pub.height, img->pub.filename
-    );
+  while (i > 0) {
+    index_t parent = (i - 1) / 2;
+    if (!_img_queue_before(img, _img_decoder.queue[parent])) break;
+    _img_queue_set(i, _img_decoder.queue[parent]);
+    i = parent;
   }
-  else {
-    str_log("[Image.load] Failed to load ({}): {}"
-    , img->pub.handle, img->pub.filename
-    );
-    *img = *_img_load_default_error();
+
+  _img_queue_set(i, img);
+}
+
+static void _img_queue_sift_down(index_t i) {
+  Image_Internal* img = _img_decoder.queue[i];
+  index_t size = _img_decoder.queue_size;
+
+  while (true) {
+    index_t child = i * 2 + 1;
+    if (child >= size) break;
+
+    Image_Internal** queue = _img_decoder.queue;
+    if (child + 1 < size && _img_queue_before(queue[child + 1], queue[child])) {
+      ++child;
+    }
+    if (!_img_queue_before(queue[child], img)) break;
+
+    _img_queue_set(i, queue[child]);
+    i = child;
+  }
+
+  _img_queue_set(i, img);
+}
+
+static void _img_queue_push(Image_Internal* img) {
+  img_decoder_t* d = &_img_decoder;
+
+  if (d->queue_size >= d->queue_capacity) {
+    d->queue_capacity = MAX(d->queue_capacity * 2, 16);
+    d->queue = realloc(d->queue, sizeof(*d->queue) * d->queue_capacity);
+    assert(d->queue);
+  }
+
+  img->sequence = d->next_sequence++;
+  img->load_state = IMG_LOAD_QUEUED;
+  _img_queue_set(d->queue_size++, img);
+  _img_queue_sift_up(img->queue_index);
+}
+
+static void _img_queue_remove(Image_Internal* img) {
+  img_decoder_t* d = &_img_decoder;
+  index_t i = img->queue_index;
+  assert(i >= 0 && i < d->queue_size && d->queue[i] == img);
+
+  Image_Internal* last = d->queue[--d->queue_size];
+  img->queue_index = -1;
+  if (last == img) return;
+
+  _img_queue_set(i, last);
+  _img_queue_sift_up(i);
+  _img_queue_sift_down(last->queue_index);
+}
+
+static void _img_done_push(Image_Internal* img) {
+  img_decoder_t* d = &_img_decoder;
+
+  if (d->done_size >= d->done_capacity) {
+    d->done_capacity = MAX(d->done_capacity * 2, 16);
+    d->done = realloc(d->done, sizeof(*d->done) * d->done_capacity);
+    assert(d->done);
   }
 
-  SDL_AddAtomicInt(&_img_loading_count, -1);
+  img->load_state = IMG_LOAD_DONE;
+  d->done[d->done_size++] = img;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Decode workers, results are only published by img_loading_manager
+////////////////////////////////////////////////////////////////////////////////
+
+static int SDLCALL _img_decode_worker(void* data) {
+  UNUSED(data);
+  img_decoder_t* d = &_img_decoder;
+
+  while (true) {
+    SDL_WaitSemaphore(d->wake);
+    SDL_LockMutex(d->lock);
+
+    if (d->quit) {
+      SDL_UnlockMutex(d->lock);
+      break;
+    }
+
+    if (d->queue_size <= 0) {
+      SDL_UnlockMutex(d->lock);
+      continue;
+    }
+
+    Image_Internal* img = d->queue[0];
+    _img_queue_remove(img);
+    img->load_state = IMG_LOAD_DECODING;
+    SDL_UnlockMutex(d->lock);
+
+    // Images in a mounted pack decode straight from the mapping
+    int width, height, channels;
+    void* pixels;
+    slice_t packed;
+
+    file_packs_lock();
+    if (file_pack_lookup(img->filename_internal->slice, &packed)) {
+      pixels = stbi_load_from_memory((const stbi_uc*)packed.begin,
+        (int)packed.size, &width, &height, &channels, 0
+      );
+      file_packs_unlock();
+    }
+    else {
+      file_packs_unlock();
+      pixels = stbi_load(
+        img->filename_internal->begin, &width, &height, &channels, 0
+      );
+    }
+
+    SDL_LockMutex(d->lock);
+    img->pub.handle = pixels;
+    img->pub.width = width;
+    img->pub.height = height;
+    img->pub.channels = channels;
+    _img_done_push(img);
+    SDL_UnlockMutex(d->lock);
+  }
 
   return 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
+static void _img_decoder_start(void) {
+  img_decoder_t* d = &_img_decoder;
+  if (d->lock) return;
+
+  d->lock = SDL_CreateMutex();
+  d->wake = SDL_CreateSemaphore(0);
+  assert(d->lock);
+  assert(d->wake);
+
+  index_t workers = SDL_GetNumLogicalCPUCores() - 1;
+  workers = MAX(1, MIN(workers, IMG_DECODE_MAX_THREADS));
+
+  for (index_t i = 0; i < workers; ++i) {
+    SDL_Thread* thread = SDL_CreateThread(_img_decode_worker, "img_decode", d);
+    if (!thread) {
+      str_log("[Image.decoder] Failed to create decode thread: {}", i);
+      break;
+    }
+    d->threads[d->thread_count++] = thread;
+  }
+
+  assert(d->thread_count > 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void img_loading_shutdown(void) {
+  img_decoder_t* d = &_img_decoder;
+  if (!d->lock) return;
+
+  SDL_LockMutex(d->lock);
+  d->quit = true;
+  SDL_UnlockMutex(d->lock);
+
+  for (index_t i = 0; i < d->thread_count; ++i) {
+    SDL_SignalSemaphore(d->wake);
+  }
+
+  for (index_t i = 0; i < d->thread_count; ++i) {
+    SDL_WaitThread(d->threads[i], NULL);
+  }
+
+  SDL_DestroySemaphore(d->wake);
+  SDL_DestroyMutex(d->lock);
+  free(d->queue);
+  free(d->done);
+  *d = (img_decoder_t) { 0 };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void _img_free_request(Image_Internal* img) {
+  stbi_image_free((void*)img->pub.handle);
+  str_delete(&img->filename_internal);
+  free(img);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Publishes finished decodes on the main thread
+////////////////////////////////////////////////////////////////////////////////
+
+void img_loading_manager(void) {
+  img_decoder_t* d = &_img_decoder;
+  if (!d->lock) return;
+
+  SDL_LockMutex(d->lock);
+
+  for (index_t i = 0; i < d->done_size; ++i) {
+    Image_Internal* img = d->done[i];
+    img->load_state = IMG_LOAD_NONE;
+    --_img_loading_count;
+
+    if (img->cancelled) {
+      _img_free_request(img);
+    }
+    else if (img->pub.handle) {
+      img->pub.status = S_READY;
+      str_log("[Image.load] Loaded: ({} x {}) {}"
+      , img->pub.width, img->pub.height, img->pub.filename
+      );
+    }
+    else {
+      str_log("[Image.load] Failed to load: {}", img->pub.filename);
+      *img = *_img_load_default_error();
+    }
+  }
+
+  d->done_size = 0;
+  SDL_UnlockMutex(d->lock);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void img_set_priority(Image _img, img_priority_t priority) {
+  assert(_img);
+  Image_Internal* img = (Image_Internal*)_img;
+  img_decoder_t* d = &_img_decoder;
+  if (!d->lock || img->pub.status != S_LOADING) return;
+
+  SDL_LockMutex(d->lock);
+  img_priority_t previous = img->priority;
+  img->priority = priority;
+
+  if (img->load_state == IMG_LOAD_QUEUED && priority != previous) {
+    if (priority > previous) _img_queue_sift_up(img->queue_index);
+    else _img_queue_sift_down(img->queue_index);
+  }
+
+  SDL_UnlockMutex(d->lock);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Returns true if the image was still in the decoder and will be released by
+//    it (or already has been), in which case the caller must not free it.
+static bool _img_cancel(Image_Internal* img) {
+  img_decoder_t* d = &_img_decoder;
+  if (!d->lock || img->pub.status != S_LOADING) return false;
+
+  bool deferred = false;
+  SDL_LockMutex(d->lock);
+
+  switch (img->load_state) {
+    case IMG_LOAD_QUEUED:
+      _img_queue_remove(img);
+      img->load_state = IMG_LOAD_NONE;
+      --_img_loading_count;
+      break;
+
+    case IMG_LOAD_DECODING:
+    case IMG_LOAD_DONE:
+      img->cancelled = true;
+      deferred = true;
+      break;
+
+    default: break;
+  }
+
+  SDL_UnlockMutex(d->lock);
+  return deferred;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 Image img_new_str(String filename) {
   assert(!str_is_null_or_empty(filename));
   Image_Internal* ret = malloc(sizeof(*ret));
@@ -250,19 +566,19 @@ Image img_new_str(String filename) {
       .blend = true,
     },
     .filename_internal = filename,
+    .priority = IMG_PRIORITY_NORMAL,
+    .queue_index = -1,
   };
 
   str_log("[Image.new] Loading: {}", filename);
-  SDL_Thread* thread = SDL_CreateThread(_img_load_async, filename->begin, ret);
+  _img_decoder_start();
 
-  if (thread) {
-    SDL_AddAtomicInt(&_img_loading_count, 1);
-    SDL_DetachThread(thread);
-  }
-  else {
-    str_log("[Image.new] Failed to create loading thraed: {}", filename);
-    ret->pub.status = S_FAILED;
-  }
+  SDL_LockMutex(_img_decoder.lock);
+  _img_queue_push(ret);
+  SDL_UnlockMutex(_img_decoder.lock);
+
+  ++_img_loading_count;
+  SDL_SignalSemaphore(_img_decoder.wake);
 
   return (Image)ret;
 }
@@ -399,24 +715,24 @@ Image img_pack_channels(Image r, Image g, Image b) {
   Image src[3] = { r, g, b };
 
   for (int y = 0; y < size.y; ++y) {
-    for (int x = 0; x < size.y; ++x) {
+    for (int x = 0; x < size.x; ++x) {
       color3b pixel = b4white.rgb;
 
       for (int i = 0; i < 3; ++i) {
         if (src[i] && x < src[i]->width && y < src[i]->height) {
           byte* data = src[i]->data;
-          data += (y * ret->width + x) * src[i]->channels;
+          data += (y * src[i]->width + x) * src[i]->channels;
 
           switch (src[i]->channels) {
-            case 1: pixel.i[i] = *data;                 break;
-            case 3: pixel.i[i] = b4lum(*(vec4b*)data);  break;
-            case 4: pixel.i[i] = b4lum(*(vec4b*)data);  break;
-            default: assert(false);                     break;
+            case 1: pixel.i[i] = *data;                               break;
+            case 3: pixel.i[i] = b4lum(v34b(*(color3b*)data, 255));   break;
+            case 4: pixel.i[i] = b4lum(*(vec4b*)data);                break;
+            default: assert(false);                                   break;
           }
         }
       }
 
-      *((color3b*)ret->data + y * size.h + x) = pixel;
+      *((color3b*)ret->data + y * size.w + x) = pixel;
     }
   }
 
@@ -428,11 +744,7 @@ Image img_pack_channels(Image r, Image g, Image b) {
 ////////////////////////////////////////////////////////////////////////////////
 
 index_t img_loading_count(void) {
-#ifdef __WASM__
   return _img_loading_count;
-#else
-  return (index_t)SDL_GetAtomicInt(&_img_loading_count);
-#endif
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -486,6 +798,14 @@ void img_delete(Image* pimg) {
   if (!pimg || !*pimg) return;
   Image_Internal* img = (Image_Internal*)*pimg;
 
+#ifndef __WASM__
+  // images still being decoded are released once the worker is done
+  if (_img_cancel(img)) {
+    *pimg = NULL;
+    return;
+  }
+#endif
+
   if (img->pub.type != IMG_DEFAULT && img->pub.type != IMG_ERROR) {
     _img_free(img);
     str_delete(&img->filename_internal);
@@ -53,7 +53,7 @@ static void _attribute_bind_transform(attribute_format_t f, Shader s) {
   const attribute_base_t* base = NULL;
   const GLsizei stride = _attrib_format[f].size;
 
-  GLuint i = shader_attribute_loc(s, "model_matrix");
+  GLuint i = shader_attribute_id(s, SV_MODEL_MATRIX);
   if (i < 0) return;
 
   glEnableVertexAttribArray(i);
@@ -78,7 +78,7 @@ static inline void _attribute_bind_tint(Shader s) {
   const GLsizei stride = sizeof(*base);
   _attribute_bind_transform(AF_TINT, s);
 
-  GLint i = shader_attribute_loc(s, "model_tint");
+  GLint i = shader_attribute_id(s, SV_MODEL_TINT);
   if (i < 0) return;
 
   glEnableVertexAttribArray(i);
@@ -91,7 +91,7 @@ static inline void _attribute_bind_material(Shader s) {
   const GLsizei stride = sizeof(*base);
   _attribute_bind_transform(AF_MATERIAL, s);
 
-  GLint i = shader_attribute_loc(s, "model_material_index");
+  GLint i = shader_attribute_id(s, SV_MODEL_MATERIAL_INDEX);
   if (i < 0) return;
 
   glEnableVertexAttribArray(i);
@@ -104,14 +104,14 @@ static inline void _attribute_bind_material_tint(Shader s) {
   const GLsizei stride = sizeof(*base);
   _attribute_bind_transform(AF_MATERIAL_TINT, s);
 
-  GLint mat = shader_attribute_loc(s, "model_material_index");
+  GLint mat = shader_attribute_id(s, SV_MODEL_MATERIAL_INDEX);
   if (mat >= 0) {
     glEnableVertexAttribArray(mat);
     glVertexAttribIPointer(mat, 1, GL_INT, stride, &base->material_index);
     glVertexAttribDivisor(mat, 1);
   }
 
-  GLint tint = shader_attribute_loc(s, "model_tint");
+  GLint tint = shader_attribute_id(s, SV_MODEL_TINT);
   if (tint >= 0) {
     glEnableVertexAttribArray(tint);
     glVertexAttribPointer(tint, 4, GL_UNSIGNED_BYTE, true, stride, &base->tint);
@@ -123,7 +123,7 @@ static void _attribute_bind_particle_base(attribute_format_t format, Shader s) {
   const vec3* base = NULL;
   const GLsizei stride = _attrib_format[format].size;
 
-  GLint i = shader_attribute_loc(s, "model_pos");
+  GLint i = shader_attribute_id(s, SV_MODEL_POS);
   if (i < 0) return;
 
   glEnableVertexAttribArray(i);
@@ -136,7 +136,7 @@ static inline void _attribute_bind_particle_point(Shader s) {
   const GLsizei stride = sizeof(*base);
   _attribute_bind_particle_base(AF_PARTICLE_POINT, s);
 
-  GLint i = shader_attribute_loc(s, "model_scale");
+  GLint i = shader_attribute_id(s, SV_MODEL_SCALE);
   if (i < 0) return;
 
   glEnableVertexAttribArray(i);
@@ -0,0 +1,269 @@
+/*******************************************************************************
+* MIT License
+*
+* Copyright (c) 2026 Curtis McCoy
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "ktx2.h"
+#include "str.h"
+
+#include <string.h>
+
+#ifndef __WASM__
+# include <stdio.h>
+#endif
+
+static_assert(sizeof(ktx2_header_t) == 80, "Unexpected KTX2 header size");
+static_assert(sizeof(ktx2_level_t) == 24, "Unexpected KTX2 level size");
+
+static const uint8_t _ktx2_identifier[12] = {
+  0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+// VkFormat values with a tex_format_t equivalent. The sRGB variants load as
+//    their UNORM format since shaders do the conversion.
+static tex_format_t _ktx2_format(uint32_t vk_format) {
+  switch (vk_format) {
+    case 9:   case 15:  return TF_R_8;
+    case 23:  case 29:  return TF_RGB_8;
+    case 37:  case 43:  return TF_RGBA_8;
+    case 131: case 132: // VK_FORMAT_BC1_RGB_*
+    case 133: case 134: return TF_BC1_RGBA;
+    case 137: case 138: return TF_BC3_RGBA;
+    case 139:           return TF_BC4_R;
+    case 141:           return TF_BC5_RG;
+    case 145: case 146: return TF_BC7_RGBA;
+    case 147: case 148: return TF_ETC2_RGB;
+    case 151: case 152: return TF_ETC2_RGBA;
+    case 157: case 158: return TF_ASTC_4X4_RGBA;
+    default:            return TF_SUPPORTED_MAX;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool ktx2_is_ktx2(slice_t data) {
+  if (data.size < (index_t)sizeof(_ktx2_identifier)) return false;
+  return !memcmp(data.begin, _ktx2_identifier, sizeof(_ktx2_identifier));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool ktx2_parse(slice_t data, ktx2_t* out) {
+  assert(out);
+
+  if (data.size < (index_t)sizeof(ktx2_header_t)) return false;
+  if (!ktx2_is_ktx2(data)) return false;
+
+  ktx2_header_t header;
+  memcpy(&header, data.begin, sizeof(header));
+
+  if (header.supercompression != 0) {
+    str_log("[KTX2.parse] Supercompression not supported: {}"
+    , (int)header.supercompression
+    );
+    return false;
+  }
+
+  tex_format_t format = _ktx2_format(header.vk_format);
+  if (format == TF_SUPPORTED_MAX) {
+    str_log("[KTX2.parse] Unsupported VkFormat: {}", (int)header.vk_format);
+    return false;
+  }
+
+  if (header.pixel_depth > 1 || header.face_count != 1) {
+    str_write("[KTX2.parse] Only 2D textures and arrays are supported");
+    return false;
+  }
+
+  index_t levels = MAX(header.level_count, 1);
+  vec2i size = v2i((int)header.pixel_width, (int)header.pixel_height);
+  index_t layers = MAX(header.layer_count, 1);
+
+  if (levels > KTX2_MAX_LEVELS || size.w <= 0 || size.h <= 0) {
+    str_write("[KTX2.parse] Invalid texture dimensions");
+    return false;
+  }
+
+  uint64_t index_end = sizeof(header) + levels * sizeof(ktx2_level_t);
+  if (index_end > (uint64_t)data.size) {
+    str_write("[KTX2.parse] Level index out of range");
+    return false;
+  }
+
+  *out = (ktx2_t) {
+    .format = format,
+    .size = size,
+    .layers = layers,
+    .levels = levels,
+  };
+
+  for (index_t i = 0; i < levels; ++i) {
+    ktx2_level_t level;
+    memcpy(&level
+    , data.begin + sizeof(header) + i * sizeof(ktx2_level_t)
+    , sizeof(level)
+    );
+
+    vec2i level_size = v2i(MAX(size.w >> i, 1), MAX(size.h >> i, 1));
+    uint64_t expected = (uint64_t)layers
+      * tex_format_data_size(format, level_size);
+
+    if (level.size < expected || level.size > (uint64_t)data.size
+    ||  level.offset > (uint64_t)data.size - level.size
+    ) {
+      str_log("[KTX2.parse] Level {} out of range or truncated", i);
+      return false;
+    }
+
+    out->level[i].data = (const byte*)data.begin + level.offset;
+    out->level[i].size = (index_t)expected;
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Writing baked textures
+////////////////////////////////////////////////////////////////////////////////
+
+#ifdef __WASM__
+
+bool ktx2_write(slice_t filename, const ktx2_t* ktx) {
+  UNUSED(filename);
+  UNUSED(ktx);
+  assert(false);
+  return false;
+}
+
+#else
+
+// Basic data format descriptor for 8-bit unsigned normalized RGBA channels,
+//    which the spec requires even though the VkFormat already says as much.
+static index_t _ktx2_write_dfd(uint32_t* out, int channels) {
+  static const uint32_t channel_ids[4] = { 0, 1, 2, 15 }; // R, G, B, A
+  index_t block_size = 24 + 16 * channels;
+
+  out[0] = (uint32_t)(4 + block_size);  // total size
+  out[1] = 0;                           // Khronos vendor, basic descriptor
+  out[2] = 2 | (uint32_t)block_size << 16;
+  out[3] = 1 | 1 << 8 | 1 << 16;        // RGBSDA, BT709, linear
+  out[4] = 0;                           // 1x1x1x1 texel blocks
+  out[5] = (uint32_t)channels;          // bytes in plane 0
+  out[6] = 0;
+
+  for (int i = 0; i < channels; ++i) {
+    uint32_t* sample = out + 7 + i * 4;
+    sample[0] = (uint32_t)(i * 8) | 7 << 16 | channel_ids[i] << 24;
+    sample[1] = 0;
+    sample[2] = 0;
+    sample[3] = 255;
+  }
+
+  return 4 + block_size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool ktx2_write(slice_t filename, const ktx2_t* ktx) {
+  assert(ktx);
+  assert(ktx->levels > 0 && ktx->levels <= KTX2_MAX_LEVELS);
+
+  uint32_t vk_format;
+  int channels;
+  switch (ktx->format) {
+    case TF_R_8:    vk_format = 9;  channels = 1; break;
+    case TF_RGB_8:  vk_format = 23; channels = 3; break;
+    case TF_RGBA_8: vk_format = 37; channels = 4; break;
+    default:
+      str_write("[KTX2.write] Only 8-bit R, RGB and RGBA can be written");
+      return false;
+  }
+
+  uint32_t dfd[4 + 6 + 4 * 4];
+  index_t dfd_size = _ktx2_write_dfd(dfd, channels);
+  index_t dfd_offset =
+    sizeof(ktx2_header_t) + ktx->levels * sizeof(ktx2_level_t);
+
+  ktx2_header_t header = {
+    .vk_format = vk_format,
+    .type_size = 1,
+    .pixel_width = (uint32_t)ktx->size.w,
+    .pixel_height = (uint32_t)ktx->size.h,
+    .layer_count = (uint32_t)ktx->layers,
+    .face_count = 1,
+    .level_count = (uint32_t)ktx->levels,
+    .dfd_offset = (uint32_t)dfd_offset,
+    .dfd_size = (uint32_t)dfd_size,
+  };
+  memcpy(header.identifier, _ktx2_identifier, sizeof(_ktx2_identifier));
+
+  // Levels are stored smallest first, each aligned to lcm(texel size, 4)
+  index_t alignment = channels == 3 ? 12 : 4;
+  ktx2_level_t index[KTX2_MAX_LEVELS] = { 0 };
+  uint64_t offset = dfd_offset + dfd_size;
+
+  for (index_t i = ktx->levels; i-- > 0; ) {
+    offset = (offset + alignment - 1) / alignment * alignment;
+    index[i] = (ktx2_level_t) {
+      .offset = offset,
+      .size = (uint64_t)ktx->level[i].size,
+      .uncompressed_size = (uint64_t)ktx->level[i].size,
+    };
+    offset += ktx->level[i].size;
+  }
+
+  String file_str = str_copy(filename);
+  FILE* file = fopen(file_str->begin, "wb");
+
+  if (!file) {
+    str_log("[KTX2.write] Failed to open file: {}", filename);
+    str_delete(&file_str);
+    return false;
+  }
+
+  static const byte padding[16] = { 0 };
+  bool success = fwrite(&header, sizeof(header), 1, file) == 1
+    && fwrite(index, sizeof(ktx2_level_t), ktx->levels, file)
+      == (size_t)ktx->levels
+    && fwrite(dfd, 1, dfd_size, file) == (size_t)dfd_size;
+
+  for (index_t i = ktx->levels; success && i-- > 0; ) {
+    long position = ftell(file);
+    index_t pad = (index_t)index[i].offset - position;
+    success = fwrite(padding, 1, pad, file) == (size_t)pad
+      && fwrite(ktx->level[i].data, 1, ktx->level[i].size, file)
+        == (size_t)ktx->level[i].size;
+  }
+
+  fclose(file);
+
+  if (!success) {
+    str_log("[KTX2.write] Failed writing file: {}", filename);
+  }
+
+  str_delete(&file_str);
+  return success;
+}
+
+#endif
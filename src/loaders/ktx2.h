@@ -0,0 +1,92 @@
+/*******************************************************************************
+* MIT License
+*
+* Copyright (c) 2026 Curtis McCoy
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#ifndef WASP_LOADER_KTX2_H_
+#define WASP_LOADER_KTX2_H_
+
+// Reader and writer for KTX2 texture containers. The level data is uploaded
+//    as-is, so a file holds either GPU block compressed data (BC, ETC2 or
+//    ASTC) encoded offline without supercompression, e.g. with
+//    `ktx create --format BC7_UNORM_BLOCK`, or 8-bit R/RGB/RGBA texels baked
+//    by tools/asset_bake.c. Basis Universal (supercompressed) files aren't
+//    supported.
+
+#include "types.h"
+#include "slice.h"
+#include "vec.h"
+#include "texture.h"
+
+#include <stdint.h>
+
+#define KTX2_MAX_LEVELS 16
+
+typedef struct ktx2_header_t {
+  uint8_t   identifier[12];
+  uint32_t  vk_format;
+  uint32_t  type_size;
+  uint32_t  pixel_width;
+  uint32_t  pixel_height;
+  uint32_t  pixel_depth;
+  uint32_t  layer_count;
+  uint32_t  face_count;
+  uint32_t  level_count;
+  uint32_t  supercompression;
+  uint32_t  dfd_offset;
+  uint32_t  dfd_size;
+  uint32_t  kvd_offset;
+  uint32_t  kvd_size;
+  uint64_t  sgd_offset;
+  uint64_t  sgd_size;
+} ktx2_header_t;
+
+typedef struct ktx2_level_t {
+  uint64_t  offset;
+  uint64_t  size;
+  uint64_t  uncompressed_size;
+} ktx2_level_t;
+
+// A parsed view into a .ktx2 buffer, level data points into that buffer
+typedef struct ktx2_t {
+  tex_format_t  format;
+  vec2i         size;
+  index_t       layers;   // at least 1, array layers are stored per level
+  index_t       levels;
+  struct {
+    const byte* data;
+    index_t     size;
+  } level[KTX2_MAX_LEVELS];
+} ktx2_t;
+
+// \brief Checks whether the data starts with the KTX2 identifier
+bool ktx2_is_ktx2(slice_t data);
+
+// \brief Validates the header, format and level ranges, and fills `out` with
+//    views into `data`. Nothing is copied.
+bool ktx2_parse(slice_t data, ktx2_t* out);
+
+// \brief Writes an uncompressed 8-bit texture with the given levels to a
+//    .ktx2 file (native only). Level data holds every layer of that level.
+bool ktx2_write(slice_t filename, const ktx2_t* ktx);
+
+#endif
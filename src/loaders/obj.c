@@ -3,9 +3,12 @@
 
 #include "str.h"
 #include "array.h"
-#include "map.h"
+#include "thread.h"
 
 #include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
 typedef struct {
   vec3 pos;
@@ -18,233 +21,572 @@ typedef struct {
   int uv;
 } obj_face_elem_t;
 
-model_obj_t file_load_obj(slice_t text) {
-  model_obj_t model = { .format = VF_UV_NORM };
+// Files larger than this are split into chunks that are counted and parsed
+//    on the job threads. Chunks always end on a line boundary.
+#define OBJ_CHUNK_BYTES   (1 << 20)
+#define OBJ_MAX_CHUNKS    64
+
+////////////////////////////////////////////////////////////////////////////////
+// Parse state
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct obj_counts_t {
+  index_t verts;
+  index_t uvs;
+  index_t norms;
+  index_t elems;    // face elements after fan triangulation, 3 per triangle
+  bool    has_color;
+  bool    has_error;
+  slice_t name;
+} obj_counts_t;
+
+typedef struct obj_chunk_t {
+  const char*   begin;
+  const char*   end;
+  obj_counts_t  count;
+  obj_counts_t  offset; // first output slot of each element type
+} obj_chunk_t;
+
+typedef struct obj_parse_t {
+  obj_chunk_t         chunks[OBJ_MAX_CHUNKS];
+  index_t             chunk_count;
+  obj_counts_t        total;
+  obj_vertex_part_t*  verts;
+  vec2*               uvs;
+  vec3*               norms;
+  obj_face_elem_t*    elems;
+} obj_parse_t;
+
+////////////////////////////////////////////////////////////////////////////////
+// Scalar parsing helpers
+////////////////////////////////////////////////////////////////////////////////
+
+static inline bool _obj_is_space(char c) {
+  return c == ' ' || c == '\t' || c == '\r';
+}
 
-  Array verts = arr_new(obj_vertex_part_t);
-  Array norms = arr_new(vec3);
-  Array uvs   = arr_new(vec2);
-  Array faces = arr_new(obj_face_elem_t);
-  
-  str_write("[Model.build] Parsing OBJ...");
+static inline bool _obj_is_digit(char c) {
+  return (unsigned)(c - '0') < 10;
+}
 
-  index_t line_pos = 0;
+static inline const char* _obj_skip_space(const char* p, const char* end) {
+  while (p < end && _obj_is_space(*p)) ++p;
+  return p;
+}
 
-  while (line_pos < text.length) {
-    slice_t line = str_token_line(text, &line_pos).token;
+static inline const char* _obj_skip_token(const char* p, const char* end) {
+  while (p < end && !_obj_is_space(*p)) ++p;
+  return p;
+}
 
-    index_t i = 0;
-    while (i < line.length) {
-      slice_t token = str_token_space(line, &i).token;
-      if (token.length <= 0) break;
+static const char* _obj_line_end(const char* p, const char* end) {
+  const char* nl = memchr(p, '\n', end - p);
+  return nl ? nl : end;
+}
 
-      switch (token.begin[0]) {
+static index_t _obj_count_tokens(const char* p, const char* end) {
+  index_t count = 0;
+  while ((p = _obj_skip_space(p, end)) < end) {
+    p = _obj_skip_token(p, end);
+    ++count;
+  }
+  return count;
+}
 
-        // Read vertex info
-        case 'v': {
+////////////////////////////////////////////////////////////////////////////////
 
-          if (token.length == 1) {
-            obj_vertex_part_t* vert = arr_emplace_back(verts);
+static const double _obj_pow10[] = {
+  1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
 
-            // coordinate
-            slice_to_float(slice_token_space(line, &i).token, &vert->pos.x);
-            slice_to_float(slice_token_space(line, &i).token, &vert->pos.y);
-            slice_to_float(slice_token_space(line, &i).token, &vert->pos.z);
+// Decimal float parser for the plain "[-]123.456[e-7]" forms OBJ exporters
+//    write. Keeps up to 19 significant digits, plenty for float output.
+static const char* _obj_parse_float(
+  const char* p, const char* end, float* out
+) {
+  p = _obj_skip_space(p, end);
 
-            // optional vertex color
-            if (i != line.length) {
-              model.format = VF_UV_NORM_COLOR;
-              slice_to_float(slice_token_space(line, &i).token, &vert->color.r);
-              slice_to_float(slice_token_space(line, &i).token, &vert->color.g);
-              slice_to_float(slice_token_space(line, &i).token, &vert->color.b);
-            }
-            else {
-              vert->color = c4white.rgb;
-            }
-          }
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+')) negative = *p++ == '-';
 
-          // Either 'vt' or 'vn' sections, read a texcoord or normal
-          else {
+  uint64_t mantissa = 0;
+  int digits = 0;
+  int exponent = 0;
 
-            switch (token.begin[1]) {
+  for (; p < end && _obj_is_digit(*p); ++p) {
+    if (digits < 19) {
+      mantissa = mantissa * 10 + (*p - '0');
+      if (mantissa) ++digits;
+    }
+    else {
+      ++exponent;
+    }
+  }
+
+  if (p < end && *p == '.') {
+    for (++p; p < end && _obj_is_digit(*p); ++p) {
+      if (digits < 19) {
+        mantissa = mantissa * 10 + (*p - '0');
+        if (mantissa) ++digits;
+        --exponent;
+      }
+    }
+  }
+
+  if (p < end && (*p == 'e' || *p == 'E')) {
+    ++p;
+    bool exp_negative = false;
+    if (p < end && (*p == '-' || *p == '+')) exp_negative = *p++ == '-';
+
+    int e = 0;
+    for (; p < end && _obj_is_digit(*p); ++p) {
+      if (e < 1000) e = e * 10 + (*p - '0');
+    }
+    exponent += exp_negative ? -e : e;
+  }
 
-              // read a vertex normal
-              case 'n': {
-                vec3* norm = arr_emplace_back(norms);
-                slice_to_float(slice_token_space(line, &i).token, &norm->x);
-                slice_to_float(slice_token_space(line, &i).token, &norm->y);
-                slice_to_float(slice_token_space(line, &i).token, &norm->z);
-              } break;
+  double value = (double)mantissa;
+  for (; exponent > 22; exponent -= 22) value *= 1e22;
+  for (; exponent < -22; exponent += 22) value /= 1e22;
+  value = exponent >= 0
+    ? value * _obj_pow10[exponent]
+    : value / _obj_pow10[-exponent];
+
+  *out = (float)(negative ? -value : value);
+  return _obj_skip_token(p, end);
+}
 
-              // read a texture coordinate
-              case 't': {
-                vec2* uv = arr_emplace_back(uvs);
-                slice_to_float(slice_token_space(line, &i).token, &uv->u);
-                slice_to_float(slice_token_space(line, &i).token, &uv->v);
-              } break;
+////////////////////////////////////////////////////////////////////////////////
 
-              // unsupported vertex object
-              default: {
-                assert(false);
-              } break;
+static const char* _obj_parse_int(const char* p, const char* end, int* out) {
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+')) negative = *p++ == '-';
 
-            }
+  int value = 0;
+  for (; p < end && _obj_is_digit(*p); ++p) {
+    value = value * 10 + (*p - '0');
+  }
+
+  *out = negative ? -value : value;
+  return p;
+}
 
+////////////////////////////////////////////////////////////////////////////////
+
+// Resolves a 1-based (or negative, relative) OBJ index against the number of
+//    elements declared so far. Returns 0 for an omitted index and -1 if the
+//    index is out of range.
+static inline int _obj_resolve(int index, index_t declared, index_t total) {
+  if (index < 0) index = (int)declared + 1 + index;
+  else if (index == 0) return 0;
+  return index >= 1 && index <= total ? index : -1;
+}
+
+// Reads one "v", "v/vt", "v//vn" or "v/vt/vn" face element
+static const char* _obj_parse_elem(
+  const char* p, const char* end, obj_face_elem_t* elem
+) {
+  *elem = (obj_face_elem_t) { 0 };
+  p = _obj_parse_int(_obj_skip_space(p, end), end, &elem->vert);
+
+  if (p < end && *p == '/') {
+    ++p;
+    if (p < end && *p != '/') p = _obj_parse_int(p, end, &elem->uv);
+    if (p < end && *p == '/') p = _obj_parse_int(p + 1, end, &elem->norm);
+  }
+
+  return _obj_skip_token(p, end);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Pass 1 - count elements so every output buffer is allocated exactly once
+////////////////////////////////////////////////////////////////////////////////
+
+static void _obj_count_chunk(index_t begin, index_t end, void* data) {
+  obj_parse_t* parse = data;
+
+  for (index_t c = begin; c < end; ++c) {
+    obj_chunk_t* chunk = &parse->chunks[c];
+    obj_counts_t count = { 0 };
+    const char* p = chunk->begin;
+
+    while (p < chunk->end) {
+      const char* line_end = _obj_line_end(p, chunk->end);
+      const char* s = _obj_skip_space(p, line_end);
+      index_t length = line_end - s;
+
+      if (length >= 2 && s[0] == 'v' && _obj_is_space(s[1])) {
+        ++count.verts;
+        if (!count.has_color && _obj_count_tokens(s + 2, line_end) > 3) {
+          count.has_color = true;
+        }
+      }
+      else if (length >= 3 && s[0] == 'v' && _obj_is_space(s[2])) {
+        if (s[1] == 't') ++count.uvs;
+        else if (s[1] == 'n') ++count.norms;
+      }
+      else if (length >= 2 && s[0] == 'f' && _obj_is_space(s[1])) {
+        index_t corners = _obj_count_tokens(s + 2, line_end);
+        if (corners >= 3) count.elems += (corners - 2) * 3;
+      }
+      else if (length >= 2 && s[0] == 'o' && _obj_is_space(s[1])) {
+        const char* name = _obj_skip_space(s + 2, line_end);
+        const char* name_end = line_end;
+        while (name_end > name && _obj_is_space(name_end[-1])) --name_end;
+        count.name = (slice_t) { .begin = name, .size = name_end - name };
+      }
+
+      p = line_end + 1;
+    }
+
+    chunk->count = count;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Pass 2 - parse each chunk straight into its reserved output ranges
+////////////////////////////////////////////////////////////////////////////////
+
+static void _obj_parse_chunk(index_t begin, index_t end, void* data) {
+  obj_parse_t* parse = data;
+  obj_counts_t total = parse->total;
+
+  for (index_t c = begin; c < end; ++c) {
+    obj_chunk_t* chunk = &parse->chunks[c];
+    obj_counts_t at = chunk->offset;
+    const char* p = chunk->begin;
+
+    while (p < chunk->end) {
+      const char* line_end = _obj_line_end(p, chunk->end);
+      const char* s = _obj_skip_space(p, line_end);
+      index_t length = line_end - s;
+
+      if (length >= 2 && s[0] == 'v' && _obj_is_space(s[1])) {
+        obj_vertex_part_t* vert = &parse->verts[at.verts++];
+        s = _obj_parse_float(s + 2, line_end, &vert->pos.x);
+        s = _obj_parse_float(s, line_end, &vert->pos.y);
+        s = _obj_parse_float(s, line_end, &vert->pos.z);
+
+        // optional vertex color
+        if (_obj_skip_space(s, line_end) < line_end) {
+          s = _obj_parse_float(s, line_end, &vert->color.r);
+          s = _obj_parse_float(s, line_end, &vert->color.g);
+          s = _obj_parse_float(s, line_end, &vert->color.b);
+        }
+        else {
+          vert->color = c4white.rgb;
+        }
+      }
+      else if (length >= 3 && s[0] == 'v' && _obj_is_space(s[2])
+      &&  s[1] == 't'
+      ) {
+        vec2* uv = &parse->uvs[at.uvs++];
+        s = _obj_parse_float(s + 3, line_end, &uv->u);
+        s = _obj_parse_float(s, line_end, &uv->v);
+      }
+      else if (length >= 3 && s[0] == 'v' && _obj_is_space(s[2])
+      &&  s[1] == 'n'
+      ) {
+        vec3* norm = &parse->norms[at.norms++];
+        s = _obj_parse_float(s + 3, line_end, &norm->x);
+        s = _obj_parse_float(s, line_end, &norm->y);
+        s = _obj_parse_float(s, line_end, &norm->z);
+      }
+      else if (length >= 2 && s[0] == 'f' && _obj_is_space(s[1])) {
+        obj_face_elem_t corner[3];
+        index_t corners = 0;
+        s += 2;
+
+        // fan triangulation: (0, 1, 2), (0, 2, 3), ...
+        while ((s = _obj_skip_space(s, line_end)) < line_end) {
+          obj_face_elem_t elem;
+          s = _obj_parse_elem(s, line_end, &elem);
+
+          elem.vert = _obj_resolve(elem.vert, at.verts, total.verts);
+          elem.uv = _obj_resolve(elem.uv, at.uvs, total.uvs);
+          elem.norm = _obj_resolve(elem.norm, at.norms, total.norms);
+
+          if (elem.vert <= 0 || elem.uv < 0 || elem.norm < 0) {
+            chunk->count.has_error = true;
+          }
+
+          if (corners < 3) {
+            corner[corners] = elem;
+          }
+          else {
+            corner[1] = corner[2];
+            corner[2] = elem;
           }
 
-        } break;
-
-        // Read a face
-        case 'f': {
-          obj_face_elem_t elem0;
-          slice_to_int(str_token_char(line, "/", &i).token, &elem0.vert);
-          slice_to_int(str_token_char(line, "/", &i).token, &elem0.uv);
-          slice_to_int(slice_token_space(line, &i).token, &elem0.norm);
-          arr_write_back(faces, &elem0);
-
-          obj_face_elem_t elem1;
-          slice_to_int(str_token_char(line, "/", &i).token, &elem1.vert);
-          slice_to_int(str_token_char(line, "/", &i).token, &elem1.uv);
-          slice_to_int(slice_token_space(line, &i).token, &elem1.norm);
-          arr_write_back(faces, &elem1);
-
-          obj_face_elem_t elem2;
-          slice_to_int(str_token_char(line, "/", &i).token, &elem2.vert);
-          slice_to_int(str_token_char(line, "/", &i).token, &elem2.uv);
-          slice_to_int(slice_token_space(line, &i).token, &elem2.norm);
-          arr_write_back(faces, &elem2);
-
-          while (i < line.length) {
-            slice_to_int(str_token_char(line, "/", &i).token, &elem0.vert);
-            slice_to_int(str_token_char(line, "/", &i).token, &elem0.uv);
-            slice_to_int(slice_token_space(line, &i).token, &elem0.norm);
-            arr_write_back(faces, &elem1);
-            arr_write_back(faces, &elem2);
-            arr_write_back(faces, &elem0);
-            elem1 = elem2;
-            elem2 = elem0;
+          if (++corners >= 3) {
+            memcpy(&parse->elems[at.elems], corner, sizeof(corner));
+            at.elems += 3;
           }
-        } break;
+        }
+      }
+
+      p = line_end + 1;
+    }
+  }
+}
 
-        case 'o': {
-          model.name = str_copy(slice_drop(line, i));
-        } break;
+////////////////////////////////////////////////////////////////////////////////
+// Vertex deduplication with an open-addressing table on (vert, uv, norm)
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct obj_dedup_slot_t {
+  obj_face_elem_t key;  // key.vert == 0 marks an empty slot
+  uint            index;
+} obj_dedup_slot_t;
+
+static inline uint32_t _obj_elem_hash(obj_face_elem_t e) {
+  uint32_t h = (uint32_t)e.vert * 0x9E3779B1u;
+  h ^= (uint32_t)e.uv * 0x85EBCA77u;
+  h ^= (uint32_t)e.norm * 0xC2B2AE3Du;
+  h ^= h >> 15;
+  h *= 0x2C1B3C6Du;
+  h ^= h >> 13;
+  return h;
+}
 
-        // Skip past the line if it's a comment, object name, or whatever 's' is
-        default: {
-          i = line.length;
-        } break;
+// Fills `indices` and returns the number of unique vertices. `firsts` gets the
+//    element index that introduced each unique vertex, in first-seen order.
+static index_t _obj_dedup(
+  const obj_face_elem_t* elems, index_t count, uint* indices, uint* firsts
+) {
+  index_t capacity = 16;
+  while (capacity < count + count / 2) capacity *= 2;
+  index_t mask = capacity - 1;
+
+  obj_dedup_slot_t* table = calloc(capacity, sizeof(*table));
+  assert(table);
+  index_t unique = 0;
+
+  for (index_t i = 0; i < count; ++i) {
+    obj_face_elem_t key = elems[i];
+    index_t slot = _obj_elem_hash(key) & mask;
+
+    while (true) {
+      obj_dedup_slot_t* entry = &table[slot];
+
+      if (entry->key.vert == 0) {
+        entry->key = key;
+        entry->index = (uint)unique;
+        firsts[unique++] = (uint)i;
+        break;
+      }
 
+      if (entry->key.vert == key.vert
+      &&  entry->key.uv == key.uv
+      &&  entry->key.norm == key.norm
+      ) {
+        break;
       }
 
+      slot = (slot + 1) & mask;
     }
 
+    indices[i] = table[slot].index;
   }
 
-  model.indices = arr_new_reserve(uint, faces->size);
+  free(table);
+  return unique;
+}
 
-  switch (model.format) {
-    case VF_UV_NORM: model.verts = arr_new(vertex_uv_norm_t); break;
-    case VF_UV_NORM_COLOR: model.verts = arr_new(vertex_uv_norm_color_t); break;
-    default: assert(false); break;
-  }
+////////////////////////////////////////////////////////////////////////////////
+
+static void _obj_compute_tangents(model_obj_t* model) {
+  if (model->indices->size < 3) return;
+
+  uint* indices = model->indices->begin;
+
+  for (index_t i = 0; i < model->indices->size; i += 3) {
+    vertex_uv_norm_t* vtx[3] = {
+      arr_ref(model->verts, indices[i]),
+      arr_ref(model->verts, indices[i + 1]),
+      arr_ref(model->verts, indices[i + 2])
+    };
+
+    vec3 n0 = vtx[0]->norm;
+    vec3 p0 = vtx[0]->pos;
 
-  // Collect face index values into into shared vertex data and the index list.
-  HMap vmap = map_new(obj_face_elem_t, uint, NULL, NULL);
-  map_reserve(vmap, faces->size);
-
-  obj_face_elem_t* arr_foreach(f, faces) {
-    res_ensure_t e = map_ensure(vmap, f);
-    if (e.is_new) {
-      obj_vertex_part_t* vert = arr_ref(verts, f->vert - 1);
-      *(uint*)e.value = (uint)model.verts->size;
-      arr_write_back(model.indices, e.value);
-      arr_write_back(model.verts, &(vertex_uv_norm_color_t) {
-        .pos = vert->pos,
-        .uv = *((vec2*)arr_ref(uvs, f->uv - 1)),
-        .norm = *((vec3*)arr_ref(norms, f->norm - 1)),
-        .tangent = v4zero,
-        .color = vert->color,
-      });
+    vec3 p1 = vtx[1]->pos;
+    vec2 uv1 = vtx[1]->uv;
+
+    vec3 p2 = vtx[2]->pos;
+    vec2 uv2 = vtx[2]->uv;
+
+    vec3 e1 = v3sub(p1, p0);
+    vec3 e2 = v3sub(p2, p0);
+
+    float uv_cross = v2cross(uv1, uv2);
+    vec3 tangent;
+    float handedness;
+
+    if (fabs(uv_cross) < 0.000001f) {
+      tangent = v3perp(n0);
+      handedness = 1;
     }
     else {
-      arr_write_back(model.indices, e.value);
+      float r = 1.0f / uv_cross;
+
+      tangent = v3sub(v3scale(e1, uv2.y), v3scale(e2, uv1.y));
+      vec3 bitangent = v3sub(v3scale(e2, uv1.x), v3scale(e1, uv2.x));
+      tangent = v3scale(tangent, r);
+      bitangent = v3scale(bitangent, r);
+
+      handedness = v3dot(v3cross(n0, tangent), bitangent) < 0 ? -1.0f : 1.0f;
+    }
+
+    for (index_t j = 0; j < 3; ++j) {
+      vtx[j]->tangent.xyz = v3add(vtx[j]->tangent.xyz, tangent);
+      if (vtx[j]->tangent.w == 0.0f) vtx[j]->tangent.w = handedness;
     }
   }
 
-  map_delete(&vmap);
+  for (index_t i = 0; i < model->verts->size; ++i) {
+    vertex_uv_norm_t* vtx = arr_ref(model->verts, i);
+    vtx->tangent.xyz = v3norm(vtx->tangent.xyz);
+  }
+}
 
-  // Cleanup...
-  arr_delete(&faces);
-  arr_delete(&verts);
-  arr_delete(&uvs);
-  arr_delete(&norms);
+////////////////////////////////////////////////////////////////////////////////
 
-  arr_truncate(model.verts, model.verts->size);
+static void _obj_split_chunks(obj_parse_t* parse, slice_t text) {
+  const char* p = text.begin;
+  const char* end = text.begin + text.size;
 
-  str_log("[Model.build] Parsed model {} - verts: {}, indices: {}"
-  , model.name, model.verts->size, model.indices->size
-  );
+  index_t chunks = text.size / OBJ_CHUNK_BYTES + 1;
+  chunks = MIN(chunks, OBJ_MAX_CHUNKS);
+  index_t target = text.size / chunks + 1;
 
-  // Calculate tangents for each vertex...
-  if (model.indices->size >= 3) {
-    uint* indices = model.indices->begin;
+  parse->chunk_count = 0;
 
-    for (index_t i = 0; i < model.indices->size; i += 3) {
-      uint i0 = indices[i];
-      uint i1 = indices[i + 1];
-      uint i2 = indices[i + 2];
+  while (p < end) {
+    const char* split = parse->chunk_count + 1 < chunks
+      ? MIN(p + target, end)
+      : end;
+    split = split < end ? _obj_line_end(split, end) : end;
+    if (split < end) ++split;
 
-      vertex_uv_norm_t* vtx[3] = {
-        arr_ref(model.verts, i0),
-        arr_ref(model.verts, i1),
-        arr_ref(model.verts, i2)
-      };
+    parse->chunks[parse->chunk_count++] = (obj_chunk_t) {
+      .begin = p,
+      .end = split,
+    };
+    p = split;
+  }
+}
 
-      vec3 n0 = vtx[0]->norm;
-      vec3 p0 = vtx[0]->pos;
-      //vec2 uv0 = vtx[0]->uv;
+////////////////////////////////////////////////////////////////////////////////
 
-      vec3 p1 = vtx[1]->pos;
-      vec2 uv1 = vtx[1]->uv;
+model_obj_t file_load_obj(slice_t text) {
+  model_obj_t model = { .format = VF_UV_NORM };
 
-      vec3 p2 = vtx[2]->pos;
-      vec2 uv2 = vtx[2]->uv;
+  str_write("[Model.build] Parsing OBJ...");
 
-      vec3 e1 = v3sub(p1, p0);
-      vec3 e2 = v3sub(p2, p0);
+  obj_parse_t* parse = malloc(sizeof(*parse));
+  assert(parse);
+  *parse = (obj_parse_t) { 0 };
+
+  _obj_split_chunks(parse, text);
+  jobs_parallel_for(parse->chunk_count, 1, _obj_count_chunk, parse);
+
+  // Prefix sums give each chunk its output offsets
+  obj_counts_t* total = &parse->total;
+  for (index_t c = 0; c < parse->chunk_count; ++c) {
+    obj_chunk_t* chunk = &parse->chunks[c];
+    chunk->offset = *total;
+    total->verts += chunk->count.verts;
+    total->uvs += chunk->count.uvs;
+    total->norms += chunk->count.norms;
+    total->elems += chunk->count.elems;
+    total->has_color |= chunk->count.has_color;
+    if (chunk->count.name.size) total->name = chunk->count.name;
+  }
 
-      float uv_cross = v2cross(uv1, uv2);
-      vec3 tangent;
-      float handedness;
+  if (total->name.size) model.name = str_copy(total->name);
+  if (total->has_color) model.format = VF_UV_NORM_COLOR;
 
-      if (fabs(uv_cross) < 0.000001f) {
-        tangent = v3perp(n0);
-        //tangent = v3zero;
-        handedness = 1;
-      }
-      else {
-        float r = 1.0f / uv_cross;
+  if (total->verts <= 0 || total->elems <= 0) {
+    str_write("[Model.build] OBJ has no faces");
+    goto obj_cleanup;
+  }
 
-        tangent = v3sub(v3scale(e1, uv2.y), v3scale(e2, uv1.y));
-        vec3 bitangent = v3sub(v3scale(e2, uv1.x), v3scale(e1, uv2.x));
-        tangent = v3scale(tangent, r);
-        bitangent = v3scale(bitangent, r);
+  parse->verts = malloc(sizeof(*parse->verts) * total->verts);
+  parse->uvs = malloc(sizeof(*parse->uvs) * MAX(total->uvs, 1));
+  parse->norms = malloc(sizeof(*parse->norms) * MAX(total->norms, 1));
+  parse->elems = malloc(sizeof(*parse->elems) * total->elems);
+  assert(parse->verts && parse->uvs && parse->norms && parse->elems);
 
-        handedness = v3dot(v3cross(n0, tangent), bitangent) < 0 ? -1.0f : 1.0f;
-      }
+  jobs_parallel_for(parse->chunk_count, 1, _obj_parse_chunk, parse);
 
-      for (index_t j = 0; j < 3; ++j) {
-        vtx[j]->tangent.xyz = v3add(vtx[j]->tangent.xyz, tangent);
-        if (vtx[j]->tangent.w == 0.0f) vtx[j]->tangent.w = handedness;
-      }
+  for (index_t c = 0; c < parse->chunk_count; ++c) {
+    if (parse->chunks[c].count.has_error) {
+      str_write("[Model.build] OBJ face references a missing element");
+      goto obj_cleanup;
     }
+  }
 
-    for (index_t i = 0; i < model.verts->size; ++i) {
-      vertex_uv_norm_t* vtx = arr_ref(model.verts, i);
-      vtx->tangent.xyz = v3norm(vtx->tangent.xyz);
-    }
+  // Collect face elements into shared vertex data and the index list
+  model.indices = arr_new_reserve(uint, total->elems);
+  arr_emplace_back_range(model.indices, total->elems);
+
+  uint* firsts = malloc(sizeof(uint) * total->elems);
+  assert(firsts);
+
+  index_t unique = _obj_dedup(
+    parse->elems, total->elems, model.indices->begin, firsts
+  );
+
+  switch (model.format) {
+    case VF_UV_NORM:
+      model.verts = arr_new_reserve(vertex_uv_norm_t, unique);
+      break;
+    case VF_UV_NORM_COLOR:
+      model.verts = arr_new_reserve(vertex_uv_norm_color_t, unique);
+      break;
+    default: assert(false); break;
   }
 
+  arr_emplace_back_range(model.verts, unique);
+
+  // Both formats share the vertex_uv_norm_color_t prefix, so write the full
+  //    vertex to a temporary and copy only the format's size.
+  char* out = model.verts->begin;
+  index_t stride = model.verts->element_size;
+
+  for (index_t i = 0; i < unique; ++i, out += stride) {
+    obj_face_elem_t f = parse->elems[firsts[i]];
+    obj_vertex_part_t* vert = &parse->verts[f.vert - 1];
+
+    vertex_uv_norm_color_t v = {
+      .pos = vert->pos,
+      .uv = f.uv ? parse->uvs[f.uv - 1] : v2zero,
+      .norm = f.norm ? parse->norms[f.norm - 1] : v3f(0, 1, 0),
+      .tangent = v4zero,
+      .color = vert->color,
+    };
+    memcpy(out, &v, stride);
+  }
+
+  free(firsts);
+
+  str_log("[Model.build] Parsed model {} - verts: {}, indices: {}"
+  , model.name, model.verts->size, model.indices->size
+  );
+
+  _obj_compute_tangents(&model);
+
+obj_cleanup:
+
+  free(parse->verts);
+  free(parse->uvs);
+  free(parse->norms);
+  free(parse->elems);
+  free(parse);
+
+  if (!model.verts && model.indices) arr_delete(&model.indices);
+
   return model;
 }
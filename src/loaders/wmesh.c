@@ -0,0 +1,386 @@
+/*******************************************************************************
+* MIT License
+*
+* Copyright (c) 2026 Curtis McCoy
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "wmesh.h"
+#include "str.h"
+
+#include <math.h> // sqrtf
+#include <string.h>
+
+#ifndef __WASM__
+# include <stdio.h>
+#endif
+
+static_assert(sizeof(wmesh_header_t) == 52, "Unexpected wmesh header size");
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool wmesh_is_binary(slice_t data) {
+  uint32_t magic;
+  if (data.size < (index_t)sizeof(magic)) return false;
+  memcpy(&magic, data.begin, sizeof(magic));
+  return magic == WMESH_MAGIC;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static bool _wmesh_range_valid(slice_t data, uint64_t offset, uint64_t size) {
+  uint64_t total = (uint64_t)data.size;
+  if (offset % WMESH_ALIGNMENT != 0 || size > total) return false;
+  return offset <= total - size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Checks what can be checked without knowing the file size
+static bool _wmesh_header_valid(const wmesh_header_t* header) {
+  if (header->version != WMESH_VERSION) {
+    str_log("[Mesh.parse] Unsupported version: {}", (int)header->version);
+    return false;
+  }
+
+  if (header->format != VF_UV_NORM && header->format != VF_UV_NORM_COLOR) {
+    str_log("[Mesh.parse] Unsupported vertex format: {}", (int)header->format);
+    return false;
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool wmesh_parse(slice_t data, wmesh_t* out) {
+  assert(out);
+
+  if (data.size < (index_t)sizeof(wmesh_header_t)) return false;
+  if (!wmesh_is_binary(data)) return false;
+
+  const wmesh_header_t* header = (const wmesh_header_t*)data.begin;
+  if (!_wmesh_header_valid(header)) return false;
+
+  uint64_t verts_size =
+    (uint64_t)header->vert_count * vertex_size(header->format);
+  uint64_t indices_size = (uint64_t)header->index_count * sizeof(uint);
+
+  if (!_wmesh_range_valid(data, header->vert_offset, verts_size)
+  ||  !_wmesh_range_valid(data, header->index_offset, indices_size)
+  ||  header->name_offset + (uint64_t)header->name_size > (uint64_t)data.size
+  ||  header->index_count % 3 != 0
+  ) {
+    str_log("[Mesh.parse] Block out of range, truncated or corrupt ({} bytes)"
+    , data.size
+    );
+    return false;
+  }
+
+  // indices go straight to the GPU, where one past the vertex buffer would
+  //    read out of bounds
+  const char* indices = data.begin + header->index_offset;
+  for (uint32_t i = 0; i < header->index_count; ++i) {
+    uint index;
+    memcpy(&index, indices + sizeof(uint) * i, sizeof(index));
+    if (index >= header->vert_count) {
+      str_log("[Mesh.parse] Index {} out of range ({} vertices)"
+      , (index_t)index, (index_t)header->vert_count
+      );
+      return false;
+    }
+  }
+
+  *out = (wmesh_t) {
+    .header = header,
+    .name = {
+      .begin = data.begin + header->name_offset,
+      .size = header->name_size,
+    },
+    .verts = data.begin + header->vert_offset,
+    .verts_size = (index_t)verts_size,
+    .indices = (const uint*)(data.begin + header->index_offset),
+    .indices_size = (index_t)indices_size,
+  };
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Incremental reading
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct wmesh_range_t {
+  uint64_t begin;
+  uint64_t end;
+} wmesh_range_t;
+
+static wmesh_range_t _wmesh_block_range(
+  const wmesh_header_t* header, wmesh_block_t block
+) {
+  uint64_t begin = 0, size = 0;
+
+  switch (block) {
+    case WMESH_BLOCK_VERTS:
+      begin = header->vert_offset;
+      size = (uint64_t)header->vert_count * vertex_size(header->format);
+      break;
+    case WMESH_BLOCK_INDICES:
+      begin = header->index_offset;
+      size = (uint64_t)header->index_count * sizeof(uint);
+      break;
+    case WMESH_BLOCK_NAME:
+      begin = header->name_offset;
+      size = header->name_size;
+      break;
+    default: assert(false); break;
+  }
+
+  return (wmesh_range_t) { .begin = begin, .end = begin + size };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Without the whole file the ranges can only be checked against each other,
+//    the end of the file is checked once the last piece arrives
+static bool _wmesh_reader_start(wmesh_reader_t* reader) {
+  const wmesh_header_t* header = &reader->header;
+
+  if (header->magic != WMESH_MAGIC) {
+    str_log("[Mesh.parse] Not a binary mesh");
+    return false;
+  }
+
+  if (!_wmesh_header_valid(header)) return false;
+
+  for (int i = 0; i < WMESH_BLOCK_COUNT; ++i) {
+    wmesh_range_t range = _wmesh_block_range(header, i);
+    bool aligned = i == WMESH_BLOCK_NAME
+      || range.begin % WMESH_ALIGNMENT == 0;
+
+    if (!aligned || range.begin < sizeof(wmesh_header_t)
+    ||  header->index_count % 3 != 0
+    ) {
+      str_log("[Mesh.parse] Block out of range or corrupt");
+      return false;
+    }
+  }
+
+  return !reader->on_header || reader->on_header(reader->data, header);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Indices are little-endian and may be split between pieces, so they're put
+//    together a byte at a time
+static bool _wmesh_reader_check_indices(
+  wmesh_reader_t* reader, uint64_t offset, slice_t bytes
+) {
+  for (index_t i = 0; i < bytes.size; ++i) {
+    index_t shift = (index_t)((offset + i) % sizeof(uint)) * 8;
+    reader->index_value |= (uint32_t)(byte)bytes.begin[i] << shift;
+    if (shift < 24) continue;
+
+    if (reader->index_value >= reader->header.vert_count) {
+      str_log("[Mesh.parse] Index {} out of range ({} vertices)"
+      , (index_t)reader->index_value, (index_t)reader->header.vert_count
+      );
+      return false;
+    }
+    reader->index_value = 0;
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool wmesh_reader_feed(wmesh_reader_t* reader, slice_t piece, bool last) {
+  assert(reader);
+  const uint64_t header_size = sizeof(wmesh_header_t);
+
+  // fill in the header first
+  if (reader->offset < header_size) {
+    uint64_t missing = header_size - reader->offset;
+    index_t n = (index_t)MIN((uint64_t)piece.size, missing);
+    memcpy((byte*)&reader->header + reader->offset, piece.begin, n);
+    reader->offset += n;
+    piece.begin += n;
+    piece.size -= n;
+
+    if (reader->offset == header_size && !_wmesh_reader_start(reader)) {
+      return false;
+    }
+  }
+
+  // then hand each block the part of it that's in this piece
+  if (piece.size > 0) {
+    uint64_t piece_end = reader->offset + piece.size;
+
+    for (int i = 0; i < WMESH_BLOCK_COUNT; ++i) {
+      wmesh_range_t range = _wmesh_block_range(&reader->header, i);
+      uint64_t begin = MAX(range.begin, reader->offset);
+      uint64_t end = MIN(range.end, piece_end);
+      if (begin >= end) continue;
+
+      slice_t bytes = {
+        .begin = piece.begin + (begin - reader->offset),
+        .size = (index_t)(end - begin),
+      };
+
+      if (i == WMESH_BLOCK_INDICES
+      &&  !_wmesh_reader_check_indices(reader, begin - range.begin, bytes)
+      ) {
+        return false;
+      }
+
+      if (reader->on_block && !reader->on_block(
+        reader->data, i, (index_t)(begin - range.begin), bytes
+      )) {
+        return false;
+      }
+    }
+
+    reader->offset = piece_end;
+  }
+
+  if (!last) return true;
+
+  uint64_t file_end = header_size;
+  for (int i = 0; i < WMESH_BLOCK_COUNT; ++i) {
+    file_end = MAX(file_end, _wmesh_block_range(&reader->header, i).end);
+  }
+
+  if (reader->offset < file_end) {
+    str_log("[Mesh.parse] Truncated ({} of {} bytes)"
+    , (index_t)reader->offset, (index_t)file_end
+    );
+    return false;
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void wmesh_bounds(Array verts, vec3* center, float* radius) {
+  assert(verts && verts->size > 0);
+  assert(center && radius);
+
+  const char* data = verts->begin;
+  index_t stride = verts->element_size;
+  vec3 lo = *(const vec3*)data;
+  vec3 hi = lo;
+
+  for (index_t i = 1; i < verts->size; ++i) {
+    const vec3* pos = (const vec3*)(data + i * stride);
+    lo = v3f(MIN(lo.x, pos->x), MIN(lo.y, pos->y), MIN(lo.z, pos->z));
+    hi = v3f(MAX(hi.x, pos->x), MAX(hi.y, pos->y), MAX(hi.z, pos->z));
+  }
+
+  vec3 c = v3scale(v3add(lo, hi), 0.5f);
+  float radius_sq = 0;
+
+  for (index_t i = 0; i < verts->size; ++i) {
+    vec3 d = v3sub(*(const vec3*)(data + i * stride), c);
+    radius_sq = MAX(radius_sq, v3dot(d, d));
+  }
+
+  *center = c;
+  *radius = sqrtf(radius_sq);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __WASM__
+
+static uint32_t _wmesh_align(uint64_t offset) {
+  uint64_t mask = WMESH_ALIGNMENT - 1;
+  return (uint32_t)((offset + mask) & ~mask);
+}
+
+static bool _wmesh_write_at(
+  FILE* f, uint32_t offset, const void* src, size_t n
+) {
+  if (fseek(f, offset, SEEK_SET) != 0) return false;
+  return n == 0 || fwrite(src, 1, n, f) == n;
+}
+
+bool wmesh_write(slice_t filename, const model_obj_t* obj) {
+  assert(obj);
+  assert(obj->verts && obj->indices);
+
+  slice_t name = obj->name ? obj->name->slice : slice_empty;
+
+  wmesh_header_t header = {
+    .magic = WMESH_MAGIC,
+    .version = WMESH_VERSION,
+    .format = obj->format,
+    .vert_count = (uint32_t)obj->verts->size,
+    .index_count = (uint32_t)obj->indices->size,
+    .name_size = (uint32_t)name.size,
+  };
+
+  header.vert_offset = _wmesh_align(sizeof(header));
+  header.index_offset = _wmesh_align(
+    header.vert_offset + (uint64_t)obj->verts->size_bytes
+  );
+  header.name_offset = _wmesh_align(
+    header.index_offset + (uint64_t)obj->indices->size_bytes
+  );
+
+  wmesh_bounds(obj->verts, &header.bounds_center, &header.bounds_radius);
+
+  String path = str_copy(filename);
+  FILE* f = fopen(path->begin, "wb");
+  str_delete(&path);
+
+  if (!f) {
+    str_log("[Mesh.write] Could not open file for writing: {}", filename);
+    return false;
+  }
+
+  bool success
+    =  _wmesh_write_at(f, 0, &header, sizeof(header))
+    && _wmesh_write_at(f, header.vert_offset
+      , obj->verts->begin, obj->verts->size_bytes)
+    && _wmesh_write_at(f, header.index_offset
+      , obj->indices->begin, obj->indices->size_bytes)
+    && _wmesh_write_at(f, header.name_offset, name.begin, name.size);
+
+  success = fclose(f) == 0 && success;
+
+  if (!success) {
+    str_log("[Mesh.write] Failed writing file: {}", filename);
+  }
+
+  return success;
+}
+
+#else
+
+bool wmesh_write(slice_t filename, const model_obj_t* obj) {
+  UNUSED(filename);
+  UNUSED(obj);
+  assert(false);
+  return false;
+}
+
+#endif
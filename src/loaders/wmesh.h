@@ -0,0 +1,120 @@
+/*******************************************************************************
+* MIT License
+*
+* Copyright (c) 2026 Curtis McCoy
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#ifndef WASP_LOADER_WMESH_H_
+#define WASP_LOADER_WMESH_H_
+
+// Compact binary mesh format (.wmesh) produced offline by the mesh_convert
+//    tool. Vertices are already deduplicated and carry their tangents, so the
+//    blocks can be handed straight to the GPU, either from a loaded file
+//    buffer or piece by piece while the file is streamed in.
+//
+// Layout (little-endian): header, then vertex, index and name blocks at the
+//    offsets given in the header, each aligned to WMESH_ALIGNMENT bytes.
+
+#include "array.h"
+#include "slice.h"
+#include "vertex.h"
+#include "obj.h"
+
+#include <stdint.h>
+
+#define WMESH_MAGIC     0x48534D57 // "WMSH"
+#define WMESH_VERSION   1
+#define WMESH_ALIGNMENT 16
+
+typedef struct wmesh_header_t {
+  uint32_t  magic;
+  uint32_t  version;
+  uint32_t  format;         // vertex_format_t of the vertex block
+  uint32_t  vert_count;
+  uint32_t  index_count;    // 32-bit indices, three per triangle
+  uint32_t  name_size;      // bytes, not null-terminated
+  uint32_t  vert_offset;
+  uint32_t  index_offset;
+  uint32_t  name_offset;
+  vec3      bounds_center;
+  float     bounds_radius;
+} wmesh_header_t;
+
+// A parsed view into a .wmesh buffer, all pointers point into that buffer
+typedef struct wmesh_t {
+  const wmesh_header_t* header;
+  slice_t               name;
+  const void*           verts;
+  index_t               verts_size;
+  const uint*           indices;
+  index_t               indices_size;
+} wmesh_t;
+
+// Blocks of a .wmesh as handed to a wmesh_reader_t's consumer
+typedef enum wmesh_block_t {
+  WMESH_BLOCK_VERTS,
+  WMESH_BLOCK_INDICES,
+  WMESH_BLOCK_NAME,
+  WMESH_BLOCK_COUNT
+} wmesh_block_t;
+
+// Return false from either to stop reading
+typedef bool (*wmesh_header_fn_t)(void* data, const wmesh_header_t* header);
+typedef bool (*wmesh_block_fn_t)(
+  void* data, wmesh_block_t block, index_t offset, slice_t bytes
+);
+
+// Reads a .wmesh that arrives in pieces, like the chunks of file_new_stream,
+//    without ever holding the whole file. The header is validated as soon as
+//    it's complete, then each block is passed on as it arrives, split
+//    wherever the pieces were. Indices are range checked on the way through.
+typedef struct wmesh_reader_t {
+  wmesh_header_fn_t on_header;
+  wmesh_block_fn_t  on_block;
+  void*             data;
+
+  // Progress, zero to start
+  wmesh_header_t    header;
+  uint64_t          offset;       // bytes of the file consumed so far
+  uint32_t          index_value;  // index being assembled across pieces
+} wmesh_reader_t;
+
+// \brief Checks whether the data starts with the .wmesh magic number
+bool wmesh_is_binary(slice_t data);
+
+// \brief Validates the header and block ranges and fills `out` with views into
+//    `data`. Nothing is copied.
+bool wmesh_parse(slice_t data, wmesh_t* out);
+
+// \brief Feeds the next piece of the file to the reader.
+// \param last Set with the final piece, so a truncated file is caught.
+// \returns false if the file is invalid or a consumer stopped reading, after
+//    which the reader must not be fed again.
+bool wmesh_reader_feed(wmesh_reader_t* reader, slice_t piece, bool last);
+
+// \brief Fits a bounding sphere around the center of the vertices' AABB. Every
+//    mesh vertex format begins with its vec3 position.
+void wmesh_bounds(Array verts, vec3* center, float* radius);
+
+// \brief Writes a parsed OBJ to a .wmesh file (native only)
+bool wmesh_write(slice_t filename, const model_obj_t* obj);
+
+#endif
@@ -0,0 +1,258 @@
+/*******************************************************************************
+* MIT License
+*
+* Copyright (c) 2026 Curtis McCoy
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "wpack.h"
+#include "str.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef __WASM__
+# include <stdio.h>
+#endif
+
+static_assert(sizeof(wpack_header_t) == 32, "Unexpected wpack header size");
+static_assert(sizeof(wpack_entry_t) == 24, "Unexpected wpack entry size");
+
+////////////////////////////////////////////////////////////////////////////////
+
+slice_t wpack_normalize(slice_t name) {
+  while (name.size >= 2 && name.begin[0] == '.' && name.begin[1] == '/') {
+    name.begin += 2;
+    name.size -= 2;
+  }
+  return name;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static int _wpack_compare(slice_t a, slice_t b) {
+  int result = memcmp(a.begin, b.begin, MIN(a.size, b.size));
+  if (result) return result;
+  return (a.size > b.size) - (a.size < b.size);
+}
+
+static slice_t _wpack_name(const wpack_t* pack, const wpack_entry_t* entry) {
+  return (slice_t) {
+    .begin = pack->names + entry->name_offset,
+    .size = entry->name_size,
+  };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool wpack_parse(slice_t data, wpack_t* out) {
+  assert(out);
+
+  if (data.size < (index_t)sizeof(wpack_header_t)) return false;
+
+  wpack_header_t header;
+  memcpy(&header, data.begin, sizeof(header));
+
+  if (header.magic != WPACK_MAGIC) return false;
+
+  if (header.version != WPACK_VERSION) {
+    str_log("[Pack.parse] Unsupported version: {}", (int)header.version);
+    return false;
+  }
+
+  uint64_t size = (uint64_t)data.size;
+  uint64_t index_size = (uint64_t)header.entry_count * sizeof(wpack_entry_t);
+
+  // Offsets come from the file, so compare by subtracting to avoid wrapping
+  if (header.index_offset % sizeof(uint64_t) != 0
+  ||  index_size > size || header.index_offset > size - index_size
+  ||  header.names_size > size || header.names_offset > size - header.names_size
+  ) {
+    str_write("[Pack.parse] Index out of range, file is truncated or corrupt");
+    return false;
+  }
+
+  *out = (wpack_t) {
+    .data = data,
+    .entries = (const wpack_entry_t*)(data.begin + header.index_offset),
+    .entry_count = header.entry_count,
+    .names = data.begin + header.names_offset,
+  };
+
+  for (index_t i = 0; i < out->entry_count; ++i) {
+    const wpack_entry_t* entry = &out->entries[i];
+
+    if (entry->size > size || entry->offset > size - entry->size
+    ||  (uint64_t)entry->name_offset + entry->name_size > header.names_size
+    ) {
+      str_log("[Pack.parse] Entry {} out of range", i);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool wpack_find(const wpack_t* pack, slice_t name, slice_t* out) {
+  assert(pack);
+  assert(out);
+
+  name = wpack_normalize(name);
+  index_t lo = 0;
+  index_t hi = pack->entry_count;
+
+  while (lo < hi) {
+    index_t mid = lo + (hi - lo) / 2;
+    const wpack_entry_t* entry = &pack->entries[mid];
+    int order = _wpack_compare(_wpack_name(pack, entry), name);
+
+    if (order == 0) {
+      *out = (slice_t) {
+        .begin = pack->data.begin + entry->offset,
+        .size = (index_t)entry->size,
+      };
+      return true;
+    }
+
+    if (order < 0) lo = mid + 1;
+    else hi = mid;
+  }
+
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Writing packs
+////////////////////////////////////////////////////////////////////////////////
+
+#ifdef __WASM__
+
+bool wpack_write(slice_t filename, wpack_file_t* files, index_t count) {
+  UNUSED(filename);
+  UNUSED(files);
+  UNUSED(count);
+  assert(false);
+  return false;
+}
+
+#else
+
+static int _wpack_file_order(const void* a, const void* b) {
+  return _wpack_compare(
+    ((const wpack_file_t*)a)->name, ((const wpack_file_t*)b)->name
+  );
+}
+
+static bool _wpack_pad(FILE* file, uint64_t alignment) {
+  static const byte padding[WPACK_ALIGNMENT] = { 0 };
+  long position = ftell(file);
+  if (position < 0) return false;
+
+  size_t pad = (size_t)((alignment - position % alignment) % alignment);
+  return fwrite(padding, 1, pad, file) == pad;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool wpack_write(slice_t filename, wpack_file_t* files, index_t count) {
+  assert(files || count == 0);
+
+  for (index_t i = 0; i < count; ++i) {
+    files[i].name = wpack_normalize(files[i].name);
+  }
+
+  qsort(files, count, sizeof(wpack_file_t), _wpack_file_order);
+
+  for (index_t i = 1; i < count; ++i) {
+    if (!_wpack_compare(files[i - 1].name, files[i].name)) {
+      str_log("[Pack.write] Duplicate file: {}", files[i].name);
+      return false;
+    }
+  }
+
+  wpack_entry_t* index = calloc(MAX(count, 1), sizeof(wpack_entry_t));
+  assert(index);
+
+  String file_str = str_copy(filename);
+  FILE* file = fopen(file_str->begin, "wb");
+  str_delete(&file_str);
+
+  if (!file) {
+    str_log("[Pack.write] Failed to open file: {}", filename);
+    free(index);
+    return false;
+  }
+
+  // The header is written again at the end once the offsets are known
+  wpack_header_t header = {
+    .magic = WPACK_MAGIC,
+    .version = WPACK_VERSION,
+    .entry_count = (uint32_t)count,
+  };
+
+  bool success = fwrite(&header, sizeof(header), 1, file) == 1;
+  uint32_t name_offset = 0;
+
+  for (index_t i = 0; success && i < count; ++i) {
+    success = _wpack_pad(file, WPACK_ALIGNMENT);
+
+    index[i] = (wpack_entry_t) {
+      .offset = (uint64_t)ftell(file),
+      .size = (uint64_t)files[i].data.size,
+      .name_offset = name_offset,
+      .name_size = (uint32_t)files[i].name.size,
+    };
+    name_offset += (uint32_t)files[i].name.size;
+
+    success = success && fwrite(
+      files[i].data.begin, 1, files[i].data.size, file
+    ) == (size_t)files[i].data.size;
+  }
+
+  success = success && _wpack_pad(file, WPACK_ALIGNMENT);
+  header.index_offset = (uint64_t)ftell(file);
+  success = success
+    && fwrite(index, sizeof(wpack_entry_t), count, file) == (size_t)count;
+
+  header.names_offset = (uint64_t)ftell(file);
+  header.names_size = name_offset;
+
+  for (index_t i = 0; success && i < count; ++i) {
+    success = fwrite(files[i].name.begin, 1, files[i].name.size, file)
+      == (size_t)files[i].name.size;
+  }
+
+  success = success
+    && fseek(file, 0, SEEK_SET) == 0
+    && fwrite(&header, sizeof(header), 1, file) == 1;
+
+  fclose(file);
+  free(index);
+
+  if (!success) {
+    str_log("[Pack.write] Failed writing file: {}", filename);
+  }
+
+  return success;
+}
+
+#endif
@@ -0,0 +1,91 @@
+/*******************************************************************************
+* MIT License
+*
+* Copyright (c) 2026 Curtis McCoy
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#ifndef WASP_LOADER_WPACK_H_
+#define WASP_LOADER_WPACK_H_
+
+// Asset pack format (.wpak) built offline by the pack_build tool. A pack is a
+//    single file holding many assets, so they can be mapped or fetched at once
+//    instead of being opened one by one.
+//
+// Layout (little-endian): header, then the file blobs each aligned to
+//    WPACK_ALIGNMENT bytes, then the index sorted by name, then the names.
+//    Names are stored relative to the working directory without a leading
+//    "./", and lookups normalize the requested name the same way.
+
+#include "types.h"
+#include "slice.h"
+
+#include <stdint.h>
+
+#define WPACK_MAGIC     0x4B415057 // "WPAK"
+#define WPACK_VERSION   1
+#define WPACK_ALIGNMENT 16
+
+typedef struct wpack_header_t {
+  uint32_t  magic;
+  uint32_t  version;
+  uint32_t  entry_count;
+  uint32_t  names_size;
+  uint64_t  index_offset;
+  uint64_t  names_offset;
+} wpack_header_t;
+
+typedef struct wpack_entry_t {
+  uint64_t  offset;
+  uint64_t  size;
+  uint32_t  name_offset;    // into the names block, not null-terminated
+  uint32_t  name_size;
+} wpack_entry_t;
+
+// A parsed view into a .wpak buffer, all pointers point into that buffer
+typedef struct wpack_t {
+  slice_t               data;
+  const wpack_entry_t*  entries;
+  index_t               entry_count;
+  const char*           names;
+} wpack_t;
+
+// A file to be written into a pack
+typedef struct wpack_file_t {
+  slice_t   name;
+  slice_t   data;
+} wpack_file_t;
+
+// \brief Validates the header, index and every entry's range, and fills `out`
+//    with views into `data`. Nothing is copied.
+bool    wpack_parse(slice_t data, wpack_t* out);
+
+// \brief Binary searches the pack's index for a file.
+// \param out Set to the file's contents within the pack data when found.
+bool    wpack_find(const wpack_t* pack, slice_t name, slice_t* out);
+
+// \brief Strips any leading "./" so names match how they're stored.
+slice_t wpack_normalize(slice_t name);
+
+// \brief Writes a pack with the given files, sorting them by name in place
+//    (native only).
+bool    wpack_write(slice_t filename, wpack_file_t* files, index_t count);
+
+#endif
@@ -27,6 +27,8 @@
 
 #include "str.h"
 #include "map.h"
+#include "file.h"
+#include "asset.h"
 
 #include <stdlib.h>
 
@@ -41,6 +43,8 @@ typedef struct mat_images_t {
       Image metalness;
     };
   };
+  // .ktx2 maps are loaded as files and uploaded without decoding
+  File files[MAT_MAP_COUNT];
 } mat_images_t;
 
 typedef struct Material_Internal {
@@ -50,6 +54,8 @@ typedef struct Material_Internal {
   String  name_internal;
   slice_t ext;
   mat_images_t* img; // TODO: replace with dynamic Array
+  bool          prioritized;
+  bool          ktx2;
 //Image img_emissive; ?
 } Material_Internal;
 
@@ -66,6 +72,50 @@ typedef struct Material_Internal {
 static HMap_material  _all_materials_map = NULL;
 static index_t        _materials_built_count = 0;
 
+// Name list handed out by mat_get_names, rebuilt after materials are added
+static Array_slice    _material_names = NULL;
+static bool           _material_names_stale = true;
+
+////////////////////////////////////////////////////////////////////////////////
+// Images shared through the asset cache
+////////////////////////////////////////////////////////////////////////////////
+
+static void _mat_image_free(void* img) {
+  img_delete((Image*)&img);
+}
+
+// A file used by several materials (or as both a map and an atlas layer) is
+//    only decoded once, and freed when the last material built from it is done.
+//    Atlas images are repacked in place when built, so those aren't shared.
+static Image _mat_image_acquire(Material_Internal* m, String filename) {
+  if (m->pub.params.atlas_dimensions.x != 1) return img_new_str(filename);
+
+  Image img = asset_get(ASSET_IMAGE, filename->slice);
+
+  if (img) {
+    str_delete(&filename);
+  }
+  else {
+    img = img_new_str(filename);
+    asset_insert(ASSET_IMAGE, img->filename, img, _mat_image_free);
+  }
+
+  asset_retain(ASSET_IMAGE, img->filename);
+  return img;
+}
+
+static void _mat_image_release(Image* img) {
+  assert(img && *img);
+
+  if (asset_get(ASSET_IMAGE, (*img)->filename) != *img) {
+    img_delete(img);
+    return;
+  }
+
+  asset_release(ASSET_IMAGE, (*img)->filename);
+  *img = NULL;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Helpers for handling each stage of loading and building a material
 ////////////////////////////////////////////////////////////////////////////////
@@ -110,15 +160,68 @@ Material_Internal* _mat_new(slice_t filename, mat_params_t params) {
     .name_internal = filename_copy,
     .ext = ext,
     .img = NULL,
+    .ktx2 = slice_eq(ext, S("ktx2")),
   };
 
   map_material_insert(_all_materials_map, name, ret);
+  _material_names_stale = true;
 
   return ret;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// Compressed textures can't be converted at runtime, so each map is expected
+//    to be stored once per compression family, with the family added to the
+//    file name ("test_n.bc.ktx2", "test_n.astc.ktx2"...), and the best one the
+//    context supports is loaded. Without any compressed formats, the raw maps
+//    baked by tools/asset_bake.c ("test_n.raw.ktx2") are loaded instead. A
+//    family given in the material name is used as-is.
+static void _mat_load_ktx2(Material_Internal* m, view_slice_t filenames) {
+  static const char* suffix[MAT_MAP_COUNT] = { "", "_n", "_r", "_m" };
+
+  // A material with no files to load builds with the default maps
+  m->img = malloc(sizeof(mat_images_t));
+  assert(m->img);
+  *m->img = (mat_images_t){ 0 };
+  m->pub.status = S_LOADING;
+
+  if (view_slice_size(filenames) != 1) {
+    str_log("[Material.load] KTX2 materials need a single file: {}"
+    , m->pub.name
+    );
+    return;
+  }
+
+  slice_t base = slice_until(*filenames.begin, S("."));
+  slice_t family = { .begin = base.begin + base.size, .size = 0 };
+  if (base.size < filenames.begin->size) {
+    family.begin += 1;
+    family.size = filenames.begin->size - base.size - 1;
+  }
+
+  if (family.size == 0) {
+    switch (tex_compression_preferred()) {
+      case TEX_COMPRESSION_BC:    family = S("bc");   break;
+      case TEX_COMPRESSION_ETC2:  family = S("etc2"); break;
+      case TEX_COMPRESSION_ASTC:  family = S("astc"); break;
+      default:                    family = S("raw");  break;
+    }
+  }
+
+  for (index_t i = 0; i < MAT_MAP_COUNT; ++i) {
+    if (!m->pub.params.use_map[i]) continue;
+
+    String file = str_format("./res/textures/{}{}.{}.{}"
+    , base, slice_from_c_str(suffix[i]), family, m->ext
+    );
+    m->img->files[i] = file_new(file->slice, FM_READ);
+    str_delete(&file);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void _mat_load_async(Material_Internal* m, view_slice_t filenames) {
   assert(m);
   assert(filenames.end > filenames.begin);
@@ -140,6 +243,11 @@ void _mat_load_async(Material_Internal* m, view_slice_t filenames) {
 
   assert(m->pub.layers > 0);
 
+  if (m->ktx2) {
+    _mat_load_ktx2(m, filenames);
+    return;
+  }
+
   mat_images_t** img = &m->img;
 
   const slice_t* view_foreach(filename, filenames) {
@@ -149,22 +257,22 @@ void _mat_load_async(Material_Internal* m, view_slice_t filenames) {
 
     if (m->pub.params.use_diffuse_map) {
       String file = str_format("./res/textures/{}.{}", filename, m->ext);
-      (*img)->diffuse = img_new_str(file);
+      (*img)->diffuse = _mat_image_acquire(m, file);
     }
 
     if (m->pub.params.use_normal_map) {
       String file = str_format("./res/textures/{}_n.{}", filename, m->ext);
-      (*img)->normals = img_new_str(file);
+      (*img)->normals = _mat_image_acquire(m, file);
     }
 
     if (m->pub.params.use_roughness_map) {
       String file = str_format("./res/textures/{}_r.{}", filename, m->ext);
-      (*img)->roughness = img_new_str(file);
+      (*img)->roughness = _mat_image_acquire(m, file);
     }
 
     if (m->pub.params.use_metalness_map) {
       String file = str_format("./res/textures/{}_m.{}", filename, m->ext);
-      (*img)->metalness = img_new_str(file);
+      (*img)->metalness = _mat_image_acquire(m, file);
     }
 
     (*img)->next = NULL;
@@ -184,6 +292,18 @@ void _mat_load_check(Material_Internal* m) {
   assert(m->img);
 
   mat_images_t* img = m->img;
+
+  if (m->ktx2) {
+    for (index_t i = 0; i < MAT_MAP_COUNT; ++i) {
+      File file = img->files[i];
+      if (file && (file->status == S_NEW || file->status == S_LOADING)) {
+        return;
+      }
+    }
+    m->pub.status = S_BUILDING;
+    return;
+  }
+
   while (img) {
     for (index_t i = 0; i < MAT_MAP_COUNT; ++i) {
       if (m->pub.params.use_map[i] && img->images[i]->status != S_READY) {
@@ -198,6 +318,31 @@ void _mat_load_check(Material_Internal* m) {
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// Missing or unsupported maps are left empty and get the default texture
+static void _mat_build_ktx2(Material_Internal* m) {
+  mat_images_t* img = m->img;
+
+  for (index_t i = 0; i < MAT_MAP_COUNT; ++i) {
+    if (!img->files[i]) continue;
+
+    if (img->files[i]->status == S_READY) {
+      m->pub.maps[i] = tex_from_ktx2(img->files[i]->name, img->files[i]->slice);
+    }
+    else {
+      str_log("[Material.build] Failed to load: {}", img->files[i]->name);
+    }
+
+    file_delete(&img->files[i]);
+  }
+
+  // array layers come from the file rather than an atlas grid
+  if (m->pub.map_diffuse) {
+    m->pub.layers = m->pub.map_diffuse->layers;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void _mat_build_check(Material_Internal* m) {
   assert(m);
   assert(m->img);
@@ -211,14 +356,18 @@ void _mat_build_check(Material_Internal* m) {
 
   mat_images_t* img = m->img;
 
-  if (!img->next) {
+  if (m->ktx2) {
+    _mat_build_ktx2(m);
+  }
+
+  else if (!img->next) {
     assert(m->pub.layers == dim.w * dim.h);
 
     for (int i = 0; i < MAT_MAP_COUNT; ++i) {
       if (img->images[i]) {
         assert(img->images[i]->status == S_READY);
         m->pub.maps[i] = tex_from_image_atlas(img->images[i], dim);
-        img_delete(&img->images[i]);
+        _mat_image_release(&img->images[i]);
       }
     }
   }
@@ -268,23 +417,19 @@ void _mat_build_check(Material_Internal* m) {
     }
     assert(!img);
 
-    //// Cleanup all those images we loaded
-    //img = m->img;
-    //while (img) {
-    //  for (int i = 0; i < MAT_MAP_COUNT; ++i) {
-    //    if (img->images[i]) img_delete(&img->images[i]);
-    //  }
-    //
-    //  mat_images_t* prev = img;
-    //  img = img->next;
-    //  free(prev);
-    //}
+    // Hand the layer images back to the cache now that they're uploaded
+    for (img = m->img; img; img = img->next) {
+      for (int i = 0; i < MAT_MAP_COUNT; ++i) {
+        if (img->images[i]) _mat_image_release(&img->images[i]);
+      }
+    }
   }
 
   // Set up default maps for unused material attributes
   for (int i = 0; i < MAT_MAP_COUNT; ++i) {
     if (m->pub.maps[i]) {
-      tex_generate_mips(m->pub.maps[i]);
+      // KTX2 maps already come with whatever mips they're going to have
+      if (!m->ktx2) tex_generate_mips(m->pub.maps[i]);
     }
     else {
       if (&m->pub.maps[i] == &m->pub.map_normals)
@@ -362,6 +507,20 @@ void mat_loading_manager(void) {
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void mat_prioritize(Material m_in) {
+  MATERIAL_INTERNAL;
+  if (m->pub.status != S_LOADING || m->prioritized) return;
+  m->prioritized = true;
+
+  for (mat_images_t* img = m->img; img; img = img->next) {
+    for (index_t i = 0; i < MAT_MAP_COUNT; ++i) {
+      if (img->images[i]) img_set_priority(img->images[i], IMG_PRIORITY_HIGH);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 index_t mat_loading_count(void) {
   index_t ret = _all_materials_map->size - _materials_built_count;
   assert(ret >= 0);
@@ -379,11 +538,18 @@ Material mat_get(slice_t name) {
 
 ////////////////////////////////////////////////////////////////////////////////
 
-Array_slice mat_get_names(void) {
-  if (!_all_materials_map) return NULL;
-  Array_slice ret = arr_slice_new_reserve(_all_materials_map->size);
-  Material_Internal** map_foreach(pm, _all_materials_map) {
-    arr_slice_push_back(ret, (*pm)->pub.name);
+view_slice_t mat_get_names(void) {
+  if (!_all_materials_map) return (view_slice_t) { 0 };
+
+  if (_material_names_stale) {
+    _material_names_stale = false;
+    if (_material_names) arr_slice_delete(&_material_names);
+
+    _material_names = arr_slice_new_reserve(_all_materials_map->size);
+    Material_Internal** map_foreach(pm, _all_materials_map) {
+      arr_slice_push_back(_material_names, (*pm)->pub.name);
+    }
   }
-  return ret;
+
+  return view_slice(_material_names->begin, _material_names->size);
 }
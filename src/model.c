@@ -23,16 +23,33 @@
 */
 
 #include "model.h"
+#include "asset.h"
 
 #include "gl.h"
 
 #include "array.h"
 #include "str.h"
 
+#define con_type Model
+#define con_prefix model
+#include "map.h"
+#undef con_prefix
+#undef con_type
+
 static array_t _new_models_array = {
   .element_size = sizeof(Model)
 };
 static Array _loaded_models = NULL;
+static HMap_model _loaded_models_map = NULL;
+
+// Name lists handed out by model_get_names*, rebuilt after models finish
+static Array_slice _model_names = NULL;
+static Array_slice _model_names_inst = NULL;
+static bool _model_names_stale = true;
+
+// Bytes of mesh data uploaded per call to model_loading_manager
+#define MODEL_UPLOAD_BUDGET_DEFAULT (4 << 20)
+static index_t _model_upload_budget = MODEL_UPLOAD_BUDGET_DEFAULT;
 
 Array _new_models = &_new_models_array;
 
@@ -67,10 +84,11 @@ static void _model_render_instanced(const Model model, index_t count) {
 // Function routing based on object types
 ////////////////////////////////////////////////////////////////////////////////
 
-typedef void (model_build_fn_t)(Model model);
+typedef void (model_build_fn_t)(Model model, index_t* upload_budget);
 typedef void (model_bind_fn_t)(const Model model);
 typedef void (model_render_fn_t)(Model model);
 typedef void (model_render_inst_fn_t)(const Model model, index_t count);
+typedef void (model_delete_fn_t)(Model model);
 
 // Internal model binding and render functions defined in ./models directory
 extern model_build_fn_t       _model_build_mesh;
@@ -83,12 +101,14 @@ extern model_render_fn_t      _model_render_prim_strip;
 extern model_render_inst_fn_t _model_render_prim_strip_inst;
 extern model_render_fn_t      _model_render_sprites;
 extern model_render_fn_t      _model_render_mesh;
+extern model_delete_fn_t      _model_delete_mesh;
 
 typedef struct model_management_fns_t {
   model_build_fn_t*       build;
   model_bind_fn_t*        bind;
   model_render_fn_t*      render_single;
   model_render_inst_fn_t* render_inst;
+  model_delete_fn_t*      delete;
 } model_management_fns_t;
 
 static model_management_fns_t model_management_fns[MODEL_TYPES_COUNT] = {
@@ -130,6 +150,7 @@ static model_management_fns_t model_management_fns[MODEL_TYPES_COUNT] = {
   , .bind           = _model_bind_mesh
   , .render_single  = _model_render_mesh
   , .render_inst    = _model_render_instanced
+  , .delete         = _model_delete_mesh
   }
 };
 
@@ -230,8 +251,74 @@ void model_render_instanced(const Model model, index_t count) {
 
 ////////////////////////////////////////////////////////////////////////////////
 
+bool model_can_render_indirect(const Model model) {
+#ifdef __WASM__
+  UNUSED(model);
+  return false;
+#else
+  if (!model || model->status != S_READY) return false;
+  if (model->type <= 0 || model->type >= MODEL_TYPES_COUNT) return false;
+  return model_management_fns[model->type].render_inst
+      == _model_render_instanced;
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+model_draw_cmd_t model_draw_cmd(
+  const Model model, index_t base, index_t count
+) {
+  assert(model);
+
+  if (model->index_count) {
+    return (model_draw_cmd_t) {
+      .count = (uint)model->index_count,
+      .instance_count = (uint)count,
+      .base_instance = (uint)base,
+    };
+  }
+
+  return (model_draw_cmd_t) {
+    .count = (uint)model->vert_count,
+    .instance_count = (uint)count,
+    .base_vertex = (uint)base,
+  };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void model_render_indirect(const Model model, index_t draw_count) {
+  assert(model_can_render_indirect(model));
+  if (draw_count <= 0) return;
+
+#ifndef __WASM__
+  GLsizei stride = sizeof(model_draw_cmd_t);
+
+  if (model->index_count) {
+    glMultiDrawElementsIndirect(
+      GL_TRIANGLES, GL_UNSIGNED_INT, NULL, (GLsizei)draw_count, stride
+    );
+  }
+  else {
+    glMultiDrawArraysIndirect(GL_TRIANGLES, NULL, (GLsizei)draw_count, stride);
+  }
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void model_set_upload_budget(index_t bytes) {
+  _model_upload_budget = bytes;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void model_loading_manager(void) {
   if (!_loaded_models) _loaded_models = arr_new(Model);
+  if (!_loaded_models_map) _loaded_models_map = map_model_new();
+
+  index_t budget = _model_upload_budget;
+  index_t* upload_budget = budget > 0 ? &budget : NULL;
 
   for (index_t i = 0; i < _new_models->size;) {
     Model model = (((Model*)_new_models->begin)[i]);
@@ -241,12 +328,20 @@ void model_loading_manager(void) {
     if (model->status != S_READY) {
       model_build_fn_t* build_fn = model_management_fns[model->type].build;
       assert(build_fn);
-      build_fn(model);
+      build_fn(model, upload_budget);
     }
 
     if (model->status == S_READY) {
       arr_insert_back(_loaded_models, &model);
       arr_remove_unstable(_new_models, i);
+      _model_names_stale = true;
+
+      // The first model loaded under a name keeps it
+      if (!slice_is_empty(model->name)
+      &&  !map_model_get_or_default(_loaded_models_map, model->name, NULL)
+      ) {
+        map_model_insert(_loaded_models_map, model->name, model);
+      }
     }
     else {
       ++i;
@@ -256,38 +351,98 @@ void model_loading_manager(void) {
 
 ////////////////////////////////////////////////////////////////////////////////
 
-Model model_get(slice_t name) {
-  if (!_loaded_models) return NULL;
-  Model* arr_foreach(pm, _loaded_models) {
-    if (slice_eq(name, (*pm)->name)) {
-      return *pm;
-    }
+static bool _model_list_remove(Array models, Model model) {
+  if (!models) return false;
+
+  for (index_t i = 0; i < models->size; ++i) {
+    if (((Model*)models->begin)[i] != model) continue;
+    arr_remove_unstable(models, i);
+    return true;
   }
-  return NULL;
+
+  return false;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-Array_slice model_get_names(void) {
-  if (!_loaded_models) return NULL;
-  Array_slice ret = arr_slice_new_reserve(_loaded_models->size);
-  Model* arr_foreach(pm, _loaded_models) {
-    arr_slice_push_back(ret, (*pm)->name);
+void model_delete(Model* model) {
+  if (!model || !*model) return;
+  Model m = *model;
+  assert(m->type >= 0 && m->type < MODEL_TYPES_COUNT);
+
+  model_delete_fn_t* delete_fn = model_management_fns[m->type].delete;
+  if (!delete_fn) {
+    str_log("[Model.delete] Can't delete models of type: {}", (int)m->type);
+    return;
   }
-  return ret;
+
+  if (!_model_list_remove(_new_models, m)) {
+    _model_list_remove(_loaded_models, m);
+    _model_names_stale = true;
+  }
+
+  // The name goes to the next loaded model that shares it, if there is one
+  if (_loaded_models_map && !slice_is_empty(m->name)
+  &&  map_model_get_or_default(_loaded_models_map, m->name, NULL) == m
+  ) {
+    map_model_remove(_loaded_models_map, m->name);
+
+    Model* arr_foreach(pm, _loaded_models) {
+      if (!slice_eq((*pm)->name, m->name)) continue;
+      map_model_insert(_loaded_models_map, (*pm)->name, *pm);
+      break;
+    }
+  }
+
+  // Loaded meshes are registered by path, which would otherwise keep handing
+  //    out the deleted model
+  asset_forget(ASSET_MODEL, m);
+
+  delete_fn(m);
+  *model = NULL;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-Array_slice model_get_names_inst(void) {
-  if (!_loaded_models) return NULL;
-  Array_slice ret = arr_slice_new_reserve(_loaded_models->size);
+Model model_get(slice_t name) {
+  if (!_loaded_models_map) return NULL;
+  return map_model_get_or_default(_loaded_models_map, name, NULL);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void _model_names_rebuild(void) {
+  if (!_model_names_stale) return;
+  _model_names_stale = false;
+
+  if (_model_names) arr_slice_delete(&_model_names);
+  if (_model_names_inst) arr_slice_delete(&_model_names_inst);
+
+  _model_names = arr_slice_new_reserve(_loaded_models->size);
+  _model_names_inst = arr_slice_new_reserve(_loaded_models->size);
+
   Model* arr_foreach(pm, _loaded_models) {
+    arr_slice_push_back(_model_names, (*pm)->name);
     if (model_management_fns[(*pm)->type].render_inst != NULL) {
-      arr_slice_push_back(ret, (*pm)->name);
+      arr_slice_push_back(_model_names_inst, (*pm)->name);
     }
   }
-  return ret;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+view_slice_t model_get_names(void) {
+  if (!_loaded_models) return (view_slice_t) { 0 };
+  _model_names_rebuild();
+  return view_slice(_model_names->begin, _model_names->size);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+view_slice_t model_get_names_inst(void) {
+  if (!_loaded_models) return (view_slice_t) { 0 };
+  _model_names_rebuild();
+  return view_slice(_model_names_inst->begin, _model_names_inst->size);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
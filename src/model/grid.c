@@ -79,7 +79,7 @@ Model model_new_grid(model_grid_param_t param) {
   assert(grid->extent == param.extent);
 
   glGenVertexArrays(1, &grid->vao);
-  glBindVertexArray(grid->vao);
+  gl_bind_vertex_array(grid->vao);
 
   int ext = grid->extent;
   int gext = ext;
@@ -142,13 +142,13 @@ Model model_new_grid(model_grid_param_t param) {
 
   GLsizeiptr points_size = sizeof(*points) * grid->vert_count;
   glGenBuffers(2, grid->buffers);
-  glBindBuffer(GL_ARRAY_BUFFER, grid->vbo);
+  gl_bind_buffer(GL_ARRAY_BUFFER, grid->vbo);
   glBufferData(GL_ARRAY_BUFFER, points_size, points, GL_STATIC_DRAW);
   glEnableVertexAttribArray(0);
   glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
 
   GLsizeiptr colors_size = sizeof(*colors) * grid->vert_count;
-  glBindBuffer(GL_ARRAY_BUFFER, grid->colors);
+  gl_bind_buffer(GL_ARRAY_BUFFER, grid->colors);
   glBufferData(GL_ARRAY_BUFFER, colors_size, colors, GL_STATIC_DRAW);
   glEnableVertexAttribArray(4);
   glVertexAttribPointer(4, sizeof(*colors), GL_UNSIGNED_BYTE, GL_TRUE, 0, 0);
@@ -156,8 +156,8 @@ Model model_new_grid(model_grid_param_t param) {
   free(points);
   free(colors);
 
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-  glBindVertexArray(0);
+  gl_bind_buffer(GL_ARRAY_BUFFER, 0);
+  gl_bind_vertex_array(0);
 
   return (Model)grid;
 }
@@ -181,7 +181,7 @@ void _model_render_grid(Model model) {
   assert(grid->type == MODEL_GRID);
   assert(grid->status == S_READY);
   assert(grid->vao);
-  glBindVertexArray(grid->vao);
+  gl_bind_vertex_array(grid->vao);
   glDrawArrays(GL_LINES, 0, (GLsizei)grid->vert_count);
-  glBindVertexArray(0);
+  gl_bind_vertex_array(0);
 }
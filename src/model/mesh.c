@@ -26,6 +26,8 @@
 #include "model.h"
 
 #include "gl.h"
+#include "thread.h"
+#include "asset.h"
 
 #include <stdlib.h>
 
@@ -36,6 +38,7 @@ extern Array _new_models;
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "../loaders/obj.h"
+#include "../loaders/wmesh.h"
 
 typedef struct Model_Internal_Mesh {
   MODEL_PROPS;
@@ -45,6 +48,21 @@ typedef struct Model_Internal_Mesh {
   String name_internal;
   File file;
 
+  // CPU side build, filled in by a job thread while build_job is pending
+  model_obj_t obj;
+  job_counter_t build_job;
+
+  // .wmesh files are streamed into the GPU buffers as the file is read
+  wmesh_reader_t reader;
+  bool streamed;
+
+  // Staged data waiting to be uploaded, points into either obj or the file
+  const byte* upload_verts;
+  const byte* upload_indices;
+  index_t verts_size;
+  index_t indices_size;
+  index_t upload_offset;
+
   union {
     GLuint buffers[2];
     struct {
@@ -58,86 +76,413 @@ typedef struct Model_Internal_Mesh {
 
 ////////////////////////////////////////////////////////////////////////////////
 
-static void _model_build_from_string(Model model, slice_t text) {
-  Model_Internal_Mesh* mesh = (Model_Internal_Mesh*)model;
-  assert(mesh);
-  assert(mesh->type == MODEL_MESH);
+static void _model_mesh_bounds(Model_Internal_Mesh* mesh, Array verts) {
+  wmesh_bounds(verts, &mesh->bounds_center, &mesh->bounds_radius);
+}
 
-  if (mesh->status != S_BUILDING) return;
+////////////////////////////////////////////////////////////////////////////////
+// CPU side building
+////////////////////////////////////////////////////////////////////////////////
+
+// Runs on a job thread, so it only reads the file and writes the obj result
+static void _model_parse_job(void* data) {
+  Model_Internal_Mesh* mesh = data;
+  mesh->obj = file_load_obj(mesh->file->slice);
+}
+
+////////////////////////////////////////////////////////////////////////////////
 
-  model_obj_t obj = file_load_obj(text);
+static bool _model_stage_obj(Model_Internal_Mesh* mesh) {
+  model_obj_t* obj = &mesh->obj;
 
-  if (!obj.verts || !obj.verts->size) {
-    assert(0);
-    mesh->status = S_ERROR;
-    goto new_obj_cleanup;
+  if (!obj->verts || !obj->verts->size) {
+    if (mesh->file) {
+      str_log("[Model.build] No vertices in OBJ: {}", mesh->file->name);
+    } else {
+      str_log("[Model.build] No vertices in OBJ");
+    }
+    return false;
   }
 
-  if (obj.name == NULL) {
+  if (obj->name == NULL) {
     if (mesh->file)
-      obj.name = str_copy(str_between_last(mesh->file->name, "/", "."));
+      obj->name = str_copy(str_between_last(mesh->file->name, "/", "."));
     else
-      obj.name = str_copy("OBJ_Model");
+      obj->name = str_copy("OBJ_Model");
   }
 
-  mesh->status = S_READY;
-  mesh->format = obj.format;
-  mesh->vert_count = obj.verts->size;
-  mesh->index_count = obj.indices->size;
-  mesh->name_internal = obj.name;
-  mesh->name = obj.name->slice;
+  mesh->format = obj->format;
+  mesh->vert_count = obj->verts->size;
+  mesh->index_count = obj->indices->size;
+  mesh->name_internal = obj->name;
+  mesh->name = obj->name->slice;
+  obj->name = NULL;
+  _model_mesh_bounds(mesh, obj->verts);
+
+  mesh->upload_verts = obj->verts->begin;
+  mesh->verts_size = obj->verts->size_bytes;
+  mesh->upload_indices = obj->indices->begin;
+  mesh->indices_size = obj->indices->size_bytes;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// A .wmesh is uploaded straight from the file buffer
+static bool _model_stage_binary(Model_Internal_Mesh* mesh) {
+  assert(mesh->file);
+
+  wmesh_t bin;
+  if (!wmesh_parse(mesh->file->slice, &bin)) {
+    str_log("[Model.build] Invalid binary mesh: {}", mesh->file->name);
+    return false;
+  }
+
+  if (bin.name.size > 0) {
+    mesh->name_internal = str_copy(bin.name);
+  }
+  else {
+    mesh->name_internal =
+      str_copy(str_between_last(mesh->file->name, "/", "."));
+  }
+
+  mesh->format = bin.header->format;
+  mesh->vert_count = bin.header->vert_count;
+  mesh->index_count = bin.header->index_count;
+  mesh->name = mesh->name_internal->slice;
+  mesh->bounds_center = bin.header->bounds_center;
+  mesh->bounds_radius = bin.header->bounds_radius;
+
+  mesh->upload_verts = bin.verts;
+  mesh->verts_size = bin.verts_size;
+  mesh->upload_indices = bin.indices;
+  mesh->indices_size = bin.indices_size;
+  return true;
+}
 
+////////////////////////////////////////////////////////////////////////////////
+
+static void _model_release_staging(Model_Internal_Mesh* mesh) {
+  str_delete(&mesh->obj.name);
+  arr_delete(&mesh->obj.verts);
+  arr_delete(&mesh->obj.indices);
+  if (mesh->file) file_delete(&mesh->file);
+
+  mesh->upload_verts = NULL;
+  mesh->upload_indices = NULL;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Streaming a .wmesh
+////////////////////////////////////////////////////////////////////////////////
+
+// The header gives the final sizes, so the buffers are allocated up front and
+//    each block is written into them as its chunks arrive
+static bool _model_stream_header(void* data, const wmesh_header_t* header) {
+  Model_Internal_Mesh* mesh = data;
+
+  mesh->format = header->format;
+  mesh->vert_count = header->vert_count;
+  mesh->index_count = header->index_count;
+  mesh->bounds_center = header->bounds_center;
+  mesh->bounds_radius = header->bounds_radius;
+  mesh->verts_size = (index_t)header->vert_count * vertex_size(header->format);
+  mesh->indices_size = (index_t)header->index_count * sizeof(uint);
+
+  // the index buffer bind below would otherwise modify the bound VAO
+  gl_bind_vertex_array(0);
   glGenBuffers(2, mesh->buffers);
 
-  glBindBuffer(GL_ARRAY_BUFFER, mesh->vbo);
-  glBufferData(GL_ARRAY_BUFFER
-  , obj.verts->size_bytes
-  , obj.verts->begin
-  , GL_STATIC_DRAW
-  );
+  gl_bind_buffer(GL_ARRAY_BUFFER, mesh->vbo);
+  glBufferData(GL_ARRAY_BUFFER, mesh->verts_size, NULL, GL_STATIC_DRAW);
+  gl_bind_buffer(GL_ARRAY_BUFFER, 0);
 
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->ebo);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER
-  , obj.indices->size_bytes
-  , obj.indices->begin
-  , GL_STATIC_DRAW
+  gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, mesh->ebo);
+  glBufferData(
+    GL_ELEMENT_ARRAY_BUFFER, mesh->indices_size, NULL, GL_STATIC_DRAW
   );
+  gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+  return true;
+}
 
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+////////////////////////////////////////////////////////////////////////////////
 
-new_obj_cleanup:
+static bool _model_stream_block(
+  void* data, wmesh_block_t block, index_t offset, slice_t bytes
+) {
+  Model_Internal_Mesh* mesh = data;
+
+  switch (block) {
+    case WMESH_BLOCK_VERTS:
+      gl_bind_buffer(GL_ARRAY_BUFFER, mesh->vbo);
+      glBufferSubData(GL_ARRAY_BUFFER, offset, bytes.size, bytes.begin);
+      gl_bind_buffer(GL_ARRAY_BUFFER, 0);
+      break;
+
+    case WMESH_BLOCK_INDICES:
+      gl_bind_vertex_array(0);
+      gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, mesh->ebo);
+      glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, offset, bytes.size, bytes.begin);
+      gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+      break;
+
+    // names are short, but may still straddle two chunks
+    case WMESH_BLOCK_NAME:
+      if (mesh->name_internal) {
+        String name = str_concat(mesh->name_internal->slice, bytes);
+        str_delete(&mesh->name_internal);
+        mesh->name_internal = name;
+      }
+      else {
+        mesh->name_internal = str_copy(bytes);
+      }
+      break;
+
+    default: assert(false); return false;
+  }
 
-  arr_delete(&obj.verts);
-  arr_delete(&obj.indices);
+  return true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void _model_build_mesh(Model model) {
+static bool _model_stream_chunk(
+  File file, slice_t chunk, bool last, void* data
+) {
+  UNUSED(file);
+  Model_Internal_Mesh* mesh = data;
+  return wmesh_reader_feed(&mesh->reader, chunk, last);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void _model_open_file(Model_Internal_Mesh* mesh, slice_t filename) {
+  mesh->streamed = str_ends_with(filename, ".wmesh");
+
+  if (!mesh->streamed) {
+    mesh->file = file_new(filename, FM_READ);
+    return;
+  }
+
+  mesh->reader = (wmesh_reader_t) {
+    .on_header = _model_stream_header,
+    .on_block = _model_stream_block,
+    .data = mesh,
+  };
+
+  mesh->file = file_new_stream(filename, 0, _model_stream_chunk, mesh);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// A stream that stopped early (S_CLOSED) was rejected by the reader
+static bool _model_stream_finish(Model_Internal_Mesh* mesh) {
+  if (mesh->file->status != S_READY) {
+    if (mesh->vbo) gl_delete_buffers(2, mesh->buffers);
+    mesh->vbo = mesh->ebo = 0;
+    str_delete(&mesh->name_internal);
+    return false;
+  }
+
+  if (!mesh->name_internal) {
+    mesh->name_internal =
+      str_copy(str_between_last(mesh->file->name, "/", "."));
+  }
+
+  mesh->name = mesh->name_internal->slice;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// GPU upload
+////////////////////////////////////////////////////////////////////////////////
+
+// Uploads the staged verts and then indices, spending at most *budget bytes
+//    and subtracting what was used. A NULL budget uploads everything at once.
+//    Returns true when the whole mesh is on the GPU.
+static bool _model_upload(Model_Internal_Mesh* mesh, index_t* budget) {
+  index_t total = mesh->verts_size + mesh->indices_size;
+  if (budget && *budget <= 0) return false;
+
+  // renderers leave their last VAO bound, which the index buffer bind below
+  //    would otherwise modify
+  gl_bind_vertex_array(0);
+
+  // small enough to go in one shot
+  if (!mesh->vbo && (!budget || *budget >= total)) {
+    glGenBuffers(2, mesh->buffers);
+
+    gl_bind_buffer(GL_ARRAY_BUFFER, mesh->vbo);
+    glBufferData(GL_ARRAY_BUFFER
+    , mesh->verts_size
+    , mesh->upload_verts
+    , GL_STATIC_DRAW
+    );
+
+    gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, mesh->ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER
+    , mesh->indices_size
+    , mesh->upload_indices
+    , GL_STATIC_DRAW
+    );
+
+    if (budget) *budget -= total;
+    mesh->upload_offset = total;
+  }
+
+  // otherwise allocate the storage and stream it in over several frames. A
+  //    mesh already partway through keeps streaming here even if the budget
+  //    was lifted since, in which case the rest goes in this call.
+  else {
+    if (!mesh->vbo) {
+      glGenBuffers(2, mesh->buffers);
+
+      gl_bind_buffer(GL_ARRAY_BUFFER, mesh->vbo);
+      glBufferData(GL_ARRAY_BUFFER, mesh->verts_size, NULL, GL_STATIC_DRAW);
+
+      gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, mesh->ebo);
+      glBufferData(
+        GL_ELEMENT_ARRAY_BUFFER, mesh->indices_size, NULL, GL_STATIC_DRAW
+      );
+    }
+
+    while (mesh->upload_offset < total && (!budget || *budget > 0)) {
+      bool verts = mesh->upload_offset < mesh->verts_size;
+      GLenum target = verts ? GL_ARRAY_BUFFER : GL_ELEMENT_ARRAY_BUFFER;
+      const byte* src = verts ? mesh->upload_verts : mesh->upload_indices;
+      index_t offset = verts
+        ? mesh->upload_offset
+        : mesh->upload_offset - mesh->verts_size;
+      index_t size = verts ? mesh->verts_size : mesh->indices_size;
+      size = budget ? MIN(size - offset, *budget) : size - offset;
+
+      gl_bind_buffer(target, verts ? mesh->vbo : mesh->ebo);
+      glBufferSubData(target, offset, size, src + offset);
+
+      mesh->upload_offset += size;
+      if (budget) *budget -= size;
+    }
+  }
+
+  gl_bind_buffer(GL_ARRAY_BUFFER, 0);
+  gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+  return mesh->upload_offset >= total;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void _model_build_mesh(Model model, index_t* budget) {
   Model_Internal_Mesh* mesh = (Model_Internal_Mesh*)model;
   assert(mesh);
   assert(mesh->type == MODEL_MESH);
 
-  if (mesh->status == S_READY) return;
+  if (mesh->status == S_READY || mesh->status == S_ERROR) return;
   assert(mesh->file);
 
-  if (mesh->status == S_LOADING && mesh->file->status == S_READY) {
+  if (mesh->status == S_LOADING) {
+    if (mesh->file->status == S_LOADING) return;
+
+    if (mesh->streamed) {
+      if (_model_stream_finish(mesh)) {
+        str_log("[Model.load] Streamed model from file: {}", mesh->file->name);
+        _model_release_staging(mesh);
+        mesh->status = S_READY;
+        return;
+      }
+
+      str_log("[Model.load] Failed to stream file: {}", mesh->file->name);
+      _model_release_staging(mesh);
+      mesh->status = S_ERROR;
+      return;
+    }
+
+    if (mesh->file->status != S_READY) {
+      str_log("[Model.load] Failed to load file: {}", mesh->file->name);
+      _model_release_staging(mesh);
+      mesh->status = S_ERROR;
+      return;
+    }
+
+    str_log("[Model.load] Building model from file: {}", mesh->file->name);
     mesh->status = S_BUILDING;
+
+    if (!wmesh_is_binary(mesh->file->slice)) {
+      jobs_submit_background(_model_parse_job, mesh, &mesh->build_job);
+    }
+    else if (!_model_stage_binary(mesh)) {
+      _model_release_staging(mesh);
+      mesh->status = S_ERROR;
+      return;
+    }
   }
 
-  str_log("[Model.load] Building model from file: {}", mesh->file->name);
+  // parsing is still running on a job thread
+  if (!mesh->upload_verts) {
+    if (!jobs_done(&mesh->build_job)) return;
+
+    if (!_model_stage_obj(mesh)) {
+      _model_release_staging(mesh);
+      mesh->status = S_ERROR;
+      return;
+    }
+  }
 
-  _model_build_from_string(model, mesh->file->slice);
+  if (_model_upload(mesh, budget)) {
+    _model_release_staging(mesh);
+    mesh->status = S_READY;
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// Load from OBJ
+// Deleting
 ////////////////////////////////////////////////////////////////////////////////
 
-Model model_new_load_obj(slice_t filename) {
+void _model_delete_mesh(Model model) {
+  Model_Internal_Mesh* mesh = (Model_Internal_Mesh*)model;
+
+  // a parse job still running writes into the mesh
+  jobs_wait(&mesh->build_job);
+  _model_release_staging(mesh);
+
+  if (mesh->vao) gl_delete_vertex_arrays(1, &mesh->vao);
+  if (mesh->vbo) gl_delete_buffers(1, &mesh->vbo);
+  if (mesh->ebo) gl_delete_buffers(1, &mesh->ebo);
+
+  str_delete(&mesh->name_internal);
+  free(mesh);
+}
+
+static void _model_asset_free(void* handle) {
+  Model model = handle;
+  model_delete(&model);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Load from an OBJ or .wmesh file
+////////////////////////////////////////////////////////////////////////////////
+
+Model model_new_load_mesh(slice_t filename) {
   assert(!slice_is_empty(filename));
 
+  // Reuse the mesh if this or an earlier scene already loaded the file
+  Model cached = asset_get(ASSET_MODEL, filename);
+  if (cached) {
+    asset_hold(ASSET_MODEL, filename);
+
+    // A failed load stays in the loading list, so it just starts over
+    if (cached->status == S_ERROR) {
+      Model_Internal_Mesh* mesh = (Model_Internal_Mesh*)cached;
+      str_log("[Model.new] Retrying failed load: {}", filename);
+      _model_release_staging(mesh);
+      _model_open_file(mesh, filename);
+      mesh->status = S_LOADING;
+    }
+
+    return cached;
+  }
+
   Model_Internal_Mesh* model = malloc(sizeof(*model));
   assert(model);
 
@@ -146,16 +491,28 @@ Model model_new_load_obj(slice_t filename) {
   *model = (Model_Internal_Mesh) {
   .type = MODEL_MESH,
   .status = S_LOADING,
-  .file = file_new(filename, FM_READ),
   };
 
+  _model_open_file(model, filename);
+
   arr_insert_back(_new_models, &model);
 
+  // Render groups are dropped when a scene closes, before the previous scene's
+  //    models are released, so nothing still draws this when it's freed
+  asset_insert(ASSET_MODEL, filename, model, _model_asset_free);
+  asset_hold(ASSET_MODEL, filename);
+
   return (Model)model;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
+Model model_new_load_obj(slice_t filename) {
+  return model_new_load_mesh(filename);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 Model model_new_from_obj(slice_t obj_text) {
   assert(slice_is_valid(obj_text));
 
@@ -171,7 +528,17 @@ Model model_new_from_obj(slice_t obj_text) {
 
   arr_insert_back(_new_models, &model);
 
-  _model_build_from_string((Model)model, obj_text);
+  // built and uploaded immediately, the caller expects it to be ready
+  model->obj = file_load_obj(obj_text);
+
+  if (_model_stage_obj(model) && _model_upload(model, NULL)) {
+    model->status = S_READY;
+  }
+  else {
+    model->status = S_ERROR;
+  }
+
+  _model_release_staging(model);
 
   str_log("[Model.new] Loaded model: {}", model->name);
 
@@ -189,8 +556,8 @@ void _model_bind_mesh(const Model model) {
   assert(mesh->vbo);
   assert(mesh->ebo);
 
-  glBindBuffer(GL_ARRAY_BUFFER, mesh->vbo);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->ebo);
+  gl_bind_buffer(GL_ARRAY_BUFFER, mesh->vbo);
+  gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, mesh->ebo);
   vertex_bind(model->format);
 }
 
@@ -206,11 +573,11 @@ void _model_render_mesh(Model model) {
 
   if (!mesh->vao) {
     glGenVertexArrays(1, &mesh->vao);
-    glBindVertexArray(mesh->vao);
+    gl_bind_vertex_array(mesh->vao);
     model_bind((Model)mesh);
   }
   else {
-    glBindVertexArray(mesh->vao);
+    gl_bind_vertex_array(mesh->vao);
   }
 
   glDrawElements
@@ -220,5 +587,5 @@ void _model_render_mesh(Model model) {
   , 0
   );
 
-  glBindVertexArray(0);
+  gl_bind_vertex_array(0);
 }
@@ -61,7 +61,7 @@ static Model _model_new_cube(void) {
   GLsizeiptr size = sizeof(primitive_cube_uv_norm);
   GLuint vbo;
   glGenBuffers(1, &vbo);
-  glBindBuffer(GL_ARRAY_BUFFER, vbo);
+  gl_bind_buffer(GL_ARRAY_BUFFER, vbo);
   glBufferData(GL_ARRAY_BUFFER, size, primitive_cube_uv_norm, GL_STATIC_DRAW);
 
   *model = (Model_Internal_Primitive) {
@@ -71,6 +71,8 @@ static Model _model_new_cube(void) {
     .format = VF_UV_NORM,
     .vert_count = 36,
     .index_count = 0,
+    .bounds_center = v3origin,
+    .bounds_radius = 0.8660254f, // sqrt(3)/2, half the unit cube's diagonal
     .vbo = vbo,
     .vao = 0,
   };
@@ -93,7 +95,7 @@ static Model _model_new_cube_color(void) {
   GLsizeiptr size = sizeof(primitive_cube_color);
   GLuint vbo;
   glGenBuffers(1, &vbo);
-  glBindBuffer(GL_ARRAY_BUFFER, vbo);
+  gl_bind_buffer(GL_ARRAY_BUFFER, vbo);
   glBufferData(GL_ARRAY_BUFFER, size, primitive_cube_color, GL_STATIC_DRAW);
 
   *model = (Model_Internal_Primitive){
@@ -103,6 +105,8 @@ static Model _model_new_cube_color(void) {
     .format = VF_COLOR,
     .vert_count = 14,
     .index_count = 0,
+    .bounds_center = v3origin,
+    .bounds_radius = 0.8660254f,
     .vbo = vbo,
     .vao = 0,
   };
@@ -125,7 +129,7 @@ static Model _model_new_frame(void) {
   GLsizeiptr size = sizeof(primitive_frame);
   GLuint vbo;
   glGenBuffers(1, &vbo);
-  glBindBuffer(GL_ARRAY_BUFFER, vbo);
+  gl_bind_buffer(GL_ARRAY_BUFFER, vbo);
   glBufferData(GL_ARRAY_BUFFER, size, primitive_frame, GL_STATIC_DRAW);
 
   *model = (Model_Internal_Primitive) {
@@ -157,7 +161,7 @@ static Model _model_new_particle(void) {
   GLsizeiptr size = sizeof(primitive_particle);
   GLuint vbo;
   glGenBuffers(1, &vbo);
-  glBindBuffer(GL_ARRAY_BUFFER, vbo);
+  gl_bind_buffer(GL_ARRAY_BUFFER, vbo);
   glBufferData(GL_ARRAY_BUFFER, size, primitive_particle, GL_STATIC_DRAW);
 
   *model = (Model_Internal_Primitive) {
@@ -218,7 +222,7 @@ void _model_bind_primitive(Model model) {
   assert(prim->status == S_READY);
   assert(prim->vbo);
 
-  glBindBuffer(GL_ARRAY_BUFFER, prim->vbo);
+  gl_bind_buffer(GL_ARRAY_BUFFER, prim->vbo);
   vertex_bind(prim->format);
 }
 
@@ -232,11 +236,11 @@ void _model_render_prim(Model model) {
 
   if (!prim->vao) {
     glGenVertexArrays(1, &prim->vao);
-    glBindVertexArray(prim->vao);
+    gl_bind_vertex_array(prim->vao);
     model_bind((Model)prim);
   }
   else {
-    glBindVertexArray(prim->vao);
+    gl_bind_vertex_array(prim->vao);
   }
 
   if (prim->index_count) {
@@ -252,7 +256,7 @@ void _model_render_prim(Model model) {
     , (GLsizei)prim->vert_count
     );
   }
-  glBindVertexArray(0);
+  gl_bind_vertex_array(0);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -264,15 +268,15 @@ void _model_render_prim_strip(Model model) {
 
   if (!prim->vao) {
     glGenVertexArrays(1, &prim->vao);
-    glBindVertexArray(prim->vao);
+    gl_bind_vertex_array(prim->vao);
     model_bind((Model)prim);
   }
   else {
-    glBindVertexArray(prim->vao);
+    gl_bind_vertex_array(prim->vao);
   }
 
   glDrawArrays(GL_TRIANGLE_STRIP, 0, (GLsizei)prim->vert_count);
-  glBindVertexArray(0);
+  gl_bind_vertex_array(0);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
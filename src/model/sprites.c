@@ -82,7 +82,7 @@ void _model_bind_sprites(const Model model) {
   assert(sprites->type == MODEL_SPRITES);
   assert(sprites->vbo);
 
-  glBindBuffer(GL_ARRAY_BUFFER, sprites->vbo);
+  gl_bind_buffer(GL_ARRAY_BUFFER, sprites->vbo);
   vertex_bind(sprites->format);
 }
 
@@ -96,25 +96,25 @@ void _model_render_sprites(Model model) {
 
   if (!sprites->vao) {
     glGenVertexArrays(1, &sprites->vao);
-    glBindVertexArray(sprites->vao);
+    gl_bind_vertex_array(sprites->vao);
     model_bind((Model)sprites);
   }
   else {
-    glBindVertexArray(sprites->vao);
+    gl_bind_vertex_array(sprites->vao);
   }
 
   index_t size_bytes = sprites->verts->size_bytes;
   void* data_start = arr_ref_front(sprites->verts);
-  glBindBuffer(GL_ARRAY_BUFFER, sprites->vbo);
+  gl_bind_buffer(GL_ARRAY_BUFFER, sprites->vbo);
   glBufferData(GL_ARRAY_BUFFER, size_bytes, data_start, GL_DYNAMIC_DRAW);
 
-  glEnable(GL_BLEND);
+  gl_enable(GL_BLEND);
   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
   glDrawArrays(GL_TRIANGLES, 0, (GLsizei)sprites->verts->size);
-  glDisable(GL_BLEND);
+  gl_disable(GL_BLEND);
 
-  glBindVertexArray(0);
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  gl_bind_vertex_array(0);
+  gl_bind_buffer(GL_ARRAY_BUFFER, 0);
 
   arr_clear(sprites->verts);
 }
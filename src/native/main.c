@@ -29,6 +29,8 @@
 
 #include "str.h"
 #include "file.h"
+#include "image.h"
+#include "thread.h"
 
 #define SDL_MAIN_USE_CALLBACKS
 #include "SDL3/SDL_main.h"
@@ -132,6 +134,8 @@ SDL_AppResult SDL_AppInit(void** app_state, int argc, char* argv[]) {
 
   str_log("[App.Init] Initializing game: {}", app.game->title);
 
+  jobs_init(0);
+
   SDL_WindowFlags flags = SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE;
   app.window = SDL_CreateWindow(
     app.game->title->begin,
@@ -167,8 +171,8 @@ SDL_AppResult SDL_AppInit(void** app_state, int argc, char* argv[]) {
   igStyleColorsDark(NULL);
 
 #ifdef _DEBUG
-  glEnable(GL_DEBUG_OUTPUT);
-  glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+  gl_enable(GL_DEBUG_OUTPUT);
+  gl_enable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
   glDebugMessageCallback(gl_debug_output, NULL);
   glDebugMessageControl(
     GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, NULL, true);
@@ -176,8 +180,8 @@ SDL_AppResult SDL_AppInit(void** app_state, int argc, char* argv[]) {
 
   glClearColor(0.2f, 0.2f, 0.2f, 1);
   glClearDepth(1);
-  glEnable(GL_DEPTH_TEST);
-  glEnable(GL_CULL_FACE);
+  gl_enable(GL_DEPTH_TEST);
+  gl_enable(GL_CULL_FACE);
   glDepthFunc(GL_LEQUAL);
 
   SDL_SetWindowSize(app.window, app.game->window.w, app.game->window.h);
@@ -218,6 +222,10 @@ SDL_AppResult SDL_AppIterate(void* app_state) {
   igRender();
   ImGui_ImplOpenGL3_RenderDrawData(igGetDrawData());
 
+  // ImGui restores the state it changes, but through raw GL calls
+  gl_state_invalidate();
+  gl_state_frame_end();
+
   SDL_GL_SwapWindow(app.window);
 
   return SDL_APP_CONTINUE;
@@ -253,6 +261,8 @@ void SDL_AppQuit(void* app_state, SDL_AppResult result) {
 
   fflush(stdout);
 
+  img_loading_shutdown();
+  jobs_shutdown();
   game_delete(&app.game);
 
   if (app.gl_context) {
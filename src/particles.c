@@ -31,8 +31,15 @@
 #include "utility.h"
 #include "quat.h"
 #include "entity.h"
+#include "thread.h"
+#include "simd.h"
 
 #include <stdlib.h>
+#include <string.h>
+
+// Particles per job when updating an EF_PARALLEL effect. Serial updates use
+//    the same ranges so expired particles are collected identically.
+#define PS_UPDATE_CHUNK 4096
 
 typedef struct particle_format_desc_t {
   int size;
@@ -53,12 +60,36 @@ static const particle_format_desc_t _particle_format[PF_SUPPORTED_MAX] = {
 #undef con_prefix
 #undef con_type
 
+// Structure-of-arrays particle storage used by EF_SOA effects. Each stream
+//    holds capacity floats (a multiple of 4), so the SIMD kernels can always
+//    process whole lanes past the last particle.
+typedef enum particle_stream_t {
+  PS_POS_X, PS_POS_Y, PS_POS_Z,
+  PS_VEL_X, PS_VEL_Y, PS_VEL_Z,
+  PS_AGE,
+  PS_DURATION,
+  PS_SCALE,
+  PS_STREAM_COUNT
+} particle_stream_t;
+
+typedef struct particle_soa_t {
+  float*    data;
+  float*    stream[PS_STREAM_COUNT];
+  index_t   size;
+  index_t   capacity;
+} particle_soa_t;
+
 typedef struct ParticleEffect_Internal {
   struct _opaque_ParticleEffect_t pub;
 
   String          name_internal;
   Array_particle  metadata;
   Array           instances;
+  particle_soa_t  soa;
+  index_t*        kills;        // expired particles, grouped by update chunk
+  index_t*        kill_counts;  // number of expired particles in each chunk
+  index_t         kill_capacity;
+  index_t         recycle_cursor; // next slot replaced by PO_RECYCLE
   uint            vao;
   uint            vbo_instances;
   index_t         vbo_capacity;
@@ -109,26 +140,174 @@ ParticleSystem ps_new(void) {
 // Particle update and creation
 ////////////////////////////////////////////////////////////////////////////////
 
-void _effect_update(ParticleEffect_Internal* effect, float dt) {
-  assert(effect);
-  assert(effect->instances->size == effect->metadata->size);
+static void _soa_reserve(particle_soa_t* soa, index_t n) {
+  if (n <= soa->capacity) return;
 
-  particle_t particle = {
-    .base = effect->metadata->begin,
-    .inst = effect->instances->begin,
-  };
+  index_t capacity = MAX(soa->capacity * 2, 256);
+  while (capacity < n) capacity *= 2;
 
-  for (index_t i = 0; i < effect->instances->size;) {
-    particle.base->age += dt;
+  float* data = calloc((size_t)capacity * PS_STREAM_COUNT, sizeof(float));
+  assert(data);
 
-    if (particle.base->age > particle.base->duration) {
+  for (int s = 0; s < PS_STREAM_COUNT; ++s) {
+    float* stream = data + (size_t)capacity * s;
+    if (soa->size > 0) {
+      memcpy(stream, soa->stream[s], sizeof(float) * soa->size);
+    }
+    soa->stream[s] = stream;
+  }
 
-      if (effect->pub.on_particle_destroy) {
-        effect->pub.on_particle_destroy((ParticleEffect)effect, particle);
-      }
+  free(soa->data);
+  soa->data = data;
+  soa->capacity = capacity;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void _soa_write(particle_soa_t* soa, index_t i, particle_t particle) {
+  float** s = soa->stream;
+  s[PS_POS_X][i]    = particle.inst_point->pos.x;
+  s[PS_POS_Y][i]    = particle.inst_point->pos.y;
+  s[PS_POS_Z][i]    = particle.inst_point->pos.z;
+  s[PS_SCALE][i]    = particle.inst_point->scale;
+  s[PS_VEL_X][i]    = particle.base->vel.x;
+  s[PS_VEL_Y][i]    = particle.base->vel.y;
+  s[PS_VEL_Z][i]    = particle.base->vel.z;
+  s[PS_AGE][i]      = particle.base->age;
+  s[PS_DURATION][i] = particle.base->duration;
+}
+
+static void _soa_read(particle_soa_t* soa, index_t i, particle_t particle) {
+  float** s = soa->stream;
+  particle.inst_point->pos.x  = s[PS_POS_X][i];
+  particle.inst_point->pos.y  = s[PS_POS_Y][i];
+  particle.inst_point->pos.z  = s[PS_POS_Z][i];
+  particle.inst_point->scale  = s[PS_SCALE][i];
+  particle.base->vel.x        = s[PS_VEL_X][i];
+  particle.base->vel.y        = s[PS_VEL_Y][i];
+  particle.base->vel.z        = s[PS_VEL_Z][i];
+  particle.base->age          = s[PS_AGE][i];
+  particle.base->duration     = s[PS_DURATION][i];
+}
+
+static void _soa_remove_unstable(particle_soa_t* soa, index_t i) {
+  assert(i >= 0 && i < soa->size);
+  index_t last = --soa->size;
+  for (int s = 0; s < PS_STREAM_COUNT; ++s) {
+    soa->stream[s][i] = soa->stream[s][last];
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// SoA kernels - ranges start on a multiple of 4 and may run past the end up to
+//    the next multiple of 4, which stays within capacity.
+////////////////////////////////////////////////////////////////////////////////
+
+static index_t _soa_age_expire(
+  particle_soa_t* soa, index_t begin, index_t end, float dt, index_t* kills
+) {
+  float* age = soa->stream[PS_AGE];
+  float* duration = soa->stream[PS_DURATION];
+  f4_t vdt = f4set(dt);
+  index_t kill_count = 0;
+
+  for (index_t i = begin; i < end; i += 4) {
+    f4_t a = f4add(f4load(age + i), vdt);
+    f4store(age + i, a);
+
+    int mask = f4gt_mask(a, f4load(duration + i));
+    if (i + 4 > end) mask &= (1 << (end - i)) - 1;
+
+    for (int lane = 0; mask; ++lane, mask >>= 1) {
+      if (mask & 1) kills[kill_count++] = i + lane;
+    }
+  }
+
+  return kill_count;
+}
+
+static void _soa_integrate(
+  particle_soa_t* soa, index_t begin, index_t end, float dt
+) {
+  f4_t vdt = f4set(dt);
+
+  for (int axis = 0; axis < 3; ++axis) {
+    float* pos = soa->stream[PS_POS_X + axis];
+    float* vel = soa->stream[PS_VEL_X + axis];
+
+    for (index_t i = begin; i < end; i += 4) {
+      f4_t p = f4add(f4load(pos + i), f4mul(f4load(vel + i), vdt));
+      f4store(pos + i, p);
+    }
+  }
+}
+
+static void _soa_gravity(
+  particle_soa_t* soa, index_t begin, index_t end, float dt
+) {
+  float* vel_y = soa->stream[PS_VEL_Y];
+  f4_t dv = f4set(-9.8f * dt);
+
+  for (index_t i = begin; i < end; i += 4) {
+    f4store(vel_y + i, f4add(f4load(vel_y + i), dv));
+  }
+}
+
+// Interleaves position and scale into the attribute_particle_point_t upload
+//    buffer. Unlike the update kernels this writes to a tightly sized array,
+//    so the tail is handled separately.
+static void _soa_pack(index_t begin, index_t end, void* data) {
+  ParticleEffect_Internal* effect = data;
+  particle_soa_t* soa = &effect->soa;
+  float* out = (float*)effect->instances->begin;
+  float** s = soa->stream;
+
+  index_t i = begin;
+  for (; i + 4 <= end; i += 4) {
+    f4store_interleaved(out + i * 4
+    , f4load(s[PS_POS_X] + i), f4load(s[PS_POS_Y] + i)
+    , f4load(s[PS_POS_Z] + i), f4load(s[PS_SCALE] + i)
+    );
+  }
+
+  for (; i < end; ++i) {
+    out[i * 4 + 0] = s[PS_POS_X][i];
+    out[i * 4 + 1] = s[PS_POS_Y][i];
+    out[i * 4 + 2] = s[PS_POS_Z][i];
+    out[i * 4 + 3] = s[PS_SCALE][i];
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct effect_batch_t {
+  ParticleEffect_Internal*  effect;
+  float                     dt;
+} effect_batch_t;
+
+// Ages and moves the particles in [begin, end). Expired particles are only
+//    recorded here so that ranges can be processed on separate threads, and
+//    are removed afterwards by _effect_remove_expired.
+static void _effect_integrate(index_t begin, index_t end, void* data) {
+  effect_batch_t* batch = data;
+  ParticleEffect_Internal* effect = batch->effect;
+  float dt = batch->dt;
+
+  index_t stride = effect->instances->element_size;
+  char* inst = (char*)effect->instances->begin + begin * stride;
+  index_t* kills = effect->kills + begin;
+  index_t kill_count = 0;
+
+  for (index_t i = begin; i < end; ++i, inst += stride) {
+    particle_t particle = {
+      .base = &effect->metadata->begin[i],
+      .inst = (particle_inst_t*)inst,
+    };
+
+    particle.base->age += dt;
 
-      arr_remove_unstable(effect->instances, i);
-      arr_particle_remove_unstable(effect->metadata, i);
+    if (particle.base->age > particle.base->duration) {
+      kills[kill_count++] = i;
       continue;
     }
 
@@ -137,12 +316,147 @@ void _effect_update(ParticleEffect_Internal* effect, float dt) {
     if (effect->pub.on_particle_update) {
       effect->pub.on_particle_update((ParticleEffect)effect, particle, dt);
     }
+  }
+
+  effect->kill_counts[begin / PS_UPDATE_CHUNK] = kill_count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// SoA equivalent of _effect_integrate. pb_gravity runs as a kernel, any other
+//    update callback is given a gathered copy of each live particle.
+static void _effect_integrate_soa(index_t begin, index_t end, void* data) {
+  effect_batch_t* batch = data;
+  ParticleEffect_Internal* effect = batch->effect;
+  particle_soa_t* soa = &effect->soa;
+  float dt = batch->dt;
+
+  index_t* kills = effect->kills + begin;
+  index_t kill_count = _soa_age_expire(soa, begin, end, dt, kills);
+
+  _soa_integrate(soa, begin, end, dt);
+
+  particle_behavior_fn_t* on_update = effect->pub.on_particle_update;
+
+  if (on_update == pb_gravity) {
+    _soa_gravity(soa, begin, end, dt);
+  }
+  else if (on_update) {
+    particle_base_t base;
+    particle_inst_t inst;
+    particle_t particle = { .base = &base, .inst = &inst };
+    float* age = soa->stream[PS_AGE];
+    float* duration = soa->stream[PS_DURATION];
+
+    for (index_t i = begin; i < end; ++i) {
+      if (age[i] > duration[i]) continue;
+      _soa_read(soa, i, particle);
+      on_update((ParticleEffect)effect, particle, dt);
+      _soa_write(soa, i, particle);
+    }
+  }
+
+  effect->kill_counts[begin / PS_UPDATE_CHUNK] = kill_count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void _effect_reserve_kills(ParticleEffect_Internal* effect, index_t n) {
+  if (n <= effect->kill_capacity) return;
+
+  index_t capacity = MAX(effect->kill_capacity * 2, PS_UPDATE_CHUNK);
+  while (capacity < n) capacity *= 2;
+  index_t chunks = (capacity + PS_UPDATE_CHUNK - 1) / PS_UPDATE_CHUNK;
+
+  index_t* kills = realloc(effect->kills, sizeof(index_t) * capacity);
+  index_t* counts = realloc(effect->kill_counts, sizeof(index_t) * chunks);
+  assert(kills);
+  assert(counts);
+
+  effect->kills = kills;
+  effect->kill_counts = counts;
+  effect->kill_capacity = capacity;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Destroy callbacks run in index order, then removal goes from the highest
+//    index down so the swapped-in particle is never one that's also expired.
+static void _effect_remove_expired(ParticleEffect_Internal* effect, index_t n) {
+  index_t chunks = (n + PS_UPDATE_CHUNK - 1) / PS_UPDATE_CHUNK;
+  bool is_soa = effect->pub.flags & EF_SOA;
+
+  if (effect->pub.on_particle_destroy) {
+    particle_base_t base;
+    particle_inst_t inst;
+
+    for (index_t c = 0; c < chunks; ++c) {
+      index_t* kills = effect->kills + c * PS_UPDATE_CHUNK;
+
+      for (index_t k = 0; k < effect->kill_counts[c]; ++k) {
+        particle_t particle = { .base = &base, .inst = &inst };
+
+        if (is_soa) {
+          _soa_read(&effect->soa, kills[k], particle);
+        }
+        else {
+          particle.base = &effect->metadata->begin[kills[k]];
+          particle.inst = arr_ref_unchecked(effect->instances, kills[k]);
+        }
+
+        effect->pub.on_particle_destroy((ParticleEffect)effect, particle);
+      }
+    }
+  }
+
+  for (index_t c = chunks; c-- > 0; ) {
+    index_t* kills = effect->kills + c * PS_UPDATE_CHUNK;
+
+    for (index_t k = effect->kill_counts[c]; k-- > 0; ) {
+      if (is_soa) {
+        _soa_remove_unstable(&effect->soa, kills[k]);
+      }
+      else {
+        arr_remove_unstable(effect->instances, kills[k]);
+        arr_particle_remove_unstable(effect->metadata, kills[k]);
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void _effect_update(ParticleEffect_Internal* effect, float dt) {
+  assert(effect);
+
+  index_t n;
+  job_range_fn_t integrate;
+
+  if (effect->pub.flags & EF_SOA) {
+    n = effect->soa.size;
+    integrate = _effect_integrate_soa;
+  }
+  else {
+    assert(effect->instances->size == effect->metadata->size);
+    n = effect->instances->size;
+    integrate = _effect_integrate;
+  }
 
-    // increment here to avoid skipping particles when removed
-    ++i;
-    particle.base += 1;
-    particle.inst = arr_ref_unchecked(effect->instances, i);
+  if (n <= 0) return;
+
+  _effect_reserve_kills(effect, n);
+  effect_batch_t batch = { .effect = effect, .dt = dt };
+
+  if (effect->pub.flags & EF_PARALLEL) {
+    jobs_parallel_for(n, PS_UPDATE_CHUNK, integrate, &batch);
   }
+  else {
+    for (index_t begin = 0; begin < n; begin += PS_UPDATE_CHUNK) {
+      integrate(begin, MIN(begin + PS_UPDATE_CHUNK, n), &batch);
+    }
+  }
+
+  _effect_remove_expired(effect, n);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -222,6 +536,125 @@ void _emitter_create_particle(ParticleEmitter emitter, particle_t particle) {
 
 ////////////////////////////////////////////////////////////////////////////////
 
+static index_t _effect_count(ParticleEffect_Internal* effect) {
+  if (effect->pub.flags & EF_SOA) return effect->soa.size;
+  return effect->metadata->size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void _effect_spawn(
+  ParticleEffect_Internal* effect, ParticleEmitter emitter, index_t count
+) {
+  if (effect->pub.flags & EF_SOA) {
+    particle_soa_t* soa = &effect->soa;
+    _soa_reserve(soa, soa->size + count);
+
+    particle_base_t base;
+    particle_inst_t inst;
+    particle_t particle = { .base = &base, .inst = &inst };
+
+    for (index_t i = 0; i < count; ++i) {
+      _emitter_create_particle(emitter, particle);
+
+      if (effect->pub.on_particle_create) {
+        effect->pub.on_particle_create(emitter, particle);
+      }
+
+      _soa_write(soa, soa->size++, particle);
+    }
+
+    return;
+  }
+
+  span_t base = arr_particle_emplace_back_range(effect->metadata, count);
+  span_t inst = arr_emplace_back_range(effect->instances, count);
+
+  for (index_t i = 0; i < count; ++i) {
+    particle_t particle = {
+      .base = span_ref(base, i, effect->metadata->element_size),
+      .inst = span_ref(inst, i, effect->instances->element_size),
+    };
+
+    _emitter_create_particle(emitter, particle);
+
+    if (effect->pub.on_particle_create) {
+      effect->pub.on_particle_create(emitter, particle);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Replaces a live particle with a new one from the emitter. Slots are taken
+//    round-robin from a cursor, which is O(1) and follows spawn order while the
+//    pool stays full: every slot the cursor reaches was last filled at least a
+//    full lap ago. Particles moved by kills in the meantime can break the
+//    order, so the replaced particle is one of the oldest, not always the
+//    oldest.
+static void _effect_recycle(
+  ParticleEffect_Internal* effect, ParticleEmitter emitter
+) {
+  bool is_soa = effect->pub.flags & EF_SOA;
+  index_t count = _effect_count(effect);
+  if (count <= 0) return;
+
+  if (effect->recycle_cursor >= count) {
+    effect->recycle_cursor = 0;
+  }
+  index_t slot = effect->recycle_cursor++;
+
+  particle_base_t base;
+  particle_inst_t inst;
+  particle_t particle = { .base = &base, .inst = &inst };
+
+  if (is_soa) {
+    _soa_read(&effect->soa, slot, particle);
+  }
+  else {
+    particle.base = &effect->metadata->begin[slot];
+    particle.inst = arr_ref_unchecked(effect->instances, slot);
+  }
+
+  if (effect->pub.on_particle_destroy) {
+    effect->pub.on_particle_destroy((ParticleEffect)effect, particle);
+  }
+
+  _emitter_create_particle(emitter, particle);
+
+  if (effect->pub.on_particle_create) {
+    effect->pub.on_particle_create(emitter, particle);
+  }
+
+  if (is_soa) {
+    _soa_write(&effect->soa, slot, particle);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void _effect_update_stats(ParticleEffect_Internal* effect) {
+  particle_stats_t* stats = &effect->pub.stats;
+  index_t slots = MAX(effect->pub.budget, _effect_count(effect));
+
+  stats->count = _effect_count(effect);
+  stats->peak = MAX(stats->peak, stats->count);
+  stats->capacity = effect->pub.budget;
+
+  stats->bytes = (size_t)slots * effect->instances->element_size;
+  stats->bytes += (size_t)effect->kill_capacity * sizeof(index_t);
+
+  if (effect->pub.flags & EF_SOA) {
+    size_t soa_floats = (size_t)effect->soa.capacity * PS_STREAM_COUNT;
+    stats->bytes += soa_floats * sizeof(float);
+  }
+  else {
+    stats->bytes += (size_t)slots * sizeof(particle_base_t);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 bool _emitter_update(ParticleEmitter emitter, float dt) {
   assert(emitter);
 
@@ -260,24 +693,34 @@ bool _emitter_update(ParticleEmitter emitter, float dt) {
   index_t to_emit = (index_t)emitter->spawn_timer;
   emitter->spawn_timer -= (float)to_emit;
 
-  if (to_emit > 0) {
-    span_t base = arr_particle_emplace_back_range(effect->metadata, to_emit);
-    span_t inst = arr_emplace_back_range(effect->instances, to_emit);
-
-    for (index_t i = 0; i < to_emit; ++i) {
-      particle_t particle = {
-        .base = span_ref(base, i, effect->metadata->element_size),
-        .inst = span_ref(inst, i, effect->instances->element_size),
-      };
-
-      _emitter_create_particle(emitter, particle);
+  // The effect budget caps how many particles are alive at once
+  index_t to_recycle = 0;
+  if (effect->pub.budget > 0) {
+    index_t available = effect->pub.budget - _effect_count(effect);
 
-      if (effect->pub.on_particle_create) {
-        effect->pub.on_particle_create(emitter, particle);
+    if (to_emit > available) {
+      if (effect->pub.overflow == PO_RECYCLE) {
+        to_recycle = to_emit - available;
+      }
+      else {
+        effect->pub.stats.dropped += to_emit - available;
       }
+      to_emit = available;
     }
   }
 
+  if (to_emit > 0) {
+    _effect_spawn(effect, emitter, to_emit);
+  }
+
+  for (index_t i = 0; i < to_recycle; ++i) {
+    _effect_recycle(effect, emitter);
+  }
+
+  emitter->count += to_emit + to_recycle;
+  effect->pub.stats.spawned += to_emit + to_recycle;
+  effect->pub.stats.recycled += to_recycle;
+
   return true;
 }
 
@@ -296,14 +739,42 @@ void ps_update(ParticleSystem _ps, float dt) {
       smap_emitter_remove(ps->emitters, emitter->id);
     }
   }
+
+  ParticleEffect_Internal** map_foreach(peffect, ps->effects) {
+    _effect_update_stats(*peffect);
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 // Effect rendering
 ////////////////////////////////////////////////////////////////////////////////
 
+static void _effect_pack(ParticleEffect_Internal* effect) {
+  assert(effect->instances->element_size == sizeof(attribute_particle_point_t));
+
+  index_t n = effect->soa.size;
+  arr_clear(effect->instances);
+  if (n <= 0) return;
+
+  arr_emplace_back_range(effect->instances, n);
+
+  if (effect->pub.flags & EF_PARALLEL) {
+    jobs_parallel_for(n, PS_UPDATE_CHUNK, _soa_pack, effect);
+  }
+  else {
+    _soa_pack(0, n, effect);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void _effect_render(ParticleEffect_Internal* effect, camera_t* camera) {
   assert(effect);
+  UNUSED(camera); // matrices come from the FrameConstants uniform block
+
+  if (effect->pub.flags & EF_SOA) {
+    _effect_pack(effect);
+  }
 
   if (effect->instances->size <= 0) return;
 
@@ -328,14 +799,14 @@ void _effect_render(ParticleEffect_Internal* effect, camera_t* camera) {
     }
 
     glGenVertexArrays(1, &effect->vao);
-    glBindVertexArray(effect->vao);
+    gl_bind_vertex_array(effect->vao);
 
     model_bind(effect->pub.model);
 
     effect->vbo_capacity = effect->instances->size * element_size;
 
     glGenBuffers(1, &effect->vbo_instances);
-    glBindBuffer(GL_ARRAY_BUFFER, effect->vbo_instances);
+    gl_bind_buffer(GL_ARRAY_BUFFER, effect->vbo_instances);
     glBufferData(GL_ARRAY_BUFFER
     , effect->instances->size_bytes
     , effect->instances->begin
@@ -346,7 +817,7 @@ void _effect_render(ParticleEffect_Internal* effect, camera_t* camera) {
     attribute_bind(AF_PARTICLE_POINT, effect->pub.shader);
   }
   else {
-    glBindBuffer(GL_ARRAY_BUFFER, effect->vbo_instances);
+    gl_bind_buffer(GL_ARRAY_BUFFER, effect->vbo_instances);
 
     if (effect->instances->size_bytes > effect->vbo_capacity) {
       effect->vbo_capacity = effect->instances->size * element_size;
@@ -359,16 +830,13 @@ void _effect_render(ParticleEffect_Internal* effect, camera_t* camera) {
     , effect->instances->begin
     );
 
-    glBindVertexArray(effect->vao);
+    gl_bind_vertex_array(effect->vao);
   }
 
   assert(effect->pub.model);
 
-  int loc_proj_view = shader_uniform_loc(effect->pub.shader, "in_pv_matrix");
-  glUniformMatrix4fv(loc_proj_view, 1, 0, camera->projview.f);
-
   model_render_instanced(effect->pub.model, effect->instances->size);
-  glBindVertexArray(0);
+  gl_bind_vertex_array(0);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -389,6 +857,7 @@ void ps_render(ParticleSystem _ps, camera_t* camera) {
 void _ps_reset_effect(ParticleEffect_Internal* effect) {
   arr_clear(effect->instances);
   arr_particle_clear(effect->metadata);
+  effect->soa.size = 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -447,7 +916,6 @@ ParticleEffect ps_add_effect(
         .pos = svNzero,
         .dir = q4identity,
         .shape = ES_POINT,
-        .budget = 0,
         .rate = 10,
         .duration = 1,
         .particle_defaults = {
@@ -512,6 +980,45 @@ bool ps_set_effect_name(ParticleEffect _effect, slice_t name) {
   return map_effect_insert(ps->effects, effect->pub.name, effect);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+
+void ps_set_effect_budget(
+  ParticleEffect _effect, index_t budget, particle_overflow_t overflow
+) {
+  assert(_effect);
+  assert(budget >= 0);
+  ParticleEffect_Internal* effect = (ParticleEffect_Internal*)_effect;
+
+  arr_delete(&effect->instances);
+  arr_particle_delete(&effect->metadata);
+  free(effect->soa.data);
+  effect->soa = (particle_soa_t) { 0 };
+
+  if (budget > 0) {
+    effect->instances = arr_new_reserve(attribute_particle_point_t, budget);
+
+    if (effect->pub.flags & EF_SOA) {
+      effect->metadata = arr_particle_new();
+      _soa_reserve(&effect->soa, budget);
+    }
+    else {
+      effect->metadata = arr_particle_new_reserve(budget);
+    }
+
+    _effect_reserve_kills(effect, budget);
+  }
+  else {
+    effect->instances = iarr_new(sizeof(attribute_particle_point_t));
+    effect->metadata = arr_particle_new();
+  }
+
+  effect->pub.budget = budget;
+  effect->pub.overflow = overflow;
+  effect->recycle_cursor = 0;
+  effect->pub.stats.peak = 0;
+  _effect_update_stats(effect);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Emitter Functionality
 ////////////////////////////////////////////////////////////////////////////////
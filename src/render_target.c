@@ -117,7 +117,7 @@ status_t rt_build(RenderTarget rt_in, vec2i screen) {
   // framebuffer
   if (!rt->handle) {
     glGenFramebuffers(1, &rt->handle);
-    glBindFramebuffer(GL_FRAMEBUFFER, rt->handle);
+    gl_bind_framebuffer(GL_FRAMEBUFFER, rt->handle);
   }
 
   // depth and stencil
@@ -193,7 +193,7 @@ void rt_reset(RenderTarget rt_in) {
   RT_INTERNAL;
 
   if (rt->handle) {
-    glDeleteFramebuffers(1, &rt->handle);
+    gl_delete_framebuffers(1, &rt->handle);
     rt->handle = 0;
   }
 
@@ -223,13 +223,13 @@ void rt_bind(RenderTarget rt_in) {
     return;
   }
 
-  glBindFramebuffer(GL_FRAMEBUFFER, rt->handle);
+  gl_bind_framebuffer(GL_FRAMEBUFFER, rt->handle);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 void rt_bind_default(void) {
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  gl_bind_framebuffer(GL_FRAMEBUFFER, 0);
   glBindRenderbuffer(GL_RENDERBUFFER, 0);
 }
 
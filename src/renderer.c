@@ -27,19 +27,29 @@
 #include "game.h"
 #include "gl.h"
 
+#include <stdlib.h>
+#include <string.h>
+#include <math.h> // sqrtf
+
 ////////////////////////////////////////////////////////////////////////////////
 // Clears instance data and resets bookkeeping values
 ////////////////////////////////////////////////////////////////////////////////
 
+static void _render_group_release(render_group_t* group);
+
+// The groups are dropped along with their GPU buffers, so none outlive the
+//    models and materials in their keys once a scene's assets are released
 void renderer_clear_instances(renderer_t* renderer) {
-  if (renderer->groups) {
-    render_group_t* map_foreach(group, renderer->groups) {
-      group->update_range_low = -1;
-      group->update_range_high = -1;
-      group->update_full = false;
-      if (group->instances) pmap_clear(group->instances);
-    }
+  if (!renderer->groups) return;
+
+  render_group_t* map_foreach(group, renderer->groups) {
+    _render_group_release(group);
+    pmap_delete(&group->instances);
   }
+
+  map_rg_clear(renderer->groups);
+  if (renderer->draw_list) arr_clear(renderer->draw_list);
+  renderer->draw_list_dirty = true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -106,22 +116,66 @@ void renderer_entity_unregister(Entity entity) {
 // "Default" callback functions to use for renderers (still need to assign)
 ////////////////////////////////////////////////////////////////////////////////
 
-static void _render_group_expand_update_range(
-  render_group_t* group, slotkey_t key
-) {
-  index_t index = pmap_index(group->instances, key);
-  if (index == group->instances->size) return;
-
-  if (group->update_range_low < 0) {
-    group->update_range_low = index;
-    group->update_range_high = index;
-  }
-  else if (index < group->update_range_low) {
-    group->update_range_low = index;
+// Marks a single instance index as needing upload. Ranges are kept sorted and
+//    non-touching, and when there are too many, the two closest are merged.
+void render_group_mark_dirty(render_group_t* group, index_t index) {
+  assert(group);
+  assert(index >= 0);
+  if (group->update_full) return;
+
+  render_range_t* ranges = group->update_ranges;
+  index_t count = group->update_range_count;
+
+  // find the first range that ends at or after the index (minus adjacency)
+  index_t i = 0;
+  while (i < count && ranges[i].high + 1 < index) ++i;
+
+  if (i < count && ranges[i].low <= index + 1) {
+    // index touches or is inside range i, so extend it
+    ranges[i].low = MIN(ranges[i].low, index);
+    ranges[i].high = MAX(ranges[i].high, index);
+
+    // extending may have made it touch the next range
+    if (i + 1 < count && ranges[i + 1].low <= ranges[i].high + 1) {
+      ranges[i].high = MAX(ranges[i].high, ranges[i + 1].high);
+      for (index_t j = i + 1; j < count - 1; ++j) ranges[j] = ranges[j + 1];
+      --group->update_range_count;
+    }
+    return;
   }
-  else if (index > group->update_range_high) {
-    group->update_range_high = index;
+
+  // no room for a new range, merge the closest pair to make some
+  if (count == RENDER_GROUP_MAX_RANGES) {
+    index_t merge = 0;
+    index_t best_gap = ranges[1].low - ranges[0].high;
+    for (index_t j = 1; j < count - 1; ++j) {
+      index_t gap = ranges[j + 1].low - ranges[j].high;
+      if (gap < best_gap) {
+        best_gap = gap;
+        merge = j;
+      }
+    }
+
+    ranges[merge].high = ranges[merge + 1].high;
+    for (index_t j = merge + 1; j < count - 1; ++j) ranges[j] = ranges[j + 1];
+    group->update_range_count = count - 1;
+
+    // the merged range might now contain the index, so search again
+    render_group_mark_dirty(group, index);
+    return;
   }
+
+  for (index_t j = count; j > i; --j) ranges[j] = ranges[j - 1];
+  ranges[i] = (render_range_t){ index, index };
+  group->update_range_count = count + 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void _render_group_mark_dirty_key(render_group_t* group, slotkey_t key) {
+  index_t index = pmap_index(group->instances, key);
+  if (index == group->instances->size) return;
+  render_group_mark_dirty(group, index);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -131,8 +185,16 @@ static void _renderer_callback_unregister_internal(
 ) {
   render_group_t* group = map_rg_ref(e->renderer->groups, key);
   if (!group) return;
+
+  index_t index = pmap_index(group->instances, e->render_id);
+  if (index == group->instances->size) return;
   pmap_remove(group->instances, e->render_id);
-  group->update_full = true;
+
+  // Removal moves the last instance into the freed slot, so that's the only
+  //    slot with new data. The old last slot just drops off the draw count.
+  if (index < group->instances->size) {
+    render_group_mark_dirty(group, index);
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -168,28 +230,31 @@ slotkey_t renderer_callback_entity_register(Entity e, Game game) {
   res_ensure_rg_t group_slot = map_rg_ensure(e->renderer->groups, key);
 
   if (group_slot.is_new) {
+    e->renderer->draw_list_dirty = true;
     attribute_format_t attrib_format = e->renderer->shader->attrib_format;
     *group_slot.value = (render_group_t) {
       .instances = ipmap_new(attribute_size(attrib_format)),
       .material = e->material,
       .model = e->model,
       .is_static = e->is_static,
-      .update_range_low = -1,
-      .update_range_high = -1,
+      .update_range_count = 0,
       .update_full = 1,
+      .ring.active = !e->is_static
+        && e->renderer->buffer_mode == RENDERER_BUFFER_RING,
     };
   }
 
   // add instance to the group and save its instance id
   PackedMap instances = group_slot.value->instances;
-  index_t old_capacity = instances->capacity;
   slotkey_t ret;
   void* att = pmap_emplace(instances, &ret);
   assert(att);
 
   _renderer_set_attributes(e, att);
 
-  group_slot.value->update_full = true;
+  // new instances are appended, so only the last slot needs to be sent (the
+  //    upload reallocates the buffer if it no longer fits)
+  render_group_mark_dirty(group_slot.value, instances->size - 1);
 
   return ret;
 }
@@ -217,7 +282,7 @@ slotkey_t renderer_callback_entity_update(Entity e) {
   assert(att);
 
   _renderer_set_attributes(e, att);
-  _render_group_expand_update_range(group, e->render_id);
+  _render_group_mark_dirty_key(group, e->render_id);
 
   return e->render_id;
 }
@@ -239,7 +304,7 @@ void* renderer_callback_entity_attributes(Entity e, bool update) {
   assert(attributes);
 
   if (update) {
-    _render_group_expand_update_range(group, e->render_id);
+    _render_group_mark_dirty_key(group, e->render_id);
   }
 
   return attributes;
@@ -255,40 +320,522 @@ void renderer_callback_entity_unregister(entity_t* e) {
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// Allocates the instance buffer to the packed map's capacity so that appending
+//    instances doesn't require reallocating until the map itself grows.
+static void _render_group_buffer_alloc(render_group_t* group) {
+  PackedMap instances = group->instances;
+  index_t capacity = MAX(instances->capacity, instances->size);
+
+  glBufferData(GL_ARRAY_BUFFER
+  , instances->element_size * capacity
+  , NULL
+  , group->is_static ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW
+  );
+
+  glBufferSubData(GL_ARRAY_BUFFER, 0, instances->size_bytes, instances->begin);
+  group->buffer_capacity = capacity;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void _render_group_ring_update(render_group_t* group);
+
 void renderer_callback_instance_update(render_group_t* group) {
-  assert(group->update_range_low >= 0);
-  assert(group->update_range_high >= 0);
-  assert(group->update_range_low < group->instances->size);
-  assert(group->update_range_high <= group->instances->size);
-  //assert(group->instance_buffer);
+  assert(group);
+  assert(group->instances);
+
+  // culled groups re-upload their visible set when drawn, except for groups
+  //    drawn indirectly, which read from the full buffer kept below
+  if (group->visible.active) {
+    group->visible.stale = true;
+    if (!group->visible.indirect) return;
+  }
+
+  if (group->ring.active) {
+    _render_group_ring_update(group);
+    return;
+  }
 
+  // the buffer gets fully populated when the VAO is first created
   if (!group->instance_buffer) return;
 
-  // adding one to the count because range_high is inclusive
-  index_t update_count = group->update_range_high - group->update_range_low + 1;
+  PackedMap instances = group->instances;
+  byte* data_start = instances->begin;
+  size_t element_size = instances->element_size;
 
-  glBindBuffer(GL_ARRAY_BUFFER, group->instance_buffer);
+  gl_bind_buffer(GL_ARRAY_BUFFER, group->instance_buffer);
 
-  // update all instances if there are lots of them
-  // (will also be triggered if a full upload is required for expanding the set)
-  if (update_count > group->instances->size / 2) {
-    glBufferData(GL_ARRAY_BUFFER
-    , group->instances->size_bytes
-    , group->instances->begin
-    , group->is_static ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW
-    );
+  // reallocate when the set outgrew the buffer (or a full update was asked for)
+  if (group->update_full || instances->size > group->buffer_capacity) {
+    _render_group_buffer_alloc(group);
+    gl_bind_buffer(GL_ARRAY_BUFFER, 0);
+    return;
+  }
+
+  index_t update_count = 0;
+  for (index_t i = 0; i < group->update_range_count; ++i) {
+    const render_range_t* range = &group->update_ranges[i];
+    update_count += range->high - range->low + 1;
   }
-  // update a range if we only have a few changes
-  else {
-    byte* data_start = group->instances->begin;
+
+  // update all instances in one call if most of them changed anyway
+  if (update_count > instances->size / 2) {
+    glBufferSubData(GL_ARRAY_BUFFER, 0, instances->size_bytes, data_start);
+  }
+  // otherwise only send the ranges that changed
+  else for (index_t i = 0; i < group->update_range_count; ++i) {
+    const render_range_t* range = &group->update_ranges[i];
+    index_t count = range->high - range->low + 1;
     glBufferSubData(GL_ARRAY_BUFFER
-    , group->instances->element_size * group->update_range_low
-    , group->instances->element_size * update_count
-    , group->instances->element_size * group->update_range_low + data_start
+    , element_size * range->low
+    , element_size * count
+    , element_size * range->low + data_start
     );
   }
 
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  gl_bind_buffer(GL_ARRAY_BUFFER, 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Ring-buffered instance storage for dynamic groups
+////////////////////////////////////////////////////////////////////////////////
+
+#define RENDER_RING_MIN_CAPACITY 16
+
+#ifndef __WASM__
+
+// Persistent mapping needs GL 4.4 or ARB_buffer_storage, even though the
+//    context itself only asks for 4.3.
+static bool _gl_has_buffer_storage(void) {
+  static int supported = -1;
+  if (supported >= 0) return supported;
+
+  GLint major = 0, minor = 0, count = 0;
+  glGetIntegerv(GL_MAJOR_VERSION, &major);
+  glGetIntegerv(GL_MINOR_VERSION, &minor);
+  supported = major > 4 || (major == 4 && minor >= 4);
+
+  glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+  for (GLint i = 0; i < count && !supported; ++i) {
+    const char* ext = (const char*)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+    supported = ext && strcmp(ext, "GL_ARB_buffer_storage") == 0;
+  }
+
+  return supported;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Blocks until the GPU is done with a slot. With three slots in flight this
+//    should essentially always be signaled already.
+static void _render_ring_wait(render_ring_t* ring, index_t slot) {
+  GLsync fence = (GLsync)ring->fences[slot];
+  if (!fence) return;
+
+  GLbitfield flags = 0;
+  for (;;) {
+    GLenum res = glClientWaitSync(fence, flags, 1000000); // 1ms
+    if (res == GL_ALREADY_SIGNALED || res == GL_CONDITION_SATISFIED) break;
+    if (res == GL_WAIT_FAILED) {
+      str_log("[Renderer.ring] Fence wait failed");
+      break;
+    }
+    flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+  }
+
+  glDeleteSync(fence);
+  ring->fences[slot] = NULL;
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void _render_group_ring_delete(render_group_t* group) {
+  render_ring_t* ring = &group->ring;
+
+  for (index_t i = 0; i < RENDER_GROUP_RING_SIZE; ++i) {
+#ifndef __WASM__
+    if (ring->fences[i]) {
+      glDeleteSync((GLsync)ring->fences[i]);
+    }
+    if (ring->mapped[i]) {
+      gl_bind_buffer(GL_ARRAY_BUFFER, ring->buffers[i]);
+      glUnmapBuffer(GL_ARRAY_BUFFER);
+    }
+#endif
+    if (ring->vaos[i]) gl_delete_vertex_arrays(1, &ring->vaos[i]);
+    if (ring->buffers[i]) gl_delete_buffers(1, &ring->buffers[i]);
+    ring->fences[i] = NULL;
+    ring->mapped[i] = NULL;
+    ring->vaos[i] = 0;
+    ring->buffers[i] = 0;
+  }
+
+  gl_bind_buffer(GL_ARRAY_BUFFER, 0);
+  ring->capacity = 0;
+  ring->current = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void _render_group_ring_create(Shader s, render_group_t* group) {
+  render_ring_t* ring = &group->ring;
+  PackedMap instances = group->instances;
+
+  index_t capacity = MAX(instances->capacity, RENDER_RING_MIN_CAPACITY);
+  while (capacity < instances->size) capacity *= 2;
+  size_t bytes = instances->element_size * capacity;
+
+#ifdef __WASM__
+  ring->persistent = false;
+#else
+  ring->persistent = _gl_has_buffer_storage();
+#endif
+
+  index_t slots = ring->persistent ? RENDER_GROUP_RING_SIZE : 1;
+
+  for (index_t i = 0; i < slots; ++i) {
+    glGenVertexArrays(1, &ring->vaos[i]);
+    gl_bind_vertex_array(ring->vaos[i]);
+
+    model_bind(group->model);
+
+    glGenBuffers(1, &ring->buffers[i]);
+    gl_bind_buffer(GL_ARRAY_BUFFER, ring->buffers[i]);
+
+#ifndef __WASM__
+    if (ring->persistent) {
+      GLbitfield flags =
+        GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+      glBufferStorage(GL_ARRAY_BUFFER, (GLsizeiptr)bytes, NULL, flags);
+      ring->mapped[i] =
+        glMapBufferRange(GL_ARRAY_BUFFER, 0, (GLsizeiptr)bytes, flags);
+      assert(ring->mapped[i]);
+    }
+    else
+#endif
+    {
+      glBufferData(GL_ARRAY_BUFFER, bytes, NULL, GL_STREAM_DRAW);
+    }
+
+    shader_bind_attributes(s);
+  }
+
+  gl_bind_vertex_array(0);
+
+  ring->capacity = capacity;
+  ring->current = slots - 1;
+
+  // push the initial instance set into the first slot
+  _render_group_ring_update(group);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Writes count instances into the next slot. Every slot holds a copy from a
+//    different frame, so partial ranges can't be applied to them.
+static void _render_group_ring_write(
+  render_group_t* group, const void* data, index_t count
+) {
+  render_ring_t* ring = &group->ring;
+  size_t size_bytes = group->instances->element_size * count;
+  assert(count <= ring->capacity);
+
+#ifndef __WASM__
+  if (ring->persistent) {
+    index_t next = (ring->current + 1) % RENDER_GROUP_RING_SIZE;
+    _render_ring_wait(ring, next);
+    memcpy(ring->mapped[next], data, size_bytes);
+    ring->current = next;
+    return;
+  }
+#endif
+
+  // orphan the old storage so the driver can hand back fresh memory instead
+  //    of waiting for draws still reading the previous contents
+  size_t bytes = group->instances->element_size * ring->capacity;
+  gl_bind_buffer(GL_ARRAY_BUFFER, ring->buffers[0]);
+  glBufferData(GL_ARRAY_BUFFER, bytes, NULL, GL_STREAM_DRAW);
+  glBufferSubData(GL_ARRAY_BUFFER, 0, size_bytes, data);
+  gl_bind_buffer(GL_ARRAY_BUFFER, 0);
+  ring->current = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Writes the full instance set into the next slot
+static void _render_group_ring_update(render_group_t* group) {
+  render_ring_t* ring = &group->ring;
+  PackedMap instances = group->instances;
+
+  // not created yet, creation will do the first upload
+  if (!ring->vaos[0]) return;
+
+  // out of room, the ring gets rebuilt at the next draw with the full set
+  if (instances->size > ring->capacity) {
+    _render_group_ring_delete(group);
+    return;
+  }
+
+  _render_group_ring_write(group, instances->begin, instances->size);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Marks the slot that was just drawn from so it won't be overwritten until the
+//    GPU has finished with it
+static void _render_group_ring_fence(render_group_t* group) {
+#ifndef __WASM__
+  render_ring_t* ring = &group->ring;
+  if (!ring->persistent) return;
+
+  index_t slot = ring->current;
+  if (ring->fences[slot]) {
+    glDeleteSync((GLsync)ring->fences[slot]);
+  }
+  ring->fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+#else
+  UNUSED(group);
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Frustum culling of instances
+////////////////////////////////////////////////////////////////////////////////
+
+#define RENDER_VISIBLE_MIN_CAPACITY 16
+
+// Culling reads the instance's transform, which has to be the first attribute
+static bool _renderer_can_cull(renderer_t* renderer, render_group_t* group) {
+  if (!renderer->frustum_cull) return false;
+  if (group->model->bounds_radius <= 0) return false;
+
+  switch (renderer->shader->attrib_format) {
+    case AF_TRANSFORM_ONLY:
+    case AF_TINT:
+    case AF_MATERIAL:
+    case AF_MATERIAL_TINT:
+      return true;
+    default:
+      return false;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static bool _instance_visible(
+  const frustum_t* frustum, const mat4* transform, vec3 center, float radius
+) {
+  vec3 world = mv4mul(*transform, p34(center)).xyz;
+
+  // conservative radius for non-uniform scale is the largest axis scale
+  vec3 x = transform->col[0].xyz;
+  vec3 y = transform->col[1].xyz;
+  vec3 z = transform->col[2].xyz;
+  float scale_sq = MAX(MAX(v3dot(x, x), v3dot(y, y)), v3dot(z, z));
+
+  return frustum_test_sphere(frustum, world, radius * sqrtf(scale_sq));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void _render_group_visible_reserve(render_group_t* group, index_t n) {
+  render_visible_t* vis = &group->visible;
+  if (n <= vis->capacity) return;
+
+  index_t capacity = MAX(vis->capacity * 2, RENDER_VISIBLE_MIN_CAPACITY);
+  while (capacity < n) capacity *= 2;
+
+  void* data = realloc(vis->data, group->instances->element_size * capacity);
+  index_t* indices = realloc(vis->indices, sizeof(index_t) * capacity);
+  assert(data);
+  assert(indices);
+
+  vis->data = data;
+  vis->indices = indices;
+  vis->capacity = capacity;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void _render_group_visible_create(Shader s, render_group_t* group) {
+  render_visible_t* vis = &group->visible;
+
+  _render_group_visible_reserve(group, group->instances->size);
+
+  glGenVertexArrays(1, &vis->vao);
+  gl_bind_vertex_array(vis->vao);
+
+  model_bind(group->model);
+
+  glGenBuffers(1, &vis->buffer);
+  gl_bind_buffer(GL_ARRAY_BUFFER, vis->buffer);
+  glBufferData(GL_ARRAY_BUFFER
+  , group->instances->element_size * vis->capacity
+  , NULL
+  , GL_STREAM_DRAW
+  );
+
+  shader_bind_attributes(s);
+  gl_bind_vertex_array(0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Static groups can keep their full instance buffer and draw only the visible
+//    runs of it, which needs indirect draws with a base instance. WebGL2 has
+//    neither, so there they draw a compacted copy like any other group.
+static bool _render_group_indirect(const render_group_t* group) {
+#ifdef __WASM__
+  UNUSED(group);
+  return false;
+#else
+  return group->is_static && model_can_render_indirect(group->model);
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __WASM__
+
+// Turns the visible indices into one draw command per contiguous run and sends
+//    them to the group's indirect buffer
+static void _render_group_commands_upload(render_group_t* group) {
+  render_visible_t* vis = &group->visible;
+  assert(group->instances->element_size >= sizeof(model_draw_cmd_t));
+
+  // commands never outnumber the visible instances, so the staging fits them
+  model_draw_cmd_t* cmds = vis->data;
+  index_t cmd_count = 0;
+
+  for (index_t i = 0; i < vis->count;) {
+    index_t start = vis->indices[i];
+    index_t len = 1;
+    while (i + len < vis->count && vis->indices[i + len] == start + len) ++len;
+
+    cmds[cmd_count++] = model_draw_cmd(group->model, start, len);
+    i += len;
+  }
+
+  if (!vis->commands) glGenBuffers(1, &vis->commands);
+  gl_bind_buffer(GL_DRAW_INDIRECT_BUFFER, vis->commands);
+  glBufferData(GL_DRAW_INDIRECT_BUFFER
+  , sizeof(model_draw_cmd_t) * cmd_count
+  , cmds
+  , GL_STREAM_DRAW
+  );
+  gl_bind_buffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+  vis->command_count = cmd_count;
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Builds the list of visible instances and sends them where the group draws
+//    from: the next ring slot for dynamic groups, an indirect command list for
+//    static groups that support it, or else a compacted copy in its own
+//    buffer. Nothing is sent if neither the instances nor the visible set
+//    changed since the last frame. Returns the number of visible instances.
+static index_t _render_group_cull(
+  render_group_t* group, const frustum_t* frustum
+) {
+  render_visible_t* vis = &group->visible;
+  PackedMap instances = group->instances;
+  const char* src = instances->begin;
+  size_t stride = instances->element_size;
+  vec3 center = group->model->bounds_center;
+  float radius = group->model->bounds_radius;
+
+  _render_group_visible_reserve(group, instances->size);
+
+  bool changed = vis->stale;
+  index_t count = 0;
+
+  for (index_t i = 0; i < instances->size; ++i) {
+    const mat4* transform = (const mat4*)(src + stride * i);
+    if (!_instance_visible(frustum, transform, center, radius)) continue;
+
+    if (!changed && (count >= vis->count || vis->indices[count] != i)) {
+      changed = true;
+    }
+
+    vis->indices[count++] = i;
+  }
+
+  if (!changed && count == vis->count) return count;
+
+  vis->count = count;
+  vis->stale = false;
+
+#ifndef __WASM__
+  if (vis->indirect) {
+    _render_group_commands_upload(group);
+    return count;
+  }
+#endif
+
+  char* dst = vis->data;
+  for (index_t i = 0; i < count; ++i) {
+    memcpy(dst + stride * i, src + stride * vis->indices[i], stride);
+  }
+
+  if (group->ring.active) {
+    _render_group_ring_write(group, vis->data, count);
+    return count;
+  }
+
+  gl_bind_buffer(GL_ARRAY_BUFFER, vis->buffer);
+  glBufferData(GL_ARRAY_BUFFER, stride * vis->capacity, NULL, GL_STREAM_DRAW);
+  glBufferSubData(GL_ARRAY_BUFFER, 0, stride * count, vis->data);
+  gl_bind_buffer(GL_ARRAY_BUFFER, 0);
+
+  return count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Instance buffers for the full set aren't kept updated while a group draws
+//    from its culled set, so they need to be refreshed when culling stops.
+static void _render_group_visible_release(render_group_t* group) {
+  group->visible.active = false;
+
+  // indirect groups kept drawing from the full buffer, so it's current
+  if (group->visible.indirect) {
+    group->visible.indirect = false;
+  }
+  else if (group->ring.active) {
+    if (group->ring.vaos[0]) _render_group_ring_delete(group);
+  }
+  else if (group->instance_buffer) {
+    gl_bind_buffer(GL_ARRAY_BUFFER, group->instance_buffer);
+    _render_group_buffer_alloc(group);
+    gl_bind_buffer(GL_ARRAY_BUFFER, 0);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Deletes every buffer and VAO the group has made: the full instance buffer,
+//    the ring slots and the culled copy
+static void _render_group_release(render_group_t* group) {
+  if (group->vao) gl_delete_vertex_arrays(1, &group->vao);
+  if (group->instance_buffer) gl_delete_buffers(1, &group->instance_buffer);
+  group->vao = 0;
+  group->instance_buffer = 0;
+  group->buffer_capacity = 0;
+
+  if (group->ring.vaos[0]) _render_group_ring_delete(group);
+
+  render_visible_t* vis = &group->visible;
+  if (vis->vao) gl_delete_vertex_arrays(1, &vis->vao);
+  if (vis->buffer) gl_delete_buffers(1, &vis->buffer);
+  if (vis->commands) gl_delete_buffers(1, &vis->commands);
+  free(vis->indices);
+  free(vis->data);
+  *vis = (render_visible_t) { 0 };
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -304,21 +851,137 @@ static void _renderer_create_vao(Shader s, render_group_t* group) {
   assert(group->instances);
 
   glGenVertexArrays(1, &group->vao);
-  glBindVertexArray(group->vao);
+  gl_bind_vertex_array(group->vao);
 
   model_bind(group->model);
 
   glGenBuffers(1, &group->instance_buffer);
-  glBindBuffer(GL_ARRAY_BUFFER, group->instance_buffer);
-  glBufferData(GL_ARRAY_BUFFER
-  , group->instances->size_bytes
-  , group->instances->begin
-  , group->is_static ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW
-  );
+  gl_bind_buffer(GL_ARRAY_BUFFER, group->instance_buffer);
+  _render_group_buffer_alloc(group);
 
   shader_bind_attributes(s);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Sorted draw list
+////////////////////////////////////////////////////////////////////////////////
+
+// Sort keys, from the most significant bit down:
+//    opaque:      0 | shader:15 | material:16 | model:16 | depth:16
+//    translucent: 1 | inverse depth:16 | shader:15 | material:16 | model:16
+// Opaque groups sharing state end up next to each other and translucent ones
+//    are drawn last, back to front. Object fields are folded pointers, where a
+//    collision only costs an extra rebind. Opaque groups aren't re-sorted per
+//    frame, so their depth bucket is always zero.
+#define RENDER_KEY_TRANSLUCENT  (1ull << 63)
+#define RENDER_KEY_DEPTH_MAX    0xFFFFull
+
+static uint64_t _render_key_fold(const void* ptr, int bits) {
+  uint64_t h = (uint64_t)(uintptr_t)ptr >> 4;
+  h ^= h >> 16;
+  h ^= h >> 32;
+  return h & ((1ull << bits) - 1);
+}
+
+static bool _render_group_translucent(const render_group_t* group) {
+  return group->material && group->material->params.translucent;
+}
+
+static uint64_t _render_key(
+  Shader shader, const render_group_t* group, uint64_t depth
+) {
+  uint64_t state = _render_key_fold(shader, 15) << 32
+                 | _render_key_fold(group->material, 16) << 16
+                 | _render_key_fold(group->model, 16);
+
+  if (!_render_group_translucent(group)) return state << 16;
+  return RENDER_KEY_TRANSLUCENT | (RENDER_KEY_DEPTH_MAX - depth) << 47 | state;
+}
+
+// Distance from the camera to the middle of the group's instances, bucketed
+//    over the camera's depth range
+static uint64_t _render_group_depth(
+  const render_group_t* group, const camera_t* camera
+) {
+  PackedMap instances = group->instances;
+  if (!instances || !instances->size) return RENDER_KEY_DEPTH_MAX;
+
+  const char* src = instances->begin;
+  size_t stride = instances->element_size;
+  vec3 center = v3zero;
+
+  for (index_t i = 0; i < instances->size; ++i) {
+    const mat4* transform = (const mat4*)(src + stride * i);
+    center = v3add(center, transform->col[3].xyz);
+  }
+
+  center = v3scale(center, 1.f / (float)instances->size);
+  float depth = v3dist(center, camera->pos) / camera->perspective.far;
+  depth = MIN(MAX(depth, 0.f), 1.f);
+  return (uint64_t)(depth * (float)RENDER_KEY_DEPTH_MAX);
+}
+
+static int _render_draw_order(const void* a, const void* b) {
+  uint64_t key_a = ((const render_draw_t*)a)->key;
+  uint64_t key_b = ((const render_draw_t*)b)->key;
+  return (key_a > key_b) - (key_a < key_b);
+}
+
+// Rebuilt only when groups are added, since map storage may have moved. The
+//    translucent tail is re-keyed and re-sorted every frame as the camera
+//    moves.
+static void _renderer_sort_groups(renderer_t* renderer, const camera_t* cam) {
+  if (!renderer->draw_list) renderer->draw_list = arr_new(render_draw_t);
+
+  if (renderer->draw_list_dirty
+  ||  renderer->draw_list->size != renderer->groups->size
+  ) {
+    arr_clear(renderer->draw_list);
+
+    render_group_t* map_foreach(group, renderer->groups) {
+      render_draw_t draw = {
+        .key = _render_key(renderer->shader, group, 0),
+        .group = group,
+      };
+      arr_insert_back(renderer->draw_list, &draw);
+    }
+
+    qsort(renderer->draw_list->begin
+    , (size_t)renderer->draw_list->size
+    , sizeof(render_draw_t)
+    , _render_draw_order
+    );
+
+    render_draw_t* draws = (render_draw_t*)renderer->draw_list->begin;
+    index_t first = 0;
+    while (first < renderer->draw_list->size
+    &&    !(draws[first].key & RENDER_KEY_TRANSLUCENT)
+    ) ++first;
+
+    renderer->draw_list_translucent = first;
+    renderer->draw_list_dirty = false;
+  }
+
+  render_draw_t* draws = (render_draw_t*)renderer->draw_list->begin;
+  index_t first = renderer->draw_list_translucent;
+  index_t count = renderer->draw_list->size - first;
+  if (count <= 0) return;
+
+  for (index_t i = first; i < renderer->draw_list->size; ++i) {
+    render_group_t* group = draws[i].group;
+    uint64_t depth = _render_group_depth(group, cam);
+    draws[i].key = _render_key(renderer->shader, group, depth);
+  }
+
+  if (count > 1) {
+    qsort(draws + first, (size_t)count, sizeof(render_draw_t)
+    , _render_draw_order
+    );
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Instanced rendering pass
 ////////////////////////////////////////////////////////////////////////////////
 
 bool renderer_callback_render(renderer_t* renderer, Game game) {
@@ -331,28 +994,115 @@ bool renderer_callback_render(renderer_t* renderer, Game game) {
   assert(shader);
   if (!shader_bind(renderer->shader)) return false;
 
-  // apply globally shared uniforms
-  int loc_proj_view = shader_uniform_loc(shader, "in_pv_matrix");
-  int loc_view = shader_uniform_loc(shader, "in_view_matrix");
-  glUniformMatrix4fv(loc_proj_view, 1, 0, game->camera.projview.f);
-  glUniformMatrix4fv(loc_view, 1, 0, game->camera.view.f);
+  // camera matrices come from the FrameConstants block (gfx_update_frame)
 
-  // render each individual render group as batches
-  render_group_t* map_foreach(group, renderer->groups) {
+  frustum_t frustum = camera_frustum(&game->camera);
+  renderer->stats = (renderer_stats_t){ 0 };
+
+  _renderer_sort_groups(renderer, &game->camera);
+  Material bound_material = NULL;
+
+  // render each individual render group as batches, in draw list order
+  render_draw_t* arr_foreach(draw, renderer->draw_list) {
+    render_group_t* group = draw->group;
     if (!group->instances || !group->instances->size) continue;
 
-    shader_bind_material(renderer->shader, group->material);
+    index_t count = group->instances->size;
+    renderer->stats.instances_total += count;
+
+    // culled groups draw only their visible instances
+    if (_renderer_can_cull(renderer, group)) {
+      render_visible_t* vis = &group->visible;
+      if (!vis->active) {
+        vis->active = true;
+        vis->stale = true;
+        vis->indirect = _render_group_indirect(group);
+      }
+
+      // the ring has to fit every instance, as any of them may be visible
+      if (group->ring.active) {
+        if (group->ring.vaos[0] && count > group->ring.capacity) {
+          _render_group_ring_delete(group);
+        }
+        if (!group->ring.vaos[0]) {
+          _render_group_ring_create(shader, group);
+          vis->stale = true;
+        }
+      }
+      else if (vis->indirect) {
+        if (!group->vao) _renderer_create_vao(shader, group);
+      }
+      else if (!vis->vao) {
+        _render_group_visible_create(shader, group);
+      }
+
+      count = _render_group_cull(group, &frustum);
+      renderer->stats.instances_culled += group->instances->size - count;
+
+      if (!count) {
+        ++renderer->stats.groups_culled;
+        continue;
+      }
+
+      renderer->stats.instances_drawn += count;
+      mat_prioritize(group->material);
+      if (group->material != bound_material) {
+        shader_bind_material(renderer->shader, group->material);
+        bound_material = group->material;
+      }
+
+      if (group->ring.active) {
+        gl_bind_vertex_array(group->ring.vaos[group->ring.current]);
+        model_render_instanced(group->model, count);
+        _render_group_ring_fence(group);
+      }
+#ifndef __WASM__
+      else if (vis->indirect) {
+        gl_bind_vertex_array(group->vao);
+        gl_bind_buffer(GL_DRAW_INDIRECT_BUFFER, vis->commands);
+        model_render_indirect(group->model, vis->command_count);
+        gl_bind_buffer(GL_DRAW_INDIRECT_BUFFER, 0);
+      }
+#endif
+      else {
+        gl_bind_vertex_array(vis->vao);
+        model_render_instanced(group->model, count);
+      }
+      continue;
+    }
 
+    if (group->visible.active) {
+      _render_group_visible_release(group);
+    }
+
+    renderer->stats.instances_drawn += count;
+    mat_prioritize(group->material);
+    if (group->material != bound_material) {
+      shader_bind_material(renderer->shader, group->material);
+      bound_material = group->material;
+    }
+
+    // dynamic groups in ring mode draw from the most recently written slot
+    if (group->ring.active) {
+      if (!group->ring.vaos[0]) {
+        _render_group_ring_create(shader, group);
+      }
+      gl_bind_vertex_array(group->ring.vaos[group->ring.current]);
+    }
     // if the group's VAO hasn't been set, create it
-    if (!group->vao) {
+    else if (!group->vao) {
       _renderer_create_vao(shader, group);
     }
     else {
-      glBindVertexArray(group->vao);
+      gl_bind_vertex_array(group->vao);
     }
 
-    model_render_instanced(group->model, group->instances->size);
-    glBindVertexArray(0);
+    // the VAO is left bound, the next group's bind replaces it if different
+    model_render_instanced(group->model, count);
+
+    if (group->ring.active) {
+      _render_group_ring_fence(group);
+    }
   }
 
   return true;
@@ -67,6 +67,12 @@ typedef struct gl_shader_t {
 #undef con_type
 #undef con_prefix
 
+// Location not looked up yet, as opposed to -1 for names the shader lacks
+#define SHADER_LOC_UNRESOLVED (-2)
+
+// Longest uniform or attribute name read back from a linked program
+#define SHADER_VAR_NAME_MAX 128
+
 typedef struct Shader_Internal {
   struct _opaque_Shader_t pub;
 
@@ -75,7 +81,9 @@ typedef struct Shader_Internal {
   String    name_internal;
   slice_t   vert_filename;
   slice_t   frag_filename;
-  HMap_int  uniforms;
+  GLint*    uniform_locs;   // indexed by shader_var_t
+  GLint*    attribute_locs; // indexed by shader_var_t
+  index_t   var_capacity;
 } Shader_Internal;
 
 #define con_type Shader_Internal*
@@ -92,6 +100,56 @@ typedef struct Shader_Internal {
 
 static HMap_shader  _all_shaders_map = NULL;
 static HMap_part    _all_parts_map = NULL;
+
+// Interned uniform/attribute names, by name and by id. Never freed.
+static HMap_int     _shader_var_ids = NULL;
+static Array_slice  _shader_var_names = NULL;
+
+static const char* const _shader_var_builtin_names[SV_BUILTIN_COUNT] = {
+  [SV_NONE]                 = "",
+  [SV_IN_PV_MATRIX]         = "in_pv_matrix",
+  [SV_IN_VIEW_MATRIX]       = "in_view_matrix",
+  [SV_IN_PVM_MATRIX]        = "in_pvm_matrix",
+  [SV_IN_NORMAL_MATRIX]     = "in_normal_matrix",
+  [SV_IN_PROJ_INVERSE]      = "in_proj_inverse",
+  [SV_IN_WEIGHTS]           = "in_weights",
+  [SV_IN_TINT]              = "in_tint",
+  [SV_IN_LIGHT_COUNT]       = "in_light_count",
+  [SV_IN_CLUSTER_DIMS]      = "in_cluster_dims",
+  [SV_IN_CLUSTER_DEPTH]     = "in_cluster_depth",
+  [SV_IN_CLUSTER_ENABLED]   = "in_cluster_enabled",
+  [SV_SAMP_TEX]             = "samp_tex",
+  [SV_SAMP_NORM]            = "samp_norm",
+  [SV_SAMP_ROUGH]           = "samp_rough",
+  [SV_SAMP_METAL]           = "samp_metal",
+  [SV_SAMP_PROP]            = "samp_prop",
+  [SV_SAMP_DEPTH]           = "samp_depth",
+  [SV_SAMP_LIGHT]           = "samp_light",
+  [SV_SAMP_LIGHT_GRID]      = "samp_light_grid",
+  [SV_SAMP_LIGHT_INDEX]     = "samp_light_index",
+  [SV_SAMP_FRAME]           = "samp_frame",
+  [SV_MODEL_MATRIX]         = "model_matrix",
+  [SV_MODEL_TINT]           = "model_tint",
+  [SV_MODEL_MATERIAL_INDEX] = "model_material_index",
+  [SV_MODEL_POS]            = "model_pos",
+  [SV_MODEL_SCALE]          = "model_scale",
+};
+
+// Uniform blocks with fixed binding points, see shader_block_binding
+typedef struct shader_block_t {
+  String  name;
+  uint    binding;
+} shader_block_t;
+
+static array_t _shader_blocks_array = {
+  .element_size = sizeof(shader_block_t)
+};
+
+static Array _shader_blocks = &_shader_blocks_array;
+
+// Name list handed out by shader_get_names, rebuilt after shaders change
+static Array_slice  _shader_names = NULL;
+static bool         _shader_names_stale = true;
 static index_t      _shaders_linked_count = 0;
 
 #define SHADER_INTERNAL                                                       \
@@ -282,14 +340,149 @@ static Shader_Internal* _shader_get_or_create(slice_t name) {
     .name_internal = name_copy,
     .vert_filename = slice_empty,
     .frag_filename = slice_empty,
-    .uniforms = map_int_new(),
+    .uniform_locs = NULL,
+    .attribute_locs = NULL,
+    .var_capacity = 0,
   };
 
   map_shader_insert(_all_shaders_map, ret->pub.name, ret);
+  _shader_names_stale = true;
 
   return ret;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Interned names and reflection of linked programs
+////////////////////////////////////////////////////////////////////////////////
+
+static void _shader_vars_init(void) {
+  if (_shader_var_ids) return;
+
+  _shader_var_ids = map_int_new();
+  _shader_var_names = arr_slice_new_reserve(SV_BUILTIN_COUNT * 2);
+  arr_slice_push_back(_shader_var_names, slice_empty);
+
+  for (index_t i = 1; i < SV_BUILTIN_COUNT; ++i) {
+    slice_t name = slice_from_c_str(_shader_var_builtin_names[i]);
+    map_int_insert(_shader_var_ids, name, (GLint)i);
+    arr_slice_push_back(_shader_var_names, name);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+shader_var_t shader_var_intern(slice_t name) {
+  assert(!slice_is_empty(name));
+  _shader_vars_init();
+
+  GLint id = map_int_get_or_default(_shader_var_ids, name, -1);
+  if (id >= 0) return (shader_var_t)id;
+
+  // the map keys on the slice, so it needs a copy that outlives the caller's.
+  //    Ids are kept for the life of the program, so this is never freed.
+  String copy = str_copy(name);
+  id = (GLint)_shader_var_names->size;
+  map_int_insert(_shader_var_ids, copy->slice, id);
+  arr_slice_push_back(_shader_var_names, copy->slice);
+
+  return (shader_var_t)id;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Grows the location tables to cover every interned name
+static void _shader_vars_fit(Shader_Internal* s) {
+  index_t size = _shader_var_names->size;
+  if (size <= s->var_capacity) return;
+
+  s->uniform_locs = realloc(s->uniform_locs, sizeof(GLint) * size);
+  s->attribute_locs = realloc(s->attribute_locs, sizeof(GLint) * size);
+  assert(s->uniform_locs);
+  assert(s->attribute_locs);
+
+  for (index_t i = s->var_capacity; i < size; ++i) {
+    s->uniform_locs[i] = SHADER_LOC_UNRESOLVED;
+    s->attribute_locs[i] = SHADER_LOC_UNRESOLVED;
+  }
+
+  s->var_capacity = size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void _shader_apply_block(Shader_Internal* s, const shader_block_t* b) {
+  GLuint index = glGetUniformBlockIndex(s->program_handle, b->name->begin);
+  if (index == GL_INVALID_INDEX) return;
+  glUniformBlockBinding(s->program_handle, index, b->binding);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Reads back the program's active uniforms and attributes and stores their
+//    locations by interned id. Array uniforms are listed as "name[0]", which
+//    is also stored as "name". Members of uniform blocks have no location.
+static void _shader_reflect(Shader_Internal* s) {
+  _shader_vars_init();
+
+  for (index_t i = 0; i < s->var_capacity; ++i) {
+    s->uniform_locs[i] = SHADER_LOC_UNRESOLVED;
+    s->attribute_locs[i] = SHADER_LOC_UNRESOLVED;
+  }
+
+  GLuint program = s->program_handle;
+  GLchar name[SHADER_VAR_NAME_MAX];
+  GLint count = 0;
+
+  glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+  for (GLint i = 0; i < count; ++i) {
+    GLsizei length = 0;
+    GLint size = 0;
+    GLenum type = 0;
+    glGetActiveUniform(
+      program, (GLuint)i, SHADER_VAR_NAME_MAX, &length, &size, &type, name
+    );
+    if (length <= 0) continue;
+
+    GLint loc = glGetUniformLocation(program, name);
+    if (loc < 0) continue;
+
+    slice_t var = slice_build(name, length);
+    if (length > 3 && str_ends_with(var, "[0]")) var.size -= 3;
+
+    shader_var_t id = shader_var_intern(var);
+    _shader_vars_fit(s);
+    s->uniform_locs[id] = loc;
+  }
+
+  glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &count);
+  for (GLint i = 0; i < count; ++i) {
+    GLsizei length = 0;
+    GLint size = 0;
+    GLenum type = 0;
+    glGetActiveAttrib(
+      program, (GLuint)i, SHADER_VAR_NAME_MAX, &length, &size, &type, name
+    );
+    if (length <= 0) continue;
+
+    shader_var_t id = shader_var_intern(slice_build(name, length));
+    _shader_vars_fit(s);
+    s->attribute_locs[id] = glGetAttribLocation(program, name);
+  }
+
+  // names that weren't listed aren't in the shader, except for array
+  //    elements past the first, so mark those as missing up front
+  _shader_vars_fit(s);
+  for (index_t i = 0; i < s->var_capacity; ++i) {
+    if (s->attribute_locs[i] == SHADER_LOC_UNRESOLVED) {
+      s->attribute_locs[i] = -1;
+    }
+  }
+
+  shader_block_t* arr_foreach(block, _shader_blocks) {
+    _shader_apply_block(s, block);
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 static bool _shader_link(Shader_Internal* s, gl_shader_t* v, gl_shader_t* f) {
@@ -317,6 +510,7 @@ static bool _shader_link(Shader_Internal* s, gl_shader_t* v, gl_shader_t* f) {
   glGetProgramiv(s->program_handle, GL_LINK_STATUS, &status);
 
   if (status == GL_TRUE) {
+    _shader_reflect(s);
     s->pub.status = S_READY;
     ++_shaders_linked_count;
     str_log("[Shader.link] Linked: {}", s->pub.name);
@@ -549,13 +743,46 @@ index_t shader_loading_count(void) {
 void shader_delete(Shader* shader) {
   if (!shader || !*shader) return;
   Shader_Internal* s = (Shader_Internal*)*shader;
+
+  // The map is keyed by the name string about to be freed
+  map_shader_remove(_all_shaders_map, s->pub.name);
+  _shader_names_stale = true;
+
   str_delete(&s->name_internal);
-  map_int_delete(&s->uniforms);
+  free(s->uniform_locs);
+  free(s->attribute_locs);
 
   // TODO: Safely free all the shader related memory/handles
   *shader = NULL;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Lookup by name
+////////////////////////////////////////////////////////////////////////////////
+
+Shader shader_get(slice_t name) {
+  if (!_all_shaders_map) return NULL;
+  return (Shader)map_shader_get_or_default(_all_shaders_map, name, NULL);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+view_slice_t shader_get_names(void) {
+  if (!_all_shaders_map) return (view_slice_t) { 0 };
+
+  if (_shader_names_stale) {
+    _shader_names_stale = false;
+    if (_shader_names) arr_slice_delete(&_shader_names);
+
+    _shader_names = arr_slice_new_reserve(_all_shaders_map->size);
+    Shader_Internal** map_foreach(ps, _all_shaders_map) {
+      arr_slice_push_back(_shader_names, (*ps)->pub.name);
+    }
+  }
+
+  return view_slice(_shader_names->begin, _shader_names->size);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Apply the shader for use
 ////////////////////////////////////////////////////////////////////////////////
@@ -563,7 +790,7 @@ void shader_delete(Shader* shader) {
 bool shader_bind(Shader s_in) {
   SHADER_INTERNAL;
   if (s->pub.status != S_READY) return false;
-  glUseProgram(s->program_handle);
+  gl_use_program(s->program_handle);
   return true;
 }
 
@@ -583,11 +810,11 @@ void shader_bind_material(Shader s_in, Material material) {
   assert(material);
 
   // get uniform/attribute locations for active material
-  int loc_sampler_tex =   shader_uniform_loc(s_in, "samp_tex");
-  int loc_sampler_norm =  shader_uniform_loc(s_in, "samp_norm");
-  int loc_sampler_rough = shader_uniform_loc(s_in, "samp_rough");
-  int loc_sampler_metal = shader_uniform_loc(s_in, "samp_metal");
-  int loc_props =         shader_uniform_loc(s_in, "in_weights");
+  int loc_sampler_tex =   shader_uniform_id(s_in, SV_SAMP_TEX);
+  int loc_sampler_norm =  shader_uniform_id(s_in, SV_SAMP_NORM);
+  int loc_sampler_rough = shader_uniform_id(s_in, SV_SAMP_ROUGH);
+  int loc_sampler_metal = shader_uniform_id(s_in, SV_SAMP_METAL);
+  int loc_props =         shader_uniform_id(s_in, SV_IN_WEIGHTS);
 
   // matset_apply(renderer->materials);
   tex_apply(material->map_diffuse, 0, loc_sampler_tex);
@@ -598,47 +825,78 @@ void shader_bind_material(Shader s_in, Material material) {
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// Get a uniform location by name from the shader
+// Get a uniform location by interned name from the shader
 ////////////////////////////////////////////////////////////////////////////////
 
-int shader_uniform_loc(Shader s_in, const char* name) {
+int shader_uniform_id(Shader s_in, shader_var_t id) {
   SHADER_INTERNAL;
   assert(s->pub.status == S_READY);
+  assert(id > SV_NONE && (index_t)id < _shader_var_names->size);
 
-  slice_t name_slice = slice_from_c_str(name);
-  res_ensure_int_t slot = map_int_ensure(s->uniforms, name_slice);
+  if ((index_t)id >= s->var_capacity) _shader_vars_fit(s);
+  GLint loc = s->uniform_locs[id];
+  if (loc != SHADER_LOC_UNRESOLVED) return loc;
 
-  if (slot.is_new) {
-    *(GLint*)slot.value = glGetUniformLocation(s->program_handle, name);
-    int err = glGetError();
-    if (err) {
-      str_log("[Shader.uniform_loc] Failed: {}, error: 0x{!x}", name, err);
-    }
-  }
+  // not listed by reflection, but may still be an element of an array
+  const char* name = _shader_var_names->begin[id].begin;
+  loc = glGetUniformLocation(s->program_handle, name);
+  s->uniform_locs[id] = loc;
 
-  return *(int*)slot.value;
+  return loc;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// Get an attribute location by name from the shader
+
+int shader_uniform_loc(Shader s_in, const char* name) {
+  return shader_uniform_id(s_in, shader_var_intern(slice_from_c_str(name)));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Get an attribute location by interned name from the shader
 ////////////////////////////////////////////////////////////////////////////////
 
-int shader_attribute_loc(Shader s_in, const char* name) {
+int shader_attribute_id(Shader s_in, shader_var_t id) {
   SHADER_INTERNAL;
   assert(s->pub.status == S_READY);
+  assert(id > SV_NONE && (index_t)id < _shader_var_names->size);
+
+  // every active attribute was listed, so anything newer isn't used
+  if ((index_t)id >= s->var_capacity) return -1;
+  return s->attribute_locs[id];
+}
 
-  slice_t name_slice = slice_from_c_str(name);
-  res_ensure_int_t slot = map_int_ensure(s->uniforms, name_slice);
+////////////////////////////////////////////////////////////////////////////////
 
-  if (slot.is_new) {
-    *slot.value = glGetAttribLocation(s->program_handle, name);
-    int err = glGetError();
-    if (err) {
-      str_log("[Shader.attrib_loc] Failed: {}, error: 0x{!x}", name, err);
-    }
+int shader_attribute_loc(Shader s_in, const char* name) {
+  return shader_attribute_id(s_in, shader_var_intern(slice_from_c_str(name)));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Fixed binding points for uniform blocks
+////////////////////////////////////////////////////////////////////////////////
+
+void shader_block_binding(slice_t block_name, uint binding) {
+  assert(!slice_is_empty(block_name));
+
+  shader_block_t* block = NULL;
+  shader_block_t* arr_foreach(existing, _shader_blocks) {
+    if (str_eq(existing->name->slice, block_name)) block = existing;
+  }
+
+  if (!block) {
+    shader_block_t new_block = { .name = str_copy(block_name) };
+    arr_insert_back(_shader_blocks, &new_block);
+    block = arr_ref(_shader_blocks, _shader_blocks->size - 1);
   }
 
-  return *(int*)slot.value;
+  block->binding = binding;
+
+  if (!_all_shaders_map) return;
+
+  Shader_Internal** map_foreach(pshader, _all_shaders_map) {
+    Shader_Internal* shader = *pshader;
+    if (shader->pub.status == S_READY) _shader_apply_block(shader, block);
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -686,7 +944,7 @@ void _gl_shader_update_program(Shader_Internal* s, gl_shader_t* part) {
   }
 
   --_shaders_linked_count;
-  glDeleteProgram(s->program_handle);
+  gl_delete_program(s->program_handle);
 
   str_log("[Shader.watch] Re-linked: {}", s->pub.name);
 
@@ -696,7 +954,6 @@ void _gl_shader_update_program(Shader_Internal* s, gl_shader_t* part) {
   }
 
   *s = temp;
-  map_int_clear(s->uniforms);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
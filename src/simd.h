@@ -0,0 +1,163 @@
+/*******************************************************************************
+* MIT License
+*
+* Copyright (c) 2026 Curtis McCoy
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#ifndef WASP_SIMD_H_
+#define WASP_SIMD_H_
+
+// Minimal 4-wide float vector wrapper used by the bulk update kernels.
+//    Selects SSE2, NEON (aarch64) or WASM SIMD128 when available, otherwise
+//    falls back to a plain array so the kernels still compile everywhere.
+
+#if defined(__wasm_simd128__)
+# define WASP_SIMD_WASM
+# include <wasm_simd128.h>
+typedef v128_t f4_t;
+#elif defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) \
+  || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# define WASP_SIMD_SSE
+# include <emmintrin.h>
+typedef __m128 f4_t;
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+# define WASP_SIMD_NEON
+# include <arm_neon.h>
+typedef float32x4_t f4_t;
+#else
+# define WASP_SIMD_SCALAR
+typedef struct f4_t { float f[4]; } f4_t;
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+
+static inline f4_t f4load(const float* p) {
+#if defined(WASP_SIMD_WASM)
+  return wasm_v128_load(p);
+#elif defined(WASP_SIMD_SSE)
+  return _mm_loadu_ps(p);
+#elif defined(WASP_SIMD_NEON)
+  return vld1q_f32(p);
+#else
+  return (f4_t){ .f = { p[0], p[1], p[2], p[3] } };
+#endif
+}
+
+static inline void f4store(float* p, f4_t a) {
+#if defined(WASP_SIMD_WASM)
+  wasm_v128_store(p, a);
+#elif defined(WASP_SIMD_SSE)
+  _mm_storeu_ps(p, a);
+#elif defined(WASP_SIMD_NEON)
+  vst1q_f32(p, a);
+#else
+  for (int i = 0; i < 4; ++i) p[i] = a.f[i];
+#endif
+}
+
+static inline f4_t f4set(float s) {
+#if defined(WASP_SIMD_WASM)
+  return wasm_f32x4_splat(s);
+#elif defined(WASP_SIMD_SSE)
+  return _mm_set1_ps(s);
+#elif defined(WASP_SIMD_NEON)
+  return vdupq_n_f32(s);
+#else
+  return (f4_t){ .f = { s, s, s, s } };
+#endif
+}
+
+static inline f4_t f4add(f4_t a, f4_t b) {
+#if defined(WASP_SIMD_WASM)
+  return wasm_f32x4_add(a, b);
+#elif defined(WASP_SIMD_SSE)
+  return _mm_add_ps(a, b);
+#elif defined(WASP_SIMD_NEON)
+  return vaddq_f32(a, b);
+#else
+  for (int i = 0; i < 4; ++i) a.f[i] += b.f[i];
+  return a;
+#endif
+}
+
+static inline f4_t f4mul(f4_t a, f4_t b) {
+#if defined(WASP_SIMD_WASM)
+  return wasm_f32x4_mul(a, b);
+#elif defined(WASP_SIMD_SSE)
+  return _mm_mul_ps(a, b);
+#elif defined(WASP_SIMD_NEON)
+  return vmulq_f32(a, b);
+#else
+  for (int i = 0; i < 4; ++i) a.f[i] *= b.f[i];
+  return a;
+#endif
+}
+
+// \brief Returns a 4-bit mask with bit i set when a[i] > b[i]
+static inline int f4gt_mask(f4_t a, f4_t b) {
+#if defined(WASP_SIMD_WASM)
+  return wasm_i32x4_bitmask(wasm_f32x4_gt(a, b));
+#elif defined(WASP_SIMD_SSE)
+  return _mm_movemask_ps(_mm_cmpgt_ps(a, b));
+#elif defined(WASP_SIMD_NEON)
+  static const int32_t shifts[4] = { 0, 1, 2, 3 };
+  uint32x4_t bits = vshrq_n_u32(vcgtq_f32(a, b), 31);
+  return (int)vaddvq_u32(vshlq_u32(bits, vld1q_s32(shifts)));
+#else
+  int mask = 0;
+  for (int i = 0; i < 4; ++i) mask |= (a.f[i] > b.f[i]) << i;
+  return mask;
+#endif
+}
+
+// \brief Writes four lanes of four streams interleaved as
+//    x0 y0 z0 w0 x1 y1 z1 w1 ... (16 floats)
+static inline void f4store_interleaved(
+  float* p, f4_t x, f4_t y, f4_t z, f4_t w
+) {
+#if defined(WASP_SIMD_WASM)
+  v128_t xy_lo = wasm_i32x4_shuffle(x, y, 0, 4, 1, 5);
+  v128_t zw_lo = wasm_i32x4_shuffle(z, w, 0, 4, 1, 5);
+  v128_t xy_hi = wasm_i32x4_shuffle(x, y, 2, 6, 3, 7);
+  v128_t zw_hi = wasm_i32x4_shuffle(z, w, 2, 6, 3, 7);
+  wasm_v128_store(p +  0, wasm_i32x4_shuffle(xy_lo, zw_lo, 0, 1, 4, 5));
+  wasm_v128_store(p +  4, wasm_i32x4_shuffle(xy_lo, zw_lo, 2, 3, 6, 7));
+  wasm_v128_store(p +  8, wasm_i32x4_shuffle(xy_hi, zw_hi, 0, 1, 4, 5));
+  wasm_v128_store(p + 12, wasm_i32x4_shuffle(xy_hi, zw_hi, 2, 3, 6, 7));
+#elif defined(WASP_SIMD_SSE)
+  _MM_TRANSPOSE4_PS(x, y, z, w);
+  _mm_storeu_ps(p +  0, x);
+  _mm_storeu_ps(p +  4, y);
+  _mm_storeu_ps(p +  8, z);
+  _mm_storeu_ps(p + 12, w);
+#elif defined(WASP_SIMD_NEON)
+  vst4q_f32(p, (float32x4x4_t){ .val = { x, y, z, w } });
+#else
+  for (int i = 0; i < 4; ++i) {
+    p[i * 4 + 0] = x.f[i];
+    p[i * 4 + 1] = y.f[i];
+    p[i * 4 + 2] = z.f[i];
+    p[i * 4 + 3] = w.f[i];
+  }
+#endif
+}
+
+#endif
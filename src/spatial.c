@@ -0,0 +1,620 @@
+/*******************************************************************************
+* MIT License
+*
+* Copyright (c) 2026 Curtis McCoy
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#define MCLIB_INTERNAL_IMPL
+#include "spatial.h"
+
+#define con_type index_t
+#define key_type slotkey_t
+#define con_prefix leaf
+#include "map.h"
+#undef con_prefix
+#undef key_type
+#undef con_type
+
+#include <stdlib.h>
+#include <math.h> // INFINITY
+
+#define SPATIAL_NULL            (-1)
+#define SPATIAL_MIN_CAPACITY    64
+#define SPATIAL_STACK_SIZE      256
+#define SPATIAL_MARGIN_SCALE    0.1f
+#define SPATIAL_MARGIN_MIN      0.1f
+
+////////////////////////////////////////////////////////////////////////////////
+// Internal types
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct spatial_node_t {
+  aabb_t    fat;      // padded item bounds for leaves, union of children else
+  aabb_t    tight;    // exact item bounds, leaves only
+  slotkey_t id;
+  index_t   parent;   // next free node while on the free list
+  index_t   child[2];
+  index_t   height;   // 0 for leaves, -1 for free nodes
+} spatial_node_t;
+
+typedef struct Spatial_Internal {
+  struct _opaque_Spatial_t pub;
+
+  spatial_node_t* nodes;
+  index_t         capacity;
+  index_t         count;      // high water mark of used nodes
+  index_t         root;
+  index_t         free_list;
+  HMap_leaf       leaves;     // slotkey -> leaf node index
+} Spatial_Internal;
+
+#define SPATIAL_INTERNAL                                      \
+  Spatial_Internal* sp = (Spatial_Internal*)(_spatial);       \
+  assert(sp)                                                  //
+
+////////////////////////////////////////////////////////////////////////////////
+// Box helpers
+////////////////////////////////////////////////////////////////////////////////
+
+static inline aabb_t _aabb_union(aabb_t a, aabb_t b) {
+  return (aabb_t) {
+    .min = v3f(
+      MIN(a.min.x, b.min.x), MIN(a.min.y, b.min.y), MIN(a.min.z, b.min.z)
+    ),
+    .max = v3f(
+      MAX(a.max.x, b.max.x), MAX(a.max.y, b.max.y), MAX(a.max.z, b.max.z)
+    ),
+  };
+}
+
+// Half the surface area, which is all the insertion cost heuristic needs
+static inline float _aabb_area(aabb_t a) {
+  vec3 d = v3sub(a.max, a.min);
+  return d.x * d.y + d.y * d.z + d.z * d.x;
+}
+
+static inline bool _aabb_contains(aabb_t outer, aabb_t inner) {
+  return outer.min.x <= inner.min.x && inner.max.x <= outer.max.x
+      && outer.min.y <= inner.min.y && inner.max.y <= outer.max.y
+      && outer.min.z <= inner.min.z && inner.max.z <= outer.max.z;
+}
+
+static inline bool _aabb_overlap(aabb_t a, aabb_t b) {
+  return a.min.x <= b.max.x && b.min.x <= a.max.x
+      && a.min.y <= b.max.y && b.min.y <= a.max.y
+      && a.min.z <= b.max.z && b.min.z <= a.max.z;
+}
+
+static inline bool _aabb_hits_sphere(aabb_t a, vec3 center, float radius) {
+  vec3 closest = v3f(
+    MAX(a.min.x, MIN(center.x, a.max.x)),
+    MAX(a.min.y, MIN(center.y, a.max.y)),
+    MAX(a.min.z, MIN(center.z, a.max.z))
+  );
+  vec3 d = v3sub(closest, center);
+  return v3dot(d, d) <= radius * radius;
+}
+
+// Tests the box corner furthest along each plane normal
+static inline bool _aabb_in_frustum(aabb_t a, const frustum_t* frustum) {
+  for (int i = 0; i < 6; ++i) {
+    const vec4* plane = &frustum->planes[i];
+    vec3 p = v3f(
+      plane->x >= 0 ? a.max.x : a.min.x,
+      plane->y >= 0 ? a.max.y : a.min.y,
+      plane->z >= 0 ? a.max.z : a.min.z
+    );
+    if (v3dot(plane->xyz, p) + plane->w < 0) return false;
+  }
+  return true;
+}
+
+// Slab test, returns the entry distance or INFINITY on a miss
+static inline float _aabb_ray(
+  aabb_t a, vec3 origin, vec3 inv_dir, float max_t
+) {
+  float t0 = 0, t1 = max_t;
+
+  for (int i = 0; i < 3; ++i) {
+    float enter = (a.min.f[i] - origin.f[i]) * inv_dir.f[i];
+    float leave = (a.max.f[i] - origin.f[i]) * inv_dir.f[i];
+    if (enter > leave) { float tmp = enter; enter = leave; leave = tmp; }
+    t0 = MAX(t0, enter);
+    t1 = MIN(t1, leave);
+    if (t0 > t1) return INFINITY;
+  }
+
+  return t0;
+}
+
+static inline aabb_t _aabb_fatten(aabb_t a) {
+  float m = SPATIAL_MARGIN_MIN;
+  vec3 margin = v3scale(v3sub(a.max, a.min), SPATIAL_MARGIN_SCALE);
+  margin = v3add(margin, v3f(m, m, m));
+  return (aabb_t) { v3sub(a.min, margin), v3add(a.max, margin) };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+aabb_t aabb_from_sphere(vec3 center, float radius) {
+  vec3 r = v3f(radius, radius, radius);
+  return (aabb_t) { v3sub(center, r), v3add(center, r) };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Node allocation
+////////////////////////////////////////////////////////////////////////////////
+
+static index_t _spatial_node_alloc(Spatial_Internal* sp) {
+  index_t index;
+
+  if (sp->free_list != SPATIAL_NULL) {
+    index = sp->free_list;
+    sp->free_list = sp->nodes[index].parent;
+  }
+  else {
+    if (sp->count == sp->capacity) {
+      index_t capacity = MAX(sp->capacity * 2, SPATIAL_MIN_CAPACITY);
+      spatial_node_t* nodes = realloc(sp->nodes, sizeof(*nodes) * capacity);
+      assert(nodes);
+      sp->nodes = nodes;
+      sp->capacity = capacity;
+    }
+    index = sp->count++;
+  }
+
+  sp->nodes[index] = (spatial_node_t) {
+    .id = SK_NULL,
+    .parent = SPATIAL_NULL,
+    .child = { SPATIAL_NULL, SPATIAL_NULL },
+    .height = 0,
+  };
+
+  return index;
+}
+
+static void _spatial_node_free(Spatial_Internal* sp, index_t index) {
+  sp->nodes[index].parent = sp->free_list;
+  sp->nodes[index].height = -1;
+  sp->free_list = index;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Tree balancing
+////////////////////////////////////////////////////////////////////////////////
+
+static void _spatial_replace_child(
+  Spatial_Internal* sp, index_t parent, index_t old_child, index_t new_child
+) {
+  if (parent == SPATIAL_NULL) {
+    sp->root = new_child;
+    return;
+  }
+
+  spatial_node_t* p = &sp->nodes[parent];
+  if (p->child[0] == old_child) p->child[0] = new_child;
+  else p->child[1] = new_child;
+}
+
+// Rotates the taller grandchild of node a up if its children are unbalanced,
+//    returning the index of the node that took its place.
+static index_t _spatial_balance(Spatial_Internal* sp, index_t ia) {
+  spatial_node_t* a = &sp->nodes[ia];
+  if (a->height < 2) return ia;
+
+  index_t ib = a->child[0];
+  index_t ic = a->child[1];
+  index_t balance = sp->nodes[ic].height - sp->nodes[ib].height;
+
+  if (balance >= -1 && balance <= 1) return ia;
+
+  // side s of a gets rotated up, side k stays under a
+  int s = balance > 1 ? 1 : 0;
+  int k = 1 - s;
+  index_t iup = a->child[s];
+  spatial_node_t* up = &sp->nodes[iup];
+  spatial_node_t* kept = &sp->nodes[a->child[k]];
+  index_t i0 = up->child[0];
+  index_t i1 = up->child[1];
+
+  up->child[0] = ia;
+  up->parent = a->parent;
+  a->parent = iup;
+  _spatial_replace_child(sp, up->parent, ia, iup);
+
+  // the taller grandchild stays with the raised node, the other moves to a
+  index_t itall = sp->nodes[i0].height > sp->nodes[i1].height ? i0 : i1;
+  index_t ishort = itall == i0 ? i1 : i0;
+  spatial_node_t* tall = &sp->nodes[itall];
+  spatial_node_t* shrt = &sp->nodes[ishort];
+
+  up->child[1] = itall;
+  a->child[s] = ishort;
+  shrt->parent = ia;
+
+  a->fat = _aabb_union(kept->fat, shrt->fat);
+  a->height = 1 + MAX(kept->height, shrt->height);
+  up->fat = _aabb_union(a->fat, tall->fat);
+  up->height = 1 + MAX(a->height, tall->height);
+
+  return iup;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Walks from a node up to the root, rebalancing and refitting bounds
+static void _spatial_refit(Spatial_Internal* sp, index_t index) {
+  while (index != SPATIAL_NULL) {
+    index = _spatial_balance(sp, index);
+
+    spatial_node_t* node = &sp->nodes[index];
+    spatial_node_t* c0 = &sp->nodes[node->child[0]];
+    spatial_node_t* c1 = &sp->nodes[node->child[1]];
+
+    node->height = 1 + MAX(c0->height, c1->height);
+    node->fat = _aabb_union(c0->fat, c1->fat);
+
+    index = node->parent;
+  }
+
+  sp->pub.height = sp->root == SPATIAL_NULL ? 0 : sp->nodes[sp->root].height;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Leaf insertion and removal
+////////////////////////////////////////////////////////////////////////////////
+
+// Descends towards the sibling that minimizes the total area added to the tree
+static void _spatial_insert_leaf(Spatial_Internal* sp, index_t leaf) {
+  if (sp->root == SPATIAL_NULL) {
+    sp->root = leaf;
+    sp->nodes[leaf].parent = SPATIAL_NULL;
+    sp->pub.height = 0;
+    return;
+  }
+
+  aabb_t box = sp->nodes[leaf].fat;
+  index_t index = sp->root;
+
+  while (sp->nodes[index].height > 0) {
+    spatial_node_t* node = &sp->nodes[index];
+    float area = _aabb_area(node->fat);
+    float combined = _aabb_area(_aabb_union(node->fat, box));
+
+    // cost of making a new parent for this node and the leaf
+    float cost = 2.f * combined;
+    // minimum cost of pushing the leaf further down
+    float inherited = 2.f * (combined - area);
+
+    float child_cost[2];
+    for (int i = 0; i < 2; ++i) {
+      spatial_node_t* child = &sp->nodes[node->child[i]];
+      float grown = _aabb_area(_aabb_union(child->fat, box));
+      if (child->height > 0) grown -= _aabb_area(child->fat);
+      child_cost[i] = grown + inherited;
+    }
+
+    if (cost < child_cost[0] && cost < child_cost[1]) break;
+
+    index = node->child[child_cost[0] < child_cost[1] ? 0 : 1];
+  }
+
+  index_t sibling = index;
+  index_t old_parent = sp->nodes[sibling].parent;
+  index_t new_parent = _spatial_node_alloc(sp); // may move the node array
+
+  spatial_node_t* parent = &sp->nodes[new_parent];
+  parent->parent = old_parent;
+  parent->fat = _aabb_union(box, sp->nodes[sibling].fat);
+  parent->height = sp->nodes[sibling].height + 1;
+  parent->child[0] = sibling;
+  parent->child[1] = leaf;
+
+  _spatial_replace_child(sp, old_parent, sibling, new_parent);
+  sp->nodes[sibling].parent = new_parent;
+  sp->nodes[leaf].parent = new_parent;
+
+  _spatial_refit(sp, new_parent);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void _spatial_remove_leaf(Spatial_Internal* sp, index_t leaf) {
+  if (leaf == sp->root) {
+    sp->root = SPATIAL_NULL;
+    sp->pub.height = 0;
+    return;
+  }
+
+  index_t parent = sp->nodes[leaf].parent;
+  index_t grandparent = sp->nodes[parent].parent;
+  spatial_node_t* p = &sp->nodes[parent];
+  index_t sibling = p->child[0] == leaf ? p->child[1] : p->child[0];
+
+  _spatial_replace_child(sp, grandparent, parent, sibling);
+  sp->nodes[sibling].parent = grandparent;
+  _spatial_node_free(sp, parent);
+
+  _spatial_refit(sp, grandparent);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Construction and cleanup
+////////////////////////////////////////////////////////////////////////////////
+
+Spatial spatial_new(void) {
+  Spatial_Internal* ret = malloc(sizeof(*ret));
+  assert(ret);
+
+  *ret = (Spatial_Internal) {
+    .pub = { .size = 0, .height = 0 },
+    .nodes = NULL,
+    .capacity = 0,
+    .count = 0,
+    .root = SPATIAL_NULL,
+    .free_list = SPATIAL_NULL,
+    .leaves = map_leaf_new(),
+  };
+
+  return (Spatial)ret;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void spatial_delete(Spatial* _spatial) {
+  if (!_spatial || !*_spatial) return;
+  Spatial_Internal* sp = (Spatial_Internal*)*_spatial;
+  map_leaf_delete(&sp->leaves);
+  free(sp->nodes);
+  free(sp);
+  *_spatial = NULL;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void spatial_clear(Spatial _spatial) {
+  SPATIAL_INTERNAL;
+  map_leaf_clear(sp->leaves);
+  sp->count = 0;
+  sp->root = SPATIAL_NULL;
+  sp->free_list = SPATIAL_NULL;
+  sp->pub.size = 0;
+  sp->pub.height = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Item management
+////////////////////////////////////////////////////////////////////////////////
+
+void spatial_update(Spatial _spatial, slotkey_t id, aabb_t bounds) {
+  SPATIAL_INTERNAL;
+  assert(id.hash);
+
+  index_t* existing = map_leaf_ref(sp->leaves, id);
+
+  if (existing) {
+    index_t leaf = *existing;
+    spatial_node_t* node = &sp->nodes[leaf];
+    node->tight = bounds;
+
+    // still inside its padded bounds, and those haven't become too loose
+    aabb_t fat = _aabb_fatten(bounds);
+    if (_aabb_contains(node->fat, bounds)
+    &&  _aabb_area(node->fat) <= 4.f * _aabb_area(fat)
+    ) {
+      return;
+    }
+
+    _spatial_remove_leaf(sp, leaf);
+    sp->nodes[leaf].fat = fat;
+    _spatial_insert_leaf(sp, leaf);
+    return;
+  }
+
+  index_t leaf = _spatial_node_alloc(sp);
+  spatial_node_t* node = &sp->nodes[leaf];
+  node->id = id;
+  node->tight = bounds;
+  node->fat = _aabb_fatten(bounds);
+
+  res_ensure_leaf_t slot = map_leaf_ensure(sp->leaves, id);
+  *slot.value = leaf;
+
+  _spatial_insert_leaf(sp, leaf);
+  ++sp->pub.size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void spatial_remove(Spatial _spatial, slotkey_t id) {
+  SPATIAL_INTERNAL;
+
+  index_t* existing = map_leaf_ref(sp->leaves, id);
+  if (!existing) return;
+
+  index_t leaf = *existing;
+  map_leaf_remove(sp->leaves, id);
+
+  _spatial_remove_leaf(sp, leaf);
+  _spatial_node_free(sp, leaf);
+  --sp->pub.size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool spatial_contains(Spatial _spatial, slotkey_t id) {
+  SPATIAL_INTERNAL;
+  return map_leaf_ref(sp->leaves, id) != NULL;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Overlap queries
+////////////////////////////////////////////////////////////////////////////////
+
+typedef enum spatial_shape_t {
+  SPATIAL_SHAPE_AABB,
+  SPATIAL_SHAPE_SPHERE,
+  SPATIAL_SHAPE_FRUSTUM,
+} spatial_shape_t;
+
+typedef struct spatial_volume_t {
+  spatial_shape_t   shape;
+  aabb_t            box;
+  vec3              center;
+  float             radius;
+  const frustum_t*  frustum;
+} spatial_volume_t;
+
+static inline bool _spatial_volume_test(const spatial_volume_t* v, aabb_t a) {
+  switch (v->shape) {
+    case SPATIAL_SHAPE_AABB:
+      return _aabb_overlap(v->box, a);
+    case SPATIAL_SHAPE_SPHERE:
+      return _aabb_hits_sphere(a, v->center, v->radius);
+    case SPATIAL_SHAPE_FRUSTUM:
+      return _aabb_in_frustum(a, v->frustum);
+  }
+  return false;
+}
+
+static index_t _spatial_query(
+  Spatial_Internal* sp, const spatial_volume_t* volume,
+  spatial_visit_fn_t fn, void* data
+) {
+  if (sp->root == SPATIAL_NULL) return 0;
+
+  index_t stack[SPATIAL_STACK_SIZE];
+  index_t top = 0;
+  index_t count = 0;
+  stack[top++] = sp->root;
+
+  while (top) {
+    const spatial_node_t* node = &sp->nodes[stack[--top]];
+    if (!_spatial_volume_test(volume, node->fat)) continue;
+
+    if (node->height == 0) {
+      if (!_spatial_volume_test(volume, node->tight)) continue;
+      ++count;
+      if (fn && !fn(node->id, data)) break;
+      continue;
+    }
+
+    assert(top + 2 <= SPATIAL_STACK_SIZE);
+    stack[top++] = node->child[0];
+    stack[top++] = node->child[1];
+  }
+
+  return count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+index_t spatial_query_aabb(
+  Spatial _spatial, aabb_t box, spatial_visit_fn_t fn, void* data
+) {
+  SPATIAL_INTERNAL;
+  spatial_volume_t volume = { .shape = SPATIAL_SHAPE_AABB, .box = box };
+  return _spatial_query(sp, &volume, fn, data);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+index_t spatial_query_sphere(
+  Spatial _spatial, vec3 center, float radius, spatial_visit_fn_t fn, void* data
+) {
+  SPATIAL_INTERNAL;
+  spatial_volume_t volume = {
+    .shape = SPATIAL_SHAPE_SPHERE, .center = center, .radius = radius,
+  };
+  return _spatial_query(sp, &volume, fn, data);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+index_t spatial_query_frustum(
+  Spatial _spatial, const frustum_t* frustum, spatial_visit_fn_t fn, void* data
+) {
+  SPATIAL_INTERNAL;
+  assert(frustum);
+  spatial_volume_t volume = {
+    .shape = SPATIAL_SHAPE_FRUSTUM, .frustum = frustum,
+  };
+  return _spatial_query(sp, &volume, fn, data);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Ray casting
+////////////////////////////////////////////////////////////////////////////////
+
+bool spatial_raycast(
+  Spatial _spatial, vec3 origin, vec3 dir, float max_t,
+  spatial_ray_fn_t fn, void* data, spatial_hit_t* hit
+) {
+  SPATIAL_INTERNAL;
+  if (sp->root == SPATIAL_NULL) return false;
+
+  vec3 inv_dir = v3f(1.f / dir.x, 1.f / dir.y, 1.f / dir.z);
+  float best = max_t;
+  slotkey_t best_id = SK_NULL;
+
+  index_t stack[SPATIAL_STACK_SIZE];
+  index_t top = 0;
+  stack[top++] = sp->root;
+
+  while (top) {
+    const spatial_node_t* node = &sp->nodes[stack[--top]];
+    if (_aabb_ray(node->fat, origin, inv_dir, best) > best) continue;
+
+    if (node->height == 0) {
+      float t = _aabb_ray(node->tight, origin, inv_dir, best);
+      if (t > best) continue;
+      if (fn && !fn(node->id, origin, dir, &t, data)) continue;
+      if (t > best) continue;
+      best = t;
+      best_id = node->id;
+      continue;
+    }
+
+    // visit the nearer child first so it can tighten the search distance
+    index_t c0 = node->child[0];
+    index_t c1 = node->child[1];
+    float t0 = _aabb_ray(sp->nodes[c0].fat, origin, inv_dir, best);
+    float t1 = _aabb_ray(sp->nodes[c1].fat, origin, inv_dir, best);
+
+    assert(top + 2 <= SPATIAL_STACK_SIZE);
+    if (t0 <= t1) {
+      if (t1 <= best) stack[top++] = c1;
+      if (t0 <= best) stack[top++] = c0;
+    }
+    else {
+      if (t0 <= best) stack[top++] = c0;
+      if (t1 <= best) stack[top++] = c1;
+    }
+  }
+
+  if (!best_id.hash) return false;
+
+  if (hit) {
+    *hit = (spatial_hit_t) { .id = best_id, .t = best };
+  }
+
+  return true;
+}
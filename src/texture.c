@@ -27,6 +27,7 @@
 
 #include "gl.h"
 #include "str.h"
+#include "loaders/ktx2.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -46,6 +47,16 @@ tex_params_t tex_params_default = {
   .layers = 1
 };
 
+// Extension formats that aren't part of core GL
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+# define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+# define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_RGBA_ASTC_4x4_KHR
+# define GL_COMPRESSED_RGBA_ASTC_4x4_KHR  0x93B0
+#endif
+
+// For compressed formats, size is the number of bytes in each 4x4 block
 typedef struct tex_format_desc_t {
   int     size;
   int     channels;
@@ -65,7 +76,17 @@ static const tex_format_desc_t _rt_format[TF_SUPPORTED_MAX] = {
   { 4,  1,  GL_RED,   GL_R32F,      GL_FLOAT },
   { 4,  4,  GL_RGBA,  GL_RGB10_A2,  GL_UNSIGNED_INT_2_10_10_10_REV },
   { 4,  1,  GL_DEPTH_COMPONENT, GL_DEPTH_COMPONENT32F,  GL_FLOAT },
-  { 2,  1,  GL_DEPTH_COMPONENT, GL_DEPTH_COMPONENT16,   GL_UNSIGNED_SHORT }
+  { 2,  1,  GL_DEPTH_COMPONENT, GL_DEPTH_COMPONENT16,   GL_UNSIGNED_SHORT },
+  { 4,  1,  GL_RED_INTEGER, GL_R32UI,   GL_UNSIGNED_INT },
+  { 8,  2,  GL_RG_INTEGER,  GL_RG32UI,  GL_UNSIGNED_INT },
+  { 8,  4,  0,  GL_COMPRESSED_RGBA_S3TC_DXT1_EXT,   0 },
+  { 16, 4,  0,  GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,   0 },
+  { 8,  1,  0,  GL_COMPRESSED_RED_RGTC1,            0 },
+  { 16, 2,  0,  GL_COMPRESSED_RG_RGTC2,             0 },
+  { 16, 4,  0,  GL_COMPRESSED_RGBA_BPTC_UNORM,      0 },
+  { 8,  3,  0,  GL_COMPRESSED_RGB8_ETC2,            0 },
+  { 16, 4,  0,  GL_COMPRESSED_RGBA8_ETC2_EAC,       0 },
+  { 16, 4,  0,  GL_COMPRESSED_RGBA_ASTC_4x4_KHR,    0 },
 };
 
 #ifdef _MSC_VER
@@ -137,6 +158,116 @@ tex_format_t img_format(Image image) {
   return TF_RGB_8;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Compressed format support
+////////////////////////////////////////////////////////////////////////////////
+
+tex_compression_t tex_format_compression(tex_format_t format) {
+  switch (format) {
+    case TF_BC1_RGBA:
+    case TF_BC3_RGBA:
+    case TF_BC4_R:
+    case TF_BC5_RG:
+    case TF_BC7_RGBA:       return TEX_COMPRESSION_BC;
+    case TF_ETC2_RGB:
+    case TF_ETC2_RGBA:      return TEX_COMPRESSION_ETC2;
+    case TF_ASTC_4X4_RGBA:  return TEX_COMPRESSION_ASTC;
+    default:                return TEX_COMPRESSION_NONE;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+index_t tex_format_data_size(tex_format_t format, vec2i size) {
+  assert(format >= 0 && format < TF_SUPPORTED_MAX);
+
+  if (tex_format_compression(format) == TEX_COMPRESSION_NONE) {
+    return (index_t)size.w * size.h * _rt_format[format].size;
+  }
+
+  index_t blocks_x = (size.w + 3) / 4;
+  index_t blocks_y = (size.h + 3) / 4;
+  return blocks_x * blocks_y * _rt_format[format].size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static bool _tex_has_extension(const char* name) {
+#ifdef __WASM__
+  // WebGL extensions also need to be enabled by requesting them
+  return glGetExtensionWEBGL(name);
+#else
+  GLint count = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+
+  for (GLint i = 0; i < count; ++i) {
+    const char* ext = (const char*)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+    if (ext && !strcmp(ext, name)) return true;
+  }
+
+  return false;
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool tex_format_supported(tex_format_t format) {
+  assert(format >= 0 && format < TF_SUPPORTED_MAX);
+  static bool queried = false;
+  static bool supported[TF_SUPPORTED_MAX];
+
+  if (!queried) {
+    queried = true;
+
+    for (int i = 0; i < TF_SUPPORTED_MAX; ++i) {
+      supported[i] = tex_format_compression(i) == TEX_COMPRESSION_NONE;
+    }
+
+#ifdef __WASM__
+    bool s3tc = _tex_has_extension("WEBGL_compressed_texture_s3tc");
+    bool rgtc = _tex_has_extension("EXT_texture_compression_rgtc");
+    bool bptc = _tex_has_extension("EXT_texture_compression_bptc");
+    bool etc2 = _tex_has_extension("WEBGL_compressed_texture_etc");
+    bool astc = _tex_has_extension("WEBGL_compressed_texture_astc");
+#else
+    // RGTC, BPTC and ETC2 are core in GL 4.3, though ETC2 is usually decoded
+    //    by the driver on desktop hardware, so it's ranked last
+    bool s3tc = _tex_has_extension("GL_EXT_texture_compression_s3tc");
+    bool rgtc = true, bptc = true, etc2 = true;
+    bool astc = _tex_has_extension("GL_KHR_texture_compression_astc_ldr");
+#endif
+
+    supported[TF_BC1_RGBA] = s3tc;
+    supported[TF_BC3_RGBA] = s3tc;
+    supported[TF_BC4_R] = rgtc;
+    supported[TF_BC5_RG] = rgtc;
+    supported[TF_BC7_RGBA] = bptc;
+    supported[TF_ETC2_RGB] = etc2;
+    supported[TF_ETC2_RGBA] = etc2;
+    supported[TF_ASTC_4X4_RGBA] = astc;
+  }
+
+  return supported[format];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+tex_compression_t tex_compression_preferred(void) {
+  if (tex_format_supported(TF_BC7_RGBA) && tex_format_supported(TF_BC5_RG)) {
+    return TEX_COMPRESSION_BC;
+  }
+
+  if (tex_format_supported(TF_ASTC_4X4_RGBA)) {
+    return TEX_COMPRESSION_ASTC;
+  }
+
+  if (tex_format_supported(TF_ETC2_RGBA)) {
+    return TEX_COMPRESSION_ETC2;
+  }
+
+  return TEX_COMPRESSION_NONE;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Initialize a texture from loaded image data
 ////////////////////////////////////////////////////////////////////////////////
@@ -163,7 +294,7 @@ Texture tex_from_image(Image image) {
   GLenum err = glGetError();
 
   glGenTextures(1, &ret->handle);
-  glBindTexture(GL_TEXTURE_2D, ret->handle);
+  gl_bind_texture(GL_TEXTURE_2D, ret->handle);
   glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
   glTexImage2D(GL_TEXTURE_2D
   , 0 // Mipmap level
@@ -197,7 +328,7 @@ Texture tex_from_image(Image image) {
   _tex_set_filtering(GL_TEXTURE_2D, ret->filtering, ret->has_mips);
   _tex_set_wrapping(GL_TEXTURE_2D, ret->wrapping);
 
-  glBindTexture(GL_TEXTURE_2D, 0);
+  gl_bind_texture(GL_TEXTURE_2D, 0);
 
   return (Texture)ret;
 }
@@ -213,6 +344,7 @@ extern void   js_buffer_delete(const void* data_id);
 
 Texture tex_from_data(tex_format_t format, vec2i size, const void* data) {
   assert(format >= 0 && format < TF_SUPPORTED_MAX);
+  assert(tex_format_compression(format) == TEX_COMPRESSION_NONE);
 
   Texture ret = malloc(sizeof(struct texture_t));
   assert(ret);
@@ -236,7 +368,7 @@ Texture tex_from_data(tex_format_t format, vec2i size, const void* data) {
   data = data_buffer;
 #endif
 
-  glBindTexture(GL_TEXTURE_2D, ret->handle);
+  gl_bind_texture(GL_TEXTURE_2D, ret->handle);
   glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
   glTexImage2D(GL_TEXTURE_2D
   , 0 // Mipmap level
@@ -258,17 +390,61 @@ Texture tex_from_data(tex_format_t format, vec2i size, const void* data) {
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 
-  glBindTexture(GL_TEXTURE_2D, 0);
+  gl_bind_texture(GL_TEXTURE_2D, 0);
 
   return (Texture)ret;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Overwrites a rectangle of an existing 2D texture with new data
+////////////////////////////////////////////////////////////////////////////////
+
+void tex_set_data_region(
+  Texture tex, vec2i offset, vec2i size, const void* data
+) {
+  assert(tex);
+  assert(tex->handle);
+  assert(tex->layers == 0);
+  assert(offset.x >= 0 && offset.y >= 0);
+  assert(offset.x + size.w <= tex->size.w);
+  assert(offset.y + size.h <= tex->size.h);
+
+  if (size.w <= 0 || size.h <= 0) return;
+
+#ifdef __WASM__
+  const void* data_buffer = js_buffer_create(
+    data, size.w * size.h * _rt_format[tex->format].size
+  );
+  data = data_buffer;
+#endif
+
+  gl_bind_texture(GL_TEXTURE_2D, tex->handle);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glTexSubImage2D(GL_TEXTURE_2D
+  , 0 // Mipmap level
+  , offset.x
+  , offset.y
+  , size.w
+  , size.h
+  , _rt_format[tex->format].format
+  , _rt_format[tex->format].type
+  , data
+  );
+
+#ifdef __WASM__
+  js_buffer_delete(data_buffer);
+#endif
+
+  gl_bind_texture(GL_TEXTURE_2D, 0);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Initialize a blank texture for manual writing or render targets
 ////////////////////////////////////////////////////////////////////////////////
 
 Texture tex_generate(tex_format_t format, vec2i size) {
   assert(format >= 0 && format < TF_SUPPORTED_MAX);
+  assert(tex_format_compression(format) == TEX_COMPRESSION_NONE);
   assert(size.x > 0 && size.y > 0);
 
   Texture ret = malloc(sizeof(*ret));
@@ -289,7 +465,7 @@ Texture tex_generate(tex_format_t format, vec2i size) {
   ret->format = format;
 
   glGenTextures(1, &ret->handle);
-  glBindTexture(GL_TEXTURE_2D, ret->handle);
+  gl_bind_texture(GL_TEXTURE_2D, ret->handle);
   glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
   glTexImage2D(GL_TEXTURE_2D
@@ -308,7 +484,7 @@ Texture tex_generate(tex_format_t format, vec2i size) {
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 
-  glBindTexture(GL_TEXTURE_2D, 0);
+  gl_bind_texture(GL_TEXTURE_2D, 0);
 
   return (Texture)ret;
 }
@@ -378,9 +554,9 @@ void tex_set_filtering(Texture tex, tex_filtering_t filtering) {
   assert(tex);
   assert(tex->handle);
   GLenum target = _tex_gl_target_type(tex);
-  glBindTexture(target, tex->handle);
+  gl_bind_texture(target, tex->handle);
   _tex_set_filtering(target, filtering, tex->has_mips);
-  glBindTexture(target, 0);
+  gl_bind_texture(target, 0);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -391,9 +567,9 @@ void tex_set_wrapping(Texture tex, tex_wrapping_t wrapping) {
   assert(tex);
   assert(tex->handle);
   GLenum target = _tex_gl_target_type(tex);
-  glBindTexture(target, tex->handle);
+  gl_bind_texture(target, tex->handle);
   _tex_set_wrapping(target, wrapping);
-  glBindTexture(target, 0);
+  gl_bind_texture(target, 0);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -404,11 +580,11 @@ void tex_apply(Texture tex, uint slot, int sampler) {
   assert(tex->handle);
   assert(tex->layers >= 0);
 
-  glActiveTexture(GL_TEXTURE0 + slot);
+  gl_active_texture(GL_TEXTURE0 + slot);
   glUniform1i(sampler, slot);
 
   GLenum target = _tex_gl_target_type(tex);
-  glBindTexture(target, tex->handle);
+  gl_bind_texture(target, tex->handle);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -419,7 +595,7 @@ void tex_delete(Texture* texture) {
   assert(texture && *texture);
   Texture tex = *texture;
   if (tex == &tex_default_white || tex == &tex_default_normal) return;
-  glDeleteTextures(1, &tex->handle);
+  gl_delete_textures(1, &tex->handle);
   str_delete(&tex->name);
   free(tex);
   *texture = NULL;
@@ -447,7 +623,7 @@ Texture tex_from_image_atlas(Image image, vec2i dim) {
   };
 
   glGenTextures(1, &ret->handle);
-  glBindTexture(GL_TEXTURE_2D_ARRAY, ret->handle);
+  gl_bind_texture(GL_TEXTURE_2D_ARRAY, ret->handle);
 
   // We want the image data to be in a vertical strip to load all at once
   img_repack_vertical(image, dim);
@@ -492,7 +668,7 @@ Texture tex_from_image_atlas(Image image, vec2i dim) {
 
   glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
 
-  glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+  gl_bind_texture(GL_TEXTURE_2D_ARRAY, 0);
 
   return (Texture)ret;
 }
@@ -515,7 +691,7 @@ Texture tex_generate_atlas(tex_format_t format, vec2i size, index_t layers) {
   };
 
   glGenTextures(1, &ret->handle);
-  glBindTexture(GL_TEXTURE_2D_ARRAY, ret->handle);
+  gl_bind_texture(GL_TEXTURE_2D_ARRAY, ret->handle);
 
   GLsizei mip_levels = 1;
 
@@ -546,7 +722,104 @@ Texture tex_generate_atlas(tex_format_t format, vec2i size, index_t layers) {
 
   glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
 
-  glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+  gl_bind_texture(GL_TEXTURE_2D_ARRAY, 0);
+
+  return ret;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Creates a texture array from KTX2 data, compressed or baked
+////////////////////////////////////////////////////////////////////////////////
+
+Texture tex_from_ktx2(slice_t name, slice_t data) {
+  ktx2_t ktx;
+  if (!ktx2_parse(data, &ktx)) {
+    str_log("[Texture.from_ktx2] Invalid KTX2 file: {}", name);
+    return NULL;
+  }
+
+  if (!tex_format_supported(ktx.format)) {
+    str_log("[Texture.from_ktx2] Format not supported by context: {}", name);
+    return NULL;
+  }
+
+  Texture ret = malloc(sizeof(*ret));
+  assert(ret);
+
+  *ret = (struct texture_t) {
+    .name = str_copy(name),
+    .size = ktx.size,
+    .format = ktx.format,
+    .filtering = TEX_FILTERING_LINEAR,
+    .wrapping = TEX_WRAPPING_CLAMP,
+    .layers = ktx.layers,
+    .has_mips = ktx.levels > 1,
+  };
+
+  GLenum err = glGetError();
+
+  glGenTextures(1, &ret->handle);
+  gl_bind_texture(GL_TEXTURE_2D_ARRAY, ret->handle);
+
+  glTexStorage3D(GL_TEXTURE_2D_ARRAY
+  , (GLsizei)ktx.levels
+  , _rt_format[ret->format].internal
+  , ret->size.w
+  , ret->size.h
+  , (GLsizei)ret->layers
+  );
+
+  bool compressed = tex_format_compression(ret->format) != TEX_COMPRESSION_NONE;
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+  // Only the levels in the file are used, mips aren't generated at runtime
+  for (index_t i = 0; i < ktx.levels; ++i) {
+    vec2i size = v2i(MAX(ret->size.w >> i, 1), MAX(ret->size.h >> i, 1));
+
+    if (compressed) {
+      glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY
+      , (GLint)i                                    // Mipmap level
+      , 0, 0, 0                                     // x, y, z offsets
+      , size.w, size.h, (GLsizei)ret->layers        // volume of change
+      , _rt_format[ret->format].internal
+      , (GLsizei)ktx.level[i].size
+      , ktx.level[i].data
+      );
+      continue;
+    }
+
+    const void* data = ktx.level[i].data;
+
+#ifdef __WASM__
+    const void* data_buffer = js_buffer_create(data, ktx.level[i].size);
+    data = data_buffer;
+#endif
+
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY
+    , (GLint)i                                      // Mipmap level
+    , 0, 0, 0                                       // x, y, z offsets
+    , size.w, size.h, (GLsizei)ret->layers          // volume of change
+    , _rt_format[ret->format].format
+    , _rt_format[ret->format].type
+    , data
+    );
+
+#ifdef __WASM__
+    js_buffer_delete(data_buffer);
+#endif
+  }
+
+  err = glGetError();
+  if (err) {
+    str_log("[Texture.from_ktx2] Error uploading {}: 0x{!x}", name, err);
+  }
+
+  _tex_set_filtering(GL_TEXTURE_2D_ARRAY, ret->filtering, ret->has_mips);
+  _tex_set_wrapping(GL_TEXTURE_2D_ARRAY, ret->wrapping);
+
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+
+  gl_bind_texture(GL_TEXTURE_2D_ARRAY, 0);
 
   return ret;
 }
@@ -570,7 +843,7 @@ void tex_set_atlas_layer(Texture tex, index_t layer, Image image) {
   Image img = image;
   img_set_channels(img, _rt_format[tex->format].channels);
 
-  glBindTexture(GL_TEXTURE_2D_ARRAY, tex->handle);
+  gl_bind_texture(GL_TEXTURE_2D_ARRAY, tex->handle);
 
   glTexSubImage3D(GL_TEXTURE_2D_ARRAY
   , 0                               // Mipmap level
@@ -581,7 +854,7 @@ void tex_set_atlas_layer(Texture tex, index_t layer, Image image) {
   , img->handle
   );
 
-  glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+  gl_bind_texture(GL_TEXTURE_2D_ARRAY, 0);
 
   // it's possible for a default image to get copied, if that happens, clean up
   //    the duplicated image here.
@@ -615,10 +888,14 @@ void tex_generate_mips(Texture tex) {
 
   GLenum target = _tex_gl_target_type(tex);
 
-  glBindTexture(target, tex->handle);
-  glGenerateMipmap(target);
+  gl_bind_texture(target, tex->handle);
+
+  // compressed textures can only use the mips they were loaded with
+  if (tex_format_compression(tex->format) == TEX_COMPRESSION_NONE) {
+    glGenerateMipmap(target);
+  }
 
   _tex_set_filtering(target, tex->filtering, tex->has_mips);
 
-  glBindTexture(target, 0);
+  gl_bind_texture(target, 0);
 }
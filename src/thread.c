@@ -24,18 +24,406 @@
 
 #include "thread.h"
 
+#include <stdlib.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// Runs each chunk of a parallel-for on the calling thread
+////////////////////////////////////////////////////////////////////////////////
+
+static void _jobs_run_inline(
+  index_t count, index_t chunk_size, job_range_fn_t fn, void* data
+) {
+  for (index_t begin = 0; begin < count; begin += chunk_size) {
+    fn(begin, MIN(begin + chunk_size, count), data);
+  }
+}
+
 #ifdef __WASM__
 
+////////////////////////////////////////////////////////////////////////////////
+// Single-threaded fallback, everything runs on the calling thread
+////////////////////////////////////////////////////////////////////////////////
+
 bool thread_is_main(void) {
   return true;
 }
 
+void jobs_init(index_t worker_count) {
+  UNUSED(worker_count);
+}
+
+void jobs_shutdown(void) { }
+
+index_t jobs_thread_count(void) {
+  return 1;
+}
+
+index_t jobs_thread_index(void) {
+  return 0;
+}
+
+void jobs_submit(job_fn_t fn, void* data, job_counter_t* counter) {
+  UNUSED(counter);
+  fn(data);
+}
+
+void jobs_submit_background(job_fn_t fn, void* data, job_counter_t* counter) {
+  UNUSED(counter);
+  fn(data);
+}
+
+void jobs_wait(job_counter_t* counter) {
+  UNUSED(counter);
+}
+
+bool jobs_done(job_counter_t* counter) {
+  UNUSED(counter);
+  return true;
+}
+
+void jobs_parallel_for(
+  index_t count, index_t chunk_size, job_range_fn_t fn, void* data
+) {
+  _jobs_run_inline(count, MAX(chunk_size, 1), fn, data);
+}
+
 #else
 
 #include "SDL3/SDL.h"
+#include "str.h"
+
+#include <stdint.h> // intptr_t
 
 bool thread_is_main(void) {
   return SDL_IsMainThread();
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Work-stealing job queues
+////////////////////////////////////////////////////////////////////////////////
+
+#define JOBS_MAX_THREADS  32
+#define JOBS_QUEUE_SIZE   256 // power of 2
+#define JOBS_WAIT_SPINS   64  // idle polls in jobs_wait before sleeping
+#define JOBS_WAIT_MS      1   // so a sleeping waiter still helps with new jobs
+
+typedef struct job_t {
+  job_fn_t        fn;
+  void*           data;
+  job_counter_t*  counter;
+} job_t;
+
+// The owning thread pushes and pops at the tail, thieves take from the head
+typedef struct job_queue_t {
+  SDL_SpinLock    lock;
+  index_t         head;
+  index_t         tail;
+  job_t           jobs[JOBS_QUEUE_SIZE];
+} job_queue_t;
+
+static struct {
+  SDL_Thread*     threads[JOBS_MAX_THREADS];
+  job_queue_t     queues[JOBS_MAX_THREADS]; // queue 0 belongs to main
+  job_queue_t     background;               // only workers take from this
+  index_t         thread_count;
+  SDL_Semaphore*  wake;
+  SDL_Mutex*      done_lock;
+  SDL_Condition*  done;       // broadcast whenever a counter hits zero
+  SDL_AtomicInt   running;
+} _jobs = {
+  .thread_count = 1,
+};
+
+static thread_local index_t _job_thread_index = 0;
+
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct job_range_t {
+  job_range_fn_t  fn;
+  void*           data;
+  index_t         begin;
+  index_t         end;
+} job_range_t;
+
+static void _job_range_run(void* data) {
+  job_range_t* range = data;
+  range->fn(range->begin, range->end, range->data);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static bool _job_queue_push(job_queue_t* queue, job_t job) {
+  bool pushed = false;
+  SDL_LockSpinlock(&queue->lock);
+  if (queue->tail - queue->head < JOBS_QUEUE_SIZE) {
+    queue->jobs[queue->tail & (JOBS_QUEUE_SIZE - 1)] = job;
+    ++queue->tail;
+    pushed = true;
+  }
+  SDL_UnlockSpinlock(&queue->lock);
+  return pushed;
+}
+
+static bool _job_queue_pop(job_queue_t* queue, job_t* out) {
+  bool popped = false;
+  SDL_LockSpinlock(&queue->lock);
+  if (queue->tail > queue->head) {
+    --queue->tail;
+    *out = queue->jobs[queue->tail & (JOBS_QUEUE_SIZE - 1)];
+    popped = true;
+  }
+  SDL_UnlockSpinlock(&queue->lock);
+  return popped;
+}
+
+static bool _job_queue_steal(job_queue_t* queue, job_t* out) {
+  bool stolen = false;
+  SDL_LockSpinlock(&queue->lock);
+  if (queue->tail > queue->head) {
+    *out = queue->jobs[queue->head & (JOBS_QUEUE_SIZE - 1)];
+    ++queue->head;
+    stolen = true;
+  }
+  SDL_UnlockSpinlock(&queue->lock);
+  return stolen;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void _job_execute(job_t job) {
+  job.fn(job.data);
+  if (!job.counter) return;
+
+  // SDL_AddAtomicInt returns the old value, so this was the counter's last job
+  if (SDL_AddAtomicInt((SDL_AtomicInt*)job.counter, -1) == 1 && _jobs.done) {
+    SDL_LockMutex(_jobs.done_lock);
+    SDL_BroadcastCondition(_jobs.done);
+    SDL_UnlockMutex(_jobs.done_lock);
+  }
+}
+
+// Runs one job from this thread's queue, or steals one from another thread
+static bool _jobs_run_one(index_t self) {
+  job_t job;
+
+  if (_job_queue_pop(&_jobs.queues[self], &job)) {
+    _job_execute(job);
+    return true;
+  }
+
+  for (index_t i = 1; i < _jobs.thread_count; ++i) {
+    index_t victim = (self + i) % _jobs.thread_count;
+    if (_job_queue_steal(&_jobs.queues[victim], &job)) {
+      _job_execute(job);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// Workers fall back to long-running background jobs once the frame work is done
+static bool _jobs_run_background(void) {
+  job_t job;
+
+  if (_job_queue_steal(&_jobs.background, &job)) {
+    _job_execute(job);
+    return true;
+  }
+
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static int _job_worker(void* data) {
+  _job_thread_index = (index_t)(intptr_t)data;
+
+  while (SDL_GetAtomicInt(&_jobs.running)) {
+    if (!_jobs_run_one(_job_thread_index) && !_jobs_run_background()) {
+      SDL_WaitSemaphore(_jobs.wake);
+    }
+  }
+
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Starting and stopping the workers
+////////////////////////////////////////////////////////////////////////////////
+
+void jobs_init(index_t worker_count) {
+  if (_jobs.thread_count > 1) return;
+
+  if (worker_count <= 0) {
+    worker_count = SDL_GetNumLogicalCPUCores() - 1;
+  }
+  worker_count = MIN(worker_count, JOBS_MAX_THREADS - 1);
+  if (worker_count <= 0) return;
+
+  _jobs.wake = SDL_CreateSemaphore(0);
+  _jobs.done_lock = SDL_CreateMutex();
+  _jobs.done = SDL_CreateCondition();
+  SDL_SetAtomicInt(&_jobs.running, 1);
+
+  index_t started = 1;
+  for (index_t i = 1; i <= worker_count; ++i) {
+    SDL_Thread* thread =
+      SDL_CreateThread(_job_worker, "wasp_job", (void*)(intptr_t)i);
+    if (!thread) {
+      str_log("[Jobs.init] Failed to start worker: {}", SDL_GetError());
+      break;
+    }
+    _jobs.threads[i] = thread;
+    started = i + 1;
+  }
+
+  _jobs.thread_count = started;
+  str_log("[Jobs.init] Started {} job workers", started - 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void jobs_shutdown(void) {
+  if (_jobs.thread_count <= 1) return;
+
+  SDL_SetAtomicInt(&_jobs.running, 0);
+
+  for (index_t i = 1; i < _jobs.thread_count; ++i) {
+    SDL_SignalSemaphore(_jobs.wake);
+  }
+
+  for (index_t i = 1; i < _jobs.thread_count; ++i) {
+    SDL_WaitThread(_jobs.threads[i], NULL);
+    _jobs.threads[i] = NULL;
+  }
+
+  SDL_DestroySemaphore(_jobs.wake);
+  SDL_DestroyCondition(_jobs.done);
+  SDL_DestroyMutex(_jobs.done_lock);
+  _jobs.wake = NULL;
+  _jobs.done = NULL;
+  _jobs.done_lock = NULL;
+  _jobs.thread_count = 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+index_t jobs_thread_count(void) {
+  return _jobs.thread_count;
+}
+
+index_t jobs_thread_index(void) {
+  return _job_thread_index;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Submitting and waiting on jobs
+////////////////////////////////////////////////////////////////////////////////
+
+void jobs_submit(job_fn_t fn, void* data, job_counter_t* counter) {
+  assert(fn);
+  job_t job = { .fn = fn, .data = data, .counter = counter };
+
+  if (counter) {
+    SDL_AddAtomicInt((SDL_AtomicInt*)counter, 1);
+  }
+
+  // with no workers or a full queue, just do the work now
+  index_t self = _job_thread_index;
+  if (_jobs.thread_count <= 1 || !_job_queue_push(&_jobs.queues[self], job)) {
+    _job_execute(job);
+    return;
+  }
+
+  SDL_SignalSemaphore(_jobs.wake);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void jobs_submit_background(job_fn_t fn, void* data, job_counter_t* counter) {
+  assert(fn);
+  job_t job = { .fn = fn, .data = data, .counter = counter };
+
+  if (counter) {
+    SDL_AddAtomicInt((SDL_AtomicInt*)counter, 1);
+  }
+
+  if (_jobs.thread_count <= 1 || !_job_queue_push(&_jobs.background, job)) {
+    _job_execute(job);
+    return;
+  }
+
+  SDL_SignalSemaphore(_jobs.wake);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void jobs_wait(job_counter_t* counter) {
+  assert(counter);
+  SDL_AtomicInt* remaining = (SDL_AtomicInt*)counter;
+  index_t self = _job_thread_index;
+  index_t spins = 0;
+
+  while (SDL_GetAtomicInt(remaining) > 0) {
+    if (_jobs_run_one(self)) {
+      spins = 0;
+      continue;
+    }
+
+    if (++spins < JOBS_WAIT_SPINS || !_jobs.done) {
+      SDL_CPUPauseInstruction();
+      continue;
+    }
+
+    // Nothing left to help with, so sleep until some counter finishes
+    SDL_LockMutex(_jobs.done_lock);
+    if (SDL_GetAtomicInt(remaining) > 0) {
+      SDL_WaitConditionTimeout(_jobs.done, _jobs.done_lock, JOBS_WAIT_MS);
+    }
+    SDL_UnlockMutex(_jobs.done_lock);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool jobs_done(job_counter_t* counter) {
+  assert(counter);
+  return SDL_GetAtomicInt((SDL_AtomicInt*)counter) <= 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void jobs_parallel_for(
+  index_t count, index_t chunk_size, job_range_fn_t fn, void* data
+) {
+  assert(fn);
+  if (count <= 0) return;
+  chunk_size = MAX(chunk_size, 1);
+
+  index_t chunks = (count + chunk_size - 1) / chunk_size;
+  if (_jobs.thread_count <= 1 || chunks == 1) {
+    _jobs_run_inline(count, chunk_size, fn, data);
+    return;
+  }
+
+  job_range_t* ranges = malloc(sizeof(job_range_t) * chunks);
+  assert(ranges);
+  job_counter_t counter = { 0 };
+
+  for (index_t i = 0; i < chunks; ++i) {
+    index_t begin = i * chunk_size;
+    ranges[i] = (job_range_t) {
+      .fn = fn,
+      .data = data,
+      .begin = begin,
+      .end = MIN(begin + chunk_size, count),
+    };
+    jobs_submit(_job_range_run, &ranges[i], &counter);
+  }
+
+  jobs_wait(&counter);
+  free(ranges);
+}
+
 #endif
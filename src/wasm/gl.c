@@ -24,9 +24,128 @@
 
 #include "gl.h"
 #include "types.h"
+#include "wasp.h"
 
+#include <stdint.h>
 #include <string.h>
 
+////////////////////////////////////////////////////////////////////////////////
+// Command batching
+////////////////////////////////////////////////////////////////////////////////
+
+// Every call into JS is a boundary crossing plus a handle lookup on the other
+//    side. While batching, state changes and draws are written to a buffer in
+//    wasm memory instead, and JS replays the whole thing in one call (see
+//    js_gl_flush in wasm_gl.js). Any other GL import flushes the batch on the
+//    JS side before it runs, so calls still happen in order.
+
+// Opcodes index the replay table in wasm_gl.js, keep the two in the same order
+typedef enum gl_op_t {
+  GL_OP_VIEWPORT,
+  GL_OP_ENABLE,
+  GL_OP_DISABLE,
+  GL_OP_BLEND_FUNC,
+  GL_OP_CLEAR,
+  GL_OP_CLEAR_COLOR,
+  GL_OP_USE_PROGRAM,
+  GL_OP_UNIFORM_1I,
+  GL_OP_UNIFORM_2FV,
+  GL_OP_UNIFORM_3FV,
+  GL_OP_UNIFORM_4FV,
+  GL_OP_UNIFORM_MATRIX_4FV,
+  GL_OP_BIND_BUFFER,
+  GL_OP_BIND_VERTEX_ARRAY,
+  GL_OP_VERTEX_ATTRIB_POINTER,
+  GL_OP_VERTEX_ATTRIB_I_POINTER,
+  GL_OP_ENABLE_VERTEX_ATTRIB_ARRAY,
+  GL_OP_DISABLE_VERTEX_ATTRIB_ARRAY,
+  GL_OP_VERTEX_ATTRIB_DIVISOR,
+  GL_OP_DRAW_ARRAYS,
+  GL_OP_DRAW_ELEMENTS,
+  GL_OP_DRAW_ARRAYS_INSTANCED,
+  GL_OP_DRAW_ELEMENTS_INSTANCED,
+  GL_OP_ACTIVE_TEXTURE,
+  GL_OP_BIND_TEXTURE,
+  GL_OP_GENERATE_MIPMAP,
+  GL_OP_TEX_PARAMETERI,
+  GL_OP_PIXEL_STOREI,
+  GL_OP_BIND_FRAMEBUFFER,
+  GL_OP_BIND_RENDERBUFFER,
+  GL_OP_COUNT
+} gl_op_t;
+
+// Each command is a header word (opcode, and total length in words in the
+//    high half) followed by its arguments and any copied data
+#define GL_BATCH_WORDS (64 << 10)
+
+static uint32_t _gl_batch[GL_BATCH_WORDS];
+static index_t  _gl_batch_size = 0;
+static bool     _gl_batching = false;
+static index_t  _gl_crossings = 0;
+
+extern void     js_gl_flush(const uint32_t* commands, index_t words);
+extern void     js_gl_batch_enable(bool enable);
+extern index_t  js_gl_crossings_take(void);
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Also called from JS ahead of any binding that isn't recorded
+void export(gl_batch_flush)(void) {
+  if (!_gl_batch_size) return;
+  index_t words = _gl_batch_size;
+  _gl_batch_size = 0;
+  js_gl_flush(_gl_batch, words);
+}
+
+void export(gl_batch_enable)(bool enable) {
+  if (!enable) gl_batch_flush();
+  _gl_batching = enable;
+  js_gl_batch_enable(enable);
+}
+
+index_t gl_batch_crossings(void) {
+  return _gl_crossings;
+}
+
+// Called by the page after each frame is rendered
+void export(wasm_gl_frame_end)(void) {
+  gl_batch_flush();
+  _gl_crossings = js_gl_crossings_take();
+  gl_state_frame_end();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static uint32_t* _gl_cmd(gl_op_t op, index_t args) {
+  index_t words = 1 + args;
+  assert(words < GL_BATCH_WORDS && words <= UINT16_MAX);
+
+  if (_gl_batch_size + words > GL_BATCH_WORDS) gl_batch_flush();
+
+  uint32_t* cmd = _gl_batch + _gl_batch_size;
+  cmd[0] = (uint32_t)op | (uint32_t)words << 16;
+  _gl_batch_size += words;
+
+  return cmd + 1;
+}
+
+static inline uint32_t _gl_f(GLfloat f) {
+  uint32_t ret;
+  memcpy(&ret, &f, sizeof(ret));
+  return ret;
+}
+
+// Calls the JS binding directly when not batching, otherwise records the call
+#define GL_BATCHED(op, direct, ...)                                           \
+  if (!_gl_batching) { direct; return; }                                      \
+  uint32_t _args[] = { __VA_ARGS__ };                                         \
+  index_t _count = sizeof(_args) / sizeof(*_args);                            \
+  memcpy(_gl_cmd(op, _count), _args, sizeof(_args))                           //
+
+////////////////////////////////////////////////////////////////////////////////
+// State and errors
+////////////////////////////////////////////////////////////////////////////////
+
 extern GLenum glGetError();
 
 extern int js_glGetParameter(GLenum);
@@ -34,17 +153,58 @@ void glGetIntegerv(GLenum pname, GLint* data) {
   *data = js_glGetParameter(pname);
 }
 
-extern void glViewport(GLint x, GLint y, GLsizei width, GLsizei height);
+extern GLboolean js_glGetExtension(const char* name, int len);
+GLboolean glGetExtensionWEBGL(const GLchar* name) {
+  return js_glGetExtension(name, strlen(name));
+}
 
-extern void glEnable(GLenum cap);
+extern void js_glViewport(GLint x, GLint y, GLsizei width, GLsizei height);
+void glViewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+  GL_BATCHED(GL_OP_VIEWPORT
+  , js_glViewport(x, y, width, height)
+  , x, y, width, height
+  );
+}
 
-extern void glDisable(GLenum cap);
+extern void js_glEnable(GLenum cap);
+void glEnable(GLenum cap) {
+  GL_BATCHED(GL_OP_ENABLE
+  , js_glEnable(cap)
+  , cap
+  );
+}
 
-extern void glBlendFunc(GLenum sfactor, GLenum dfactor);
+extern void js_glDisable(GLenum cap);
+void glDisable(GLenum cap) {
+  GL_BATCHED(GL_OP_DISABLE
+  , js_glDisable(cap)
+  , cap
+  );
+}
 
-extern void glClear(GLbitfield mask);
+extern void js_glBlendFunc(GLenum sfactor, GLenum dfactor);
+void glBlendFunc(GLenum sfactor, GLenum dfactor) {
+  GL_BATCHED(GL_OP_BLEND_FUNC
+  , js_glBlendFunc(sfactor, dfactor)
+  , sfactor, dfactor
+  );
+}
+
+extern void js_glClear(GLbitfield mask);
+void glClear(GLbitfield mask) {
+  GL_BATCHED(GL_OP_CLEAR
+  , js_glClear(mask)
+  , mask
+  );
+}
 
-extern void glClearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a);
+extern void js_glClearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a);
+void glClearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a) {
+  GL_BATCHED(GL_OP_CLEAR_COLOR
+  , js_glClearColor(r, g, b, a)
+  , _gl_f(r), _gl_f(g), _gl_f(b), _gl_f(a)
+  );
+}
 
 ////////////////////////////////////////////////////////////////////////////////
 // Shaders
@@ -93,7 +253,13 @@ void glGetProgramInfoLog(
   *length = js_glGetProgramInfoLog(program, maxlength, infoLog);
 }
 
-extern void glUseProgram(GLuint program);
+extern void js_glUseProgram(GLuint program);
+void glUseProgram(GLuint program) {
+  GL_BATCHED(GL_OP_USE_PROGRAM
+  , js_glUseProgram(program)
+  , program
+  );
+}
 
 extern void glDeleteProgram(GLuint program);
 
@@ -107,21 +273,82 @@ GLint glGetUniformLocation(GLuint program, const GLchar* name) {
   return js_glGetUniformLocation(program, name, strlen(name));
 }
 
+extern void glGetActiveUniform(
+  GLuint program, GLuint index, GLsizei max, GLsizei* out_length,
+  GLint* size, GLenum* type, GLchar* name
+);
+
+extern void glGetActiveAttrib(
+  GLuint program, GLuint index, GLsizei max, GLsizei* out_length,
+  GLint* size, GLenum* type, GLchar* name
+);
+
+extern GLuint js_glGetUniformBlockIndex(GLuint data_id, const char* n, int len);
+GLuint glGetUniformBlockIndex(GLuint program, const GLchar* name) {
+  return js_glGetUniformBlockIndex(program, name, strlen(name));
+}
+
+extern void glUniformBlockBinding(GLuint program, GLuint index, GLuint binding);
+
 ////////////////////////////////////////////////////////////////////////////////
 // Shader uniforms
 ////////////////////////////////////////////////////////////////////////////////
 
-extern void glUniform1i(GLint loc, GLint v0);
+extern void js_glUniform1i(GLint loc, GLint v0);
+void glUniform1i(GLint loc, GLint v0) {
+  GL_BATCHED(GL_OP_UNIFORM_1I
+  , js_glUniform1i(loc, v0)
+  , loc, v0
+  );
+}
+
+// The values are copied into the batch, since the caller's copy may be gone
+//    or changed by the time it's replayed
+static void _gl_uniform_fv(
+  gl_op_t op, GLint loc, GLsizei count, const GLfloat* value, index_t size
+) {
+  index_t words = count * size;
+  uint32_t* args = _gl_cmd(op, 3 + words);
+  args[0] = loc;
+  args[1] = count;
+  args[2] = (uint32_t)(uintptr_t)(args + 3);
+  memcpy(args + 3, value, words * sizeof(GLfloat));
+}
 
-extern void glUniform2fv(GLint loc, GLsizei count, const GLfloat* value);
+extern void js_glUniform2fv(GLint loc, GLsizei count, const GLfloat* value);
+void glUniform2fv(GLint loc, GLsizei count, const GLfloat* value) {
+  if (!_gl_batching) { js_glUniform2fv(loc, count, value); return; }
+  _gl_uniform_fv(GL_OP_UNIFORM_2FV, loc, count, value, 2);
+}
 
-extern void glUniform3fv(GLint loc, GLsizei count, const GLfloat* value);
+extern void js_glUniform3fv(GLint loc, GLsizei count, const GLfloat* value);
+void glUniform3fv(GLint loc, GLsizei count, const GLfloat* value) {
+  if (!_gl_batching) { js_glUniform3fv(loc, count, value); return; }
+  _gl_uniform_fv(GL_OP_UNIFORM_3FV, loc, count, value, 3);
+}
 
-extern void glUniform4fv(GLint loc, GLsizei count, const GLfloat* value);
+extern void js_glUniform4fv(GLint loc, GLsizei count, const GLfloat* value);
+void glUniform4fv(GLint loc, GLsizei count, const GLfloat* value) {
+  if (!_gl_batching) { js_glUniform4fv(loc, count, value); return; }
+  _gl_uniform_fv(GL_OP_UNIFORM_4FV, loc, count, value, 4);
+}
 
-extern void glUniformMatrix4fv(
+extern void js_glUniformMatrix4fv(
   GLint loc, GLsizei count, GLboolean tpose, const GLfloat* mat
 );
+void glUniformMatrix4fv(
+  GLint loc, GLsizei count, GLboolean tpose, const GLfloat* mat
+) {
+  if (!_gl_batching) { js_glUniformMatrix4fv(loc, count, tpose, mat); return; }
+
+  index_t words = count * 16;
+  uint32_t* args = _gl_cmd(GL_OP_UNIFORM_MATRIX_4FV, 4 + words);
+  args[0] = loc;
+  args[1] = count;
+  args[2] = tpose;
+  args[3] = (uint32_t)(uintptr_t)(args + 4);
+  memcpy(args + 4, mat, words * sizeof(GLfloat));
+}
 
 ////////////////////////////////////////////////////////////////////////////////
 // Buffers and VAO
@@ -132,7 +359,15 @@ void glGenBuffers(GLsizei n, GLuint* buffers) {
   for (GLsizei i = 0; i < n; ++i) buffers[i] = js_glCreateBuffer();
 }
 
-extern void glBindBuffer(GLenum target, GLuint buffer);
+extern void glBindBufferBase(GLenum target, GLuint index, GLuint buffer);
+
+extern void js_glBindBuffer(GLenum target, GLuint buffer);
+void glBindBuffer(GLenum target, GLuint buffer) {
+  GL_BATCHED(GL_OP_BIND_BUFFER
+  , js_glBindBuffer(target, buffer)
+  , target, buffer
+  );
+}
 
 extern void glBufferData(
   GLenum target, GLsizeiptr size, const void* src, GLenum usage
@@ -151,43 +386,112 @@ extern GLuint js_glCreateVertexArray();
 void glGenVertexArrays(GLsizei n, GLuint* arrays) {
   for (GLsizei i = 0; i < n; ++i) arrays[i] = js_glCreateVertexArray();
 }
-extern void glBindVertexArray(GLuint array);
+extern void js_glBindVertexArray(GLuint array);
+void glBindVertexArray(GLuint array) {
+  GL_BATCHED(GL_OP_BIND_VERTEX_ARRAY
+  , js_glBindVertexArray(array)
+  , array
+  );
+}
 
 extern void js_glDeleteVertexArray(int data_id);
 void glDeleteVertexArrays(GLsizei n, const GLuint* arrays) {
   for (GLsizei i = 0; i < n; ++i) js_glDeleteVertexArray(arrays[i]);
 }
 
-extern void glVertexAttribPointer(
+extern void js_glVertexAttribPointer(
   GLuint index, GLint size, GLenum type, GLboolean normalized,
   GLsizei stride, const void* pointer
 );
+void glVertexAttribPointer(
+  GLuint index, GLint size, GLenum type, GLboolean normalized,
+  GLsizei stride, const void* pointer
+) {
+  GL_BATCHED(GL_OP_VERTEX_ATTRIB_POINTER
+  , js_glVertexAttribPointer(index, size, type, normalized, stride, pointer)
+  , index, size, type, normalized, stride, (uint32_t)(uintptr_t)pointer
+  );
+}
 
-extern void glVertexAttribIPointer(
+extern void js_glVertexAttribIPointer(
   GLuint index, GLint size, GLenum type, GLsizei stride, const void* pointer
 );
+void glVertexAttribIPointer(
+  GLuint index, GLint size, GLenum type, GLsizei stride, const void* pointer
+) {
+  GL_BATCHED(GL_OP_VERTEX_ATTRIB_I_POINTER
+  , js_glVertexAttribIPointer(index, size, type, stride, pointer)
+  , index, size, type, stride, (uint32_t)(uintptr_t)pointer
+  );
+}
 
-extern void glEnableVertexAttribArray(GLuint index);
+extern void js_glEnableVertexAttribArray(GLuint index);
+void glEnableVertexAttribArray(GLuint index) {
+  GL_BATCHED(GL_OP_ENABLE_VERTEX_ATTRIB_ARRAY
+  , js_glEnableVertexAttribArray(index)
+  , index
+  );
+}
 
-extern void glDisableVertexAttribArray(GLuint index);
+extern void js_glDisableVertexAttribArray(GLuint index);
+void glDisableVertexAttribArray(GLuint index) {
+  GL_BATCHED(GL_OP_DISABLE_VERTEX_ATTRIB_ARRAY
+  , js_glDisableVertexAttribArray(index)
+  , index
+  );
+}
 
-extern void glVertexAttribDivisor(GLuint index, GLuint divisor);
+extern void js_glVertexAttribDivisor(GLuint index, GLuint divisor);
+void glVertexAttribDivisor(GLuint index, GLuint divisor) {
+  GL_BATCHED(GL_OP_VERTEX_ATTRIB_DIVISOR
+  , js_glVertexAttribDivisor(index, divisor)
+  , index, divisor
+  );
+}
 
-extern void glDrawArrays(
-  GLenum mode, GLint first, GLsizei count
-);
+extern void js_glDrawArrays(GLenum mode, GLint first, GLsizei count);
+void glDrawArrays(GLenum mode, GLint first, GLsizei count) {
+  GL_BATCHED(GL_OP_DRAW_ARRAYS
+  , js_glDrawArrays(mode, first, count)
+  , mode, first, count
+  );
+}
 
-extern void glDrawElements(
+extern void js_glDrawElements(
   GLenum mode, GLsizei count, GLenum type, const void* offset
 );
+void glDrawElements(
+  GLenum mode, GLsizei count, GLenum type, const void* offset
+) {
+  GL_BATCHED(GL_OP_DRAW_ELEMENTS
+  , js_glDrawElements(mode, count, type, offset)
+  , mode, count, type, (uint32_t)(uintptr_t)offset
+  );
+}
 
-extern void glDrawArraysInstanced(
+extern void js_glDrawArraysInstanced(
   GLenum mode, GLint first, GLsizei count, GLsizei primcount
 );
+void glDrawArraysInstanced(
+  GLenum mode, GLint first, GLsizei count, GLsizei primcount
+) {
+  GL_BATCHED(GL_OP_DRAW_ARRAYS_INSTANCED
+  , js_glDrawArraysInstanced(mode, first, count, primcount)
+  , mode, first, count, primcount
+  );
+}
 
-extern void glDrawElementsInstanced(
-  GLenum mode, GLsizei, GLenum type, const void* offset, GLsizei primcount
+extern void js_glDrawElementsInstanced(
+  GLenum mode, GLsizei count, GLenum type, const void* offset, GLsizei prims
 );
+void glDrawElementsInstanced(
+  GLenum mode, GLsizei count, GLenum type, const void* offset, GLsizei prims
+) {
+  GL_BATCHED(GL_OP_DRAW_ELEMENTS_INSTANCED
+  , js_glDrawElementsInstanced(mode, count, type, offset, prims)
+  , mode, count, type, (uint32_t)(uintptr_t)offset, prims
+  );
+}
 
 ////////////////////////////////////////////////////////////////////////////////
 // Textures
@@ -198,9 +502,21 @@ void glGenTextures(GLsizei n, GLuint* textures) {
   for (GLsizei i = 0; i < n; ++i) { textures[i] = js_glCreateTexture(); }
 }
 
-extern void glActiveTexture(GLenum texture);
+extern void js_glActiveTexture(GLenum texture);
+void glActiveTexture(GLenum texture) {
+  GL_BATCHED(GL_OP_ACTIVE_TEXTURE
+  , js_glActiveTexture(texture)
+  , texture
+  );
+}
 
-extern void glBindTexture(GLenum target, GLuint texture);
+extern void js_glBindTexture(GLenum target, GLuint texture);
+void glBindTexture(GLenum target, GLuint texture) {
+  GL_BATCHED(GL_OP_BIND_TEXTURE
+  , js_glBindTexture(target, texture)
+  , target, texture
+  );
+}
 
 extern void js_glTexImage2D(
   GLenum target, GLint level, GLint internalFormat,
@@ -216,6 +532,11 @@ void glTexImage2D(
   js_glTexImage2D(target, level, inFormat, width, height, format, type, data);
 }
 
+extern void glTexSubImage2D(
+  GLenum target, GLint level, GLint xoffset, GLint yoffset,
+  GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels
+);
+
 extern void glTexStorage3D(
   GLenum target, GLsizei levels, GLenum internalformat,
   GLsizei width, GLsizei height, GLsizei depth
@@ -228,11 +549,36 @@ extern void glTexSubImage3D(
   GLenum format, GLenum type, const void * pixels
 );
 
-extern void glGenerateMipmap(GLenum target);
+extern void glCompressedTexSubImage3D(
+  GLenum target, GLint level,
+  GLint xoffset, GLint yoffset, GLint zoffset,
+  GLsizei width, GLsizei height, GLsizei depth,
+  GLenum format, GLsizei imageSize, const void* data
+);
 
-extern void glTexParameteri(GLenum target, GLenum pname, GLint param);
+extern void js_glGenerateMipmap(GLenum target);
+void glGenerateMipmap(GLenum target) {
+  GL_BATCHED(GL_OP_GENERATE_MIPMAP
+  , js_glGenerateMipmap(target)
+  , target
+  );
+}
 
-extern void glPixelStorei(GLenum pname, GLint param);
+extern void js_glTexParameteri(GLenum target, GLenum pname, GLint param);
+void glTexParameteri(GLenum target, GLenum pname, GLint param) {
+  GL_BATCHED(GL_OP_TEX_PARAMETERI
+  , js_glTexParameteri(target, pname, param)
+  , target, pname, param
+  );
+}
+
+extern void js_glPixelStorei(GLenum pname, GLint param);
+void glPixelStorei(GLenum pname, GLint param) {
+  GL_BATCHED(GL_OP_PIXEL_STOREI
+  , js_glPixelStorei(pname, param)
+  , pname, param
+  );
+}
 
 extern void js_glDeleteTexture(GLuint data_id);
 void glDeleteTextures(GLsizei n, const GLuint* textures) {
@@ -248,7 +594,13 @@ void glGenFramebuffers(GLsizei n, GLuint* framebuffers) {
   for (GLsizei i = 0; i < n; ++i) framebuffers[i] = js_glCreateFramebuffer();
 }
 
-extern void glBindFramebuffer(GLenum target, GLuint framebuffer);
+extern void js_glBindFramebuffer(GLenum target, GLuint framebuffer);
+void glBindFramebuffer(GLenum target, GLuint framebuffer) {
+  GL_BATCHED(GL_OP_BIND_FRAMEBUFFER
+  , js_glBindFramebuffer(target, framebuffer)
+  , target, framebuffer
+  );
+}
 
 extern GLenum glCheckFramebufferStatus(GLenum target);
 
@@ -277,7 +629,13 @@ extern void glGenRenderbuffers(GLsizei n, GLuint* renderbuffers) {
   for (GLsizei i = 0; i < n; ++i) renderbuffers[i] = js_glCreateRenderbuffer();
 }
 
-extern void glBindRenderbuffer(GLenum target, GLuint renderbuffer);
+extern void js_glBindRenderbuffer(GLenum target, GLuint renderbuffer);
+void glBindRenderbuffer(GLenum target, GLuint renderbuffer) {
+  GL_BATCHED(GL_OP_BIND_RENDERBUFFER
+  , js_glBindRenderbuffer(target, renderbuffer)
+  , target, renderbuffer
+  );
+}
 
 extern void glRenderbufferStorage(
   GLenum target, GLenum format, GLsizei width, GLsizei height
@@ -87,6 +87,7 @@ void wasm_alert(slice_t slice) {
 
 void wasp_loading_manager(void) {
   file_loading_manager();
+  img_loading_manager();
   shader_loading_manager();
   mat_loading_manager();
   model_loading_manager();
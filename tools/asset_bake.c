@@ -0,0 +1,253 @@
+/*******************************************************************************
+* MIT License
+*
+* Copyright (c) 2026 Curtis McCoy
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+// Offline baker that does the pixel work materials would otherwise do while
+//    loading: splitting atlases into layers, packing channels, converting the
+//    channel count and building mips. The result is a KTX2 file that
+//    tex_from_ktx2 uploads as-is.
+//
+// Usage: asset_bake [options] <output.ktx2> <input>...
+//    --atlas WxH     Split each input into a WxH grid of tiles, one per layer
+//    --channels N    Convert to 1, 3 or 4 channels (default: the first input's)
+//    --pack          Pack the luminance of up to three inputs into R, G and B,
+//                    use "-" to leave a channel white
+//    --no-mips       Only write the base level
+//    Without --pack, each input (or each of its tiles) becomes a layer.
+//
+// Materials load baked maps when named like "rock.raw.ktx2", so the output for
+//    that material's normal map would be "res/textures/rock_n.raw.ktx2".
+
+#include "image.h"
+#include "str.h"
+#include "../src/loaders/ktx2.h"
+
+#include "stb_image.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BAKE_MAX_INPUTS 64
+
+////////////////////////////////////////////////////////////////////////////////
+
+static Image _load_image(const char* path) {
+  if (!strcmp(path, "-")) return NULL;
+
+  int w, h, c;
+  byte* pixels = stbi_load(path, &w, &h, &c, 0);
+
+  // grey + alpha isn't an image layout the engine uses
+  if (pixels && c == 2) {
+    stbi_image_free(pixels);
+    pixels = stbi_load(path, &w, &h, &c, 4);
+    c = 4;
+  }
+
+  if (!pixels) {
+    fprintf(stderr, "Could not load image %s: %s\n"
+    , path, stbi_failure_reason()
+    );
+    exit(1);
+  }
+
+  Image ret = img_from_bytes(pixels, v2i(w, h), c);
+  stbi_image_free(pixels);
+  return ret;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Box filters each layer of one level into the next, clamping at odd edges
+static void _downsample(
+  const byte* src, vec2i src_size, byte* dst, vec2i dst_size,
+  index_t layers, int channels
+) {
+  index_t src_layer = (index_t)src_size.w * src_size.h * channels;
+  index_t dst_layer = (index_t)dst_size.w * dst_size.h * channels;
+
+  for (index_t layer = 0; layer < layers; ++layer) {
+    const byte* s = src + layer * src_layer;
+    byte* d = dst + layer * dst_layer;
+
+    for (int y = 0; y < dst_size.h; ++y) {
+      int y0 = MIN(y * 2, src_size.h - 1);
+      int y1 = MIN(y * 2 + 1, src_size.h - 1);
+
+      for (int x = 0; x < dst_size.w; ++x) {
+        int x0 = MIN(x * 2, src_size.w - 1);
+        int x1 = MIN(x * 2 + 1, src_size.w - 1);
+
+        for (int c = 0; c < channels; ++c) {
+          int sum = s[(y0 * src_size.w + x0) * channels + c]
+                  + s[(y0 * src_size.w + x1) * channels + c]
+                  + s[(y1 * src_size.w + x0) * channels + c]
+                  + s[(y1 * src_size.w + x1) * channels + c];
+          d[(y * dst_size.w + x) * channels + c] = (byte)((sum + 2) / 4);
+        }
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void _usage(const char* exe) {
+  fprintf(stderr
+  , "Usage: %s [--atlas WxH] [--channels N] [--pack] [--no-mips]"
+    " <output.ktx2> <input>...\n"
+  , exe
+  );
+  exit(1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char* argv[]) {
+  vec2i atlas = i2ones;
+  int channels = 0;
+  bool pack = false;
+  bool mips = true;
+  int arg = 1;
+
+  for (; arg < argc && !strncmp(argv[arg], "--", 2); ++arg) {
+    if (!strcmp(argv[arg], "--atlas") && arg + 1 < argc) {
+      if (sscanf(argv[++arg], "%dx%d", &atlas.w, &atlas.h) != 2
+      ||  atlas.w <= 0 || atlas.h <= 0
+      ) {
+        _usage(argv[0]);
+      }
+    }
+    else if (!strcmp(argv[arg], "--channels") && arg + 1 < argc) {
+      channels = atoi(argv[++arg]);
+      if (channels != 1 && channels != 3 && channels != 4) _usage(argv[0]);
+    }
+    else if (!strcmp(argv[arg], "--pack"))    pack = true;
+    else if (!strcmp(argv[arg], "--no-mips")) mips = false;
+    else _usage(argv[0]);
+  }
+
+  if (argc - arg < 2) _usage(argv[0]);
+  const char* output = argv[arg++];
+  int input_count = argc - arg;
+
+  if (input_count > BAKE_MAX_INPUTS || (pack && input_count > 3)) {
+    fprintf(stderr, "Too many inputs\n");
+    return 1;
+  }
+
+  Image images[BAKE_MAX_INPUTS] = { 0 };
+
+  if (pack) {
+    Image rgb[3] = { 0 };
+    for (int i = 0; i < input_count; ++i) {
+      rgb[i] = _load_image(argv[arg + i]);
+    }
+
+    images[0] = img_pack_channels(rgb[0], rgb[1], rgb[2]);
+    input_count = 1;
+
+    for (int i = 0; i < 3; ++i) {
+      if (rgb[i]) img_delete(&rgb[i]);
+    }
+  }
+  else {
+    for (int i = 0; i < input_count; ++i) {
+      images[i] = _load_image(argv[arg + i]);
+      if (!images[i]) _usage(argv[0]);
+    }
+  }
+
+  // Do the same repacking tex_from_image_atlas would, and check the layers
+  if (!channels) channels = images[0]->channels;
+  vec2i tile = i2div(images[0]->size, atlas);
+  index_t layers = (index_t)input_count * atlas.w * atlas.h;
+
+  for (int i = 0; i < input_count; ++i) {
+    if (images[i]->width != tile.w * atlas.w
+    ||  images[i]->height != tile.h * atlas.h
+    ) {
+      fprintf(stderr, "Input %d doesn't match the first input's size\n", i);
+      return 1;
+    }
+
+    img_set_channels(images[i], channels);
+    img_repack_vertical(images[i], atlas);
+  }
+
+  // Levels go down to 1x1, except for tiny images which are never mipped
+  index_t levels = 1;
+  if (mips && tile.w >= 5 && tile.h >= 5) {
+    while (levels < KTX2_MAX_LEVELS && MAX(tile.w, tile.h) >> levels) {
+      ++levels;
+    }
+  }
+
+  ktx2_t ktx = {
+    .format = channels == 1 ? TF_R_8 : channels == 3 ? TF_RGB_8 : TF_RGBA_8,
+    .size = tile,
+    .layers = layers,
+    .levels = levels,
+  };
+
+  index_t image_size = (index_t)images[0]->width * images[0]->height * channels;
+  byte* base = malloc(image_size * input_count);
+  assert(base);
+
+  for (int i = 0; i < input_count; ++i) {
+    memcpy(base + i * image_size, images[i]->data, image_size);
+    img_delete(&images[i]);
+  }
+
+  ktx.level[0].data = base;
+  ktx.level[0].size = image_size * input_count;
+
+  vec2i size = tile;
+  for (index_t i = 1; i < levels; ++i) {
+    vec2i next = v2i(MAX(size.w / 2, 1), MAX(size.h / 2, 1));
+    index_t level_size = (index_t)next.w * next.h * channels * layers;
+
+    byte* data = malloc(level_size);
+    assert(data);
+    _downsample(ktx.level[i - 1].data, size, data, next, layers, channels);
+
+    ktx.level[i].data = data;
+    ktx.level[i].size = level_size;
+    size = next;
+  }
+
+  bool success = ktx2_write(slice_from_c_str(output), &ktx);
+
+  if (success) {
+    printf("Wrote %s: %dx%d, %d channels, %d layers, %d levels\n"
+    , output, tile.w, tile.h, channels, (int)layers, (int)levels
+    );
+  }
+
+  for (index_t i = 0; i < levels; ++i) {
+    free((void*)ktx.level[i].data);
+  }
+
+  return success ? 0 : 1;
+}
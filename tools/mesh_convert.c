@@ -0,0 +1,101 @@
+/*******************************************************************************
+* MIT License
+*
+* Copyright (c) 2026 Curtis McCoy
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+// Offline converter from text OBJ to the binary .wmesh format loaded by
+//    model_new_load_mesh.
+//
+// Usage: mesh_convert <input.obj> [output.wmesh]
+//    If no output is given, the input path is used with a .wmesh extension.
+
+#include "str.h"
+#include "../src/loaders/obj.h"
+#include "../src/loaders/wmesh.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static char* _read_file(const char* path, index_t* size) {
+  FILE* f = fopen(path, "rb");
+  if (!f) return NULL;
+
+  fseek(f, 0, SEEK_END);
+  long length = ftell(f);
+  fseek(f, 0, SEEK_SET);
+
+  char* buffer = length > 0 ? malloc(length) : NULL;
+  if (buffer && fread(buffer, 1, length, f) != (size_t)length) {
+    free(buffer);
+    buffer = NULL;
+  }
+
+  fclose(f);
+  *size = length;
+  return buffer;
+}
+
+int main(int argc, char* argv[]) {
+  if (argc < 2 || argc > 3) {
+    fprintf(stderr, "Usage: %s <input.obj> [output.wmesh]\n", argv[0]);
+    return 1;
+  }
+
+  index_t size = 0;
+  char* text = _read_file(argv[1], &size);
+  if (!text) {
+    fprintf(stderr, "Could not read file: %s\n", argv[1]);
+    return 1;
+  }
+
+  slice_t input = slice_from_c_str(argv[1]);
+  model_obj_t obj = file_load_obj((slice_t) { .begin = text, .size = size });
+  free(text);
+
+  if (!obj.verts || !obj.verts->size) {
+    fprintf(stderr, "No geometry found in: %s\n", argv[1]);
+    return 1;
+  }
+
+  if (!obj.name) {
+    obj.name = str_copy(str_between_last(input, "/", "."));
+  }
+
+  String output = argc == 3
+    ? str_copy(slice_from_c_str(argv[2]))
+    : str_format("{}.wmesh", slice_until_last(input, S(".")));
+
+  bool success = wmesh_write(output->slice, &obj);
+
+  if (success) {
+    printf("Wrote %s: %d verts, %d indices\n", output->begin
+    , (int)obj.verts->size, (int)obj.indices->size
+    );
+  }
+
+  str_delete(&output);
+  str_delete(&obj.name);
+  arr_delete(&obj.verts);
+  arr_delete(&obj.indices);
+
+  return success ? 0 : 1;
+}
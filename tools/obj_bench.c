@@ -0,0 +1,499 @@
+/*******************************************************************************
+* MIT License
+*
+* Copyright (c) 2026 Curtis McCoy
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+// Benchmark comparing file_load_obj against the previous tokenizer and
+//    HMap based OBJ parser, kept here as the baseline.
+//
+// Usage: obj_bench [file.obj]
+//    Without a file, a generated grid of about two million triangles is used.
+//
+// Every result is compared byte for byte with the previous parser's, and the
+//    run fails on any difference. Smaller grids also check that relative
+//    (negative) and "v//vn" references give the same mesh as the absolute
+//    references the previous parser understood.
+
+#include "str.h"
+#include "array.h"
+#include "map.h"
+#include "thread.h"
+#include "../src/loaders/obj.h"
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct {
+  vec3 pos;
+  vec3 color;
+} obj_vertex_part_t;
+
+typedef struct {
+  int vert;
+  int norm;
+  int uv;
+} obj_face_elem_t;
+
+////////////////////////////////////////////////////////////////////////////////
+// Previous parser, unchanged apart from logging
+////////////////////////////////////////////////////////////////////////////////
+
+static model_obj_t _obj_load_legacy(slice_t text) {
+  model_obj_t model = { .format = VF_UV_NORM };
+
+  Array verts = arr_new(obj_vertex_part_t);
+  Array norms = arr_new(vec3);
+  Array uvs   = arr_new(vec2);
+  Array faces = arr_new(obj_face_elem_t);
+  
+  index_t line_pos = 0;
+
+  while (line_pos < text.length) {
+    slice_t line = str_token_line(text, &line_pos).token;
+
+    index_t i = 0;
+    while (i < line.length) {
+      slice_t token = str_token_space(line, &i).token;
+      if (token.length <= 0) break;
+
+      switch (token.begin[0]) {
+
+        // Read vertex info
+        case 'v': {
+
+          if (token.length == 1) {
+            obj_vertex_part_t* vert = arr_emplace_back(verts);
+
+            // coordinate
+            slice_to_float(slice_token_space(line, &i).token, &vert->pos.x);
+            slice_to_float(slice_token_space(line, &i).token, &vert->pos.y);
+            slice_to_float(slice_token_space(line, &i).token, &vert->pos.z);
+
+            // optional vertex color
+            if (i != line.length) {
+              model.format = VF_UV_NORM_COLOR;
+              slice_to_float(slice_token_space(line, &i).token, &vert->color.r);
+              slice_to_float(slice_token_space(line, &i).token, &vert->color.g);
+              slice_to_float(slice_token_space(line, &i).token, &vert->color.b);
+            }
+            else {
+              vert->color = c4white.rgb;
+            }
+          }
+
+          // Either 'vt' or 'vn' sections, read a texcoord or normal
+          else {
+
+            switch (token.begin[1]) {
+
+              // read a vertex normal
+              case 'n': {
+                vec3* norm = arr_emplace_back(norms);
+                slice_to_float(slice_token_space(line, &i).token, &norm->x);
+                slice_to_float(slice_token_space(line, &i).token, &norm->y);
+                slice_to_float(slice_token_space(line, &i).token, &norm->z);
+              } break;
+
+              // read a texture coordinate
+              case 't': {
+                vec2* uv = arr_emplace_back(uvs);
+                slice_to_float(slice_token_space(line, &i).token, &uv->u);
+                slice_to_float(slice_token_space(line, &i).token, &uv->v);
+              } break;
+
+              // unsupported vertex object
+              default: {
+                assert(false);
+              } break;
+
+            }
+
+          }
+
+        } break;
+
+        // Read a face
+        case 'f': {
+          obj_face_elem_t elem0;
+          slice_to_int(str_token_char(line, "/", &i).token, &elem0.vert);
+          slice_to_int(str_token_char(line, "/", &i).token, &elem0.uv);
+          slice_to_int(slice_token_space(line, &i).token, &elem0.norm);
+          arr_write_back(faces, &elem0);
+
+          obj_face_elem_t elem1;
+          slice_to_int(str_token_char(line, "/", &i).token, &elem1.vert);
+          slice_to_int(str_token_char(line, "/", &i).token, &elem1.uv);
+          slice_to_int(slice_token_space(line, &i).token, &elem1.norm);
+          arr_write_back(faces, &elem1);
+
+          obj_face_elem_t elem2;
+          slice_to_int(str_token_char(line, "/", &i).token, &elem2.vert);
+          slice_to_int(str_token_char(line, "/", &i).token, &elem2.uv);
+          slice_to_int(slice_token_space(line, &i).token, &elem2.norm);
+          arr_write_back(faces, &elem2);
+
+          while (i < line.length) {
+            slice_to_int(str_token_char(line, "/", &i).token, &elem0.vert);
+            slice_to_int(str_token_char(line, "/", &i).token, &elem0.uv);
+            slice_to_int(slice_token_space(line, &i).token, &elem0.norm);
+            arr_write_back(faces, &elem1);
+            arr_write_back(faces, &elem2);
+            arr_write_back(faces, &elem0);
+            elem1 = elem2;
+            elem2 = elem0;
+          }
+        } break;
+
+        case 'o': {
+          model.name = str_copy(slice_drop(line, i));
+        } break;
+
+        // Skip past the line if it's a comment, object name, or whatever 's' is
+        default: {
+          i = line.length;
+        } break;
+
+      }
+
+    }
+
+  }
+
+  model.indices = arr_new_reserve(uint, faces->size);
+
+  switch (model.format) {
+    case VF_UV_NORM: model.verts = arr_new(vertex_uv_norm_t); break;
+    case VF_UV_NORM_COLOR: model.verts = arr_new(vertex_uv_norm_color_t); break;
+    default: assert(false); break;
+  }
+
+  // Collect face index values into into shared vertex data and the index list.
+  HMap vmap = map_new(obj_face_elem_t, uint, NULL, NULL);
+  map_reserve(vmap, faces->size);
+
+  obj_face_elem_t* arr_foreach(f, faces) {
+    res_ensure_t e = map_ensure(vmap, f);
+    if (e.is_new) {
+      obj_vertex_part_t* vert = arr_ref(verts, f->vert - 1);
+      *(uint*)e.value = (uint)model.verts->size;
+      arr_write_back(model.indices, e.value);
+      arr_write_back(model.verts, &(vertex_uv_norm_color_t) {
+        .pos = vert->pos,
+        .uv = *((vec2*)arr_ref(uvs, f->uv - 1)),
+        .norm = *((vec3*)arr_ref(norms, f->norm - 1)),
+        .tangent = v4zero,
+        .color = vert->color,
+      });
+    }
+    else {
+      arr_write_back(model.indices, e.value);
+    }
+  }
+
+  map_delete(&vmap);
+
+  // Cleanup...
+  arr_delete(&faces);
+  arr_delete(&verts);
+  arr_delete(&uvs);
+  arr_delete(&norms);
+
+  arr_truncate(model.verts, model.verts->size);
+
+  str_log("[Model.build] Parsed model {} - verts: {}, indices: {}"
+  , model.name, model.verts->size, model.indices->size
+  );
+
+  // Calculate tangents for each vertex...
+  if (model.indices->size >= 3) {
+    uint* indices = model.indices->begin;
+
+    for (index_t i = 0; i < model.indices->size; i += 3) {
+      uint i0 = indices[i];
+      uint i1 = indices[i + 1];
+      uint i2 = indices[i + 2];
+
+      vertex_uv_norm_t* vtx[3] = {
+        arr_ref(model.verts, i0),
+        arr_ref(model.verts, i1),
+        arr_ref(model.verts, i2)
+      };
+
+      vec3 n0 = vtx[0]->norm;
+      vec3 p0 = vtx[0]->pos;
+      //vec2 uv0 = vtx[0]->uv;
+
+      vec3 p1 = vtx[1]->pos;
+      vec2 uv1 = vtx[1]->uv;
+
+      vec3 p2 = vtx[2]->pos;
+      vec2 uv2 = vtx[2]->uv;
+
+      vec3 e1 = v3sub(p1, p0);
+      vec3 e2 = v3sub(p2, p0);
+
+      float uv_cross = v2cross(uv1, uv2);
+      vec3 tangent;
+      float handedness;
+
+      if (fabs(uv_cross) < 0.000001f) {
+        tangent = v3perp(n0);
+        //tangent = v3zero;
+        handedness = 1;
+      }
+      else {
+        float r = 1.0f / uv_cross;
+
+        tangent = v3sub(v3scale(e1, uv2.y), v3scale(e2, uv1.y));
+        vec3 bitangent = v3sub(v3scale(e2, uv1.x), v3scale(e1, uv2.x));
+        tangent = v3scale(tangent, r);
+        bitangent = v3scale(bitangent, r);
+
+        handedness = v3dot(v3cross(n0, tangent), bitangent) < 0 ? -1.0f : 1.0f;
+      }
+
+      for (index_t j = 0; j < 3; ++j) {
+        vtx[j]->tangent.xyz = v3add(vtx[j]->tangent.xyz, tangent);
+        if (vtx[j]->tangent.w == 0.0f) vtx[j]->tangent.w = handedness;
+      }
+    }
+
+    for (index_t i = 0; i < model.verts->size; ++i) {
+      vertex_uv_norm_t* vtx = arr_ref(model.verts, i);
+      vtx->tangent.xyz = v3norm(vtx->tangent.xyz);
+    }
+  }
+
+  return model;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Benchmark harness
+////////////////////////////////////////////////////////////////////////////////
+
+static double _now(void) {
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+typedef struct {
+  char*   begin;
+  index_t size;
+  index_t capacity;
+} obj_text_t;
+
+static void _emit(obj_text_t* text, const char* format, ...) {
+  if (text->capacity - text->size < 256) {
+    text->capacity = MAX(text->capacity * 2, 1 << 16);
+    text->begin = realloc(text->begin, text->capacity);
+  }
+
+  va_list args;
+  va_start(args, format);
+  text->size += vsnprintf(
+    text->begin + text->size, text->capacity - text->size, format, args
+  );
+  va_end(args);
+}
+
+// How the generated grid's faces refer to their elements
+typedef enum {
+  GRID_ABSOLUTE,    // "f 1/1/1 ..."
+  GRID_RELATIVE,    // "f -9/-9/-9 ...", counted back from the last declared
+  GRID_NO_UV,       // "f 1//1 ...", without texture coordinates
+  GRID_SHARED_UV,   // "f 1/1/1 ...", every corner using one "vt 0 0"
+} grid_refs_t;
+
+static void _emit_corner(obj_text_t* text, grid_refs_t refs, int i, int n) {
+  int rel = i - (n + 1) * (n + 1) - 1;
+
+  switch (refs) {
+    case GRID_ABSOLUTE:   _emit(text, " %d/%d/%d", i, i, i); break;
+    case GRID_RELATIVE:   _emit(text, " %d/%d/%d", rel, rel, rel); break;
+    case GRID_NO_UV:      _emit(text, " %d//%d", i, i); break;
+    case GRID_SHARED_UV:  _emit(text, " %d/1/%d", i, i); break;
+  }
+}
+
+static char* _generate_grid(int n, grid_refs_t refs, index_t* size) {
+  obj_text_t text = { 0 };
+  bool uvs = refs == GRID_ABSOLUTE || refs == GRID_RELATIVE;
+
+  if (refs == GRID_SHARED_UV) _emit(&text, "vt 0 0\n");
+
+  for (int y = 0; y <= n; ++y) {
+    for (int x = 0; x <= n; ++x) {
+      float u = (float)x / (float)n;
+      float v = (float)y / (float)n;
+      _emit(&text, "v %f %f %f\n", u * 10.f, sinf(u * v), v * 10.f);
+      if (uvs) _emit(&text, "vt %f %f\n", u, v);
+      _emit(&text, "vn 0 1 0\n");
+    }
+  }
+
+  for (int y = 0; y < n; ++y) {
+    for (int x = 0; x < n; ++x) {
+      int a = y * (n + 1) + x + 1;
+      _emit(&text, "f");
+      _emit_corner(&text, refs, a, n);
+      _emit_corner(&text, refs, a + 1, n);
+      _emit_corner(&text, refs, a + n + 2, n);
+      _emit_corner(&text, refs, a + n + 1, n);
+      _emit(&text, "\n");
+    }
+  }
+
+  *size = text.size;
+  return text.begin;
+}
+
+static char* _read_file(const char* path, index_t* size) {
+  FILE* f = fopen(path, "rb");
+  if (!f) return NULL;
+
+  fseek(f, 0, SEEK_END);
+  long length = ftell(f);
+  fseek(f, 0, SEEK_SET);
+
+  char* buffer = length > 0 ? malloc(length) : NULL;
+  if (buffer && fread(buffer, 1, length, f) != (size_t)length) {
+    free(buffer);
+    buffer = NULL;
+  }
+
+  fclose(f);
+  *size = length;
+  return buffer;
+}
+
+typedef model_obj_t (obj_load_fn_t)(slice_t);
+
+static void _obj_free(model_obj_t* obj) {
+  str_delete(&obj->name);
+  arr_delete(&obj->verts);
+  arr_delete(&obj->indices);
+}
+
+static bool _arr_same(Array a, Array b) {
+  if (!a || !b) return a == b;
+  return a->element_size == b->element_size
+      && a->size_bytes == b->size_bytes
+      && memcmp(a->begin, b->begin, a->size_bytes) == 0;
+}
+
+// Loads the text and checks the result matches `expected` exactly
+static bool _run(
+  const char* label, obj_load_fn_t* load, slice_t text,
+  const model_obj_t* expected
+) {
+  double start = _now();
+  model_obj_t obj = load(text);
+  double elapsed = _now() - start;
+
+  bool same = obj.format == expected->format
+    && _arr_same(obj.verts, expected->verts)
+    && _arr_same(obj.indices, expected->indices);
+
+  printf("%-32s %8.1f ms   verts: %d  indices: %d%s\n"
+  , label, elapsed * 1000.0
+  , obj.verts ? (int)obj.verts->size : 0
+  , obj.indices ? (int)obj.indices->size : 0
+  , same ? "" : "   MISMATCH"
+  );
+
+  _obj_free(&obj);
+  return same;
+}
+
+// The previous parser only understood absolute "v/vt/vn" references, so each
+//    other form is checked against the grid it should be equivalent to
+static bool _check_refs(
+  const char* label, grid_refs_t refs, grid_refs_t reference
+) {
+  index_t size = 0;
+  char* text = _generate_grid(100, reference, &size);
+  model_obj_t expected = _obj_load_legacy((slice_t) {
+    .begin = text, .size = size
+  });
+  free(text);
+
+  text = _generate_grid(100, refs, &size);
+  bool same = _run(label, file_load_obj, (slice_t) {
+    .begin = text, .size = size
+  }, &expected);
+  free(text);
+
+  _obj_free(&expected);
+  return same;
+}
+
+int main(int argc, char* argv[]) {
+  index_t size = 0;
+  char* text = argc > 1
+    ? _read_file(argv[1], &size)
+    : _generate_grid(1000, GRID_ABSOLUTE, &size);
+
+  if (!text) {
+    fprintf(stderr, "Could not read file: %s\n", argv[1]);
+    return 1;
+  }
+
+  slice_t input = { .begin = text, .size = size };
+  printf("Input: %.1f MiB\n", (double)size / (1024.0 * 1024.0));
+
+  double start = _now();
+  model_obj_t expected = _obj_load_legacy(input);
+  printf("%-32s %8.1f ms   verts: %d  indices: %d\n"
+  , "previous parser", (_now() - start) * 1000.0
+  , (int)expected.verts->size, (int)expected.indices->size
+  );
+
+  bool same = _run("file_load_obj (1 thread)", file_load_obj, input, &expected);
+
+  jobs_init(0);
+  char label[64];
+  snprintf(label, sizeof(label), "file_load_obj (%d threads)"
+  , (int)jobs_thread_count()
+  );
+  same = _run(label, file_load_obj, input, &expected) && same;
+
+  same = _check_refs("relative references"
+  , GRID_RELATIVE, GRID_ABSOLUTE) && same;
+  same = _check_refs("v//vn references"
+  , GRID_NO_UV, GRID_SHARED_UV) && same;
+  jobs_shutdown();
+
+  _obj_free(&expected);
+  free(text);
+
+  if (!same) {
+    fprintf(stderr, "file_load_obj differs from the previous parser\n");
+    return 1;
+  }
+
+  return 0;
+}
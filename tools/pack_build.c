@@ -0,0 +1,105 @@
+/*******************************************************************************
+* MIT License
+*
+* Copyright (c) 2026 Curtis McCoy
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+// Offline packer that bundles asset files into a .wpak archive that the
+//    engine mounts with file_mount_pack.
+//
+// Usage: pack_build <output.wpak> <files...>
+//    Run from the directory the game runs from, files are stored under the
+//    paths given (without any leading "./") and looked up by those paths.
+
+#include "str.h"
+#include "../src/loaders/wpack.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static char* _read_file(const char* path, index_t* size) {
+  FILE* f = fopen(path, "rb");
+  if (!f) return NULL;
+
+  fseek(f, 0, SEEK_END);
+  long length = ftell(f);
+  fseek(f, 0, SEEK_SET);
+
+  // Empty files are still packed, so they need a non-null buffer
+  char* buffer = malloc(length > 0 ? length : 1);
+  if (buffer && length > 0 && fread(buffer, 1, length, f) != (size_t)length) {
+    free(buffer);
+    buffer = NULL;
+  }
+
+  fclose(f);
+  *size = length;
+  return buffer;
+}
+
+int main(int argc, char* argv[]) {
+  if (argc < 3) {
+    fprintf(stderr, "Usage: %s <output.wpak> <files...>\n", argv[0]);
+    return 1;
+  }
+
+  index_t count = argc - 2;
+  wpack_file_t* files = calloc(count, sizeof(wpack_file_t));
+  assert(files);
+
+  bool success = true;
+  index_t total = 0;
+
+  for (index_t i = 0; i < count; ++i) {
+    const char* path = argv[i + 2];
+    index_t size = 0;
+    char* data = _read_file(path, &size);
+
+    if (!data) {
+      fprintf(stderr, "Could not read file: %s\n", path);
+      success = false;
+      break;
+    }
+
+    files[i] = (wpack_file_t) {
+      .name = slice_from_c_str(path),
+      .data = { .begin = data, .size = size },
+    };
+    total += size;
+  }
+
+  if (success) {
+    success = wpack_write(slice_from_c_str(argv[1]), files, count);
+  }
+
+  if (success) {
+    printf("Wrote %s: %d files, %d bytes of data\n", argv[1]
+    , (int)count, (int)total
+    );
+  }
+
+  for (index_t i = 0; i < count; ++i) {
+    free((void*)files[i].data.begin);
+  }
+  free(files);
+
+  return success ? 0 : 1;
+}
@@ -0,0 +1,179 @@
+/*******************************************************************************
+* MIT License
+*
+* Copyright (c) 2026 Curtis McCoy
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "cspec.h"
+#include "file.h"
+
+// Streams read from disk through SDL's async IO, which the web build doesn't
+//    have, so these only run natively
+#ifndef __WASM__
+
+#include "SDL3/SDL.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define SPEC_FILE       "file_spec_stream.tmp"
+#define SPEC_TEXT       "0123456789abcdefghijklmnopqrstuvwxyz"
+#define SPEC_TEXT_SIZE  ((index_t)sizeof(SPEC_TEXT) - 1)
+
+typedef struct spec_stream_t {
+  char    data[64];
+  index_t size;
+  index_t calls;
+  index_t last_calls;   // calls made with the last flag set
+  index_t last_at;      // the call that had it
+  index_t largest;      // largest chunk seen
+  index_t stop_after;   // calls before the consumer stops, 0 for never
+} spec_stream_t;
+
+static bool _spec_chunk(File file, slice_t chunk, bool last, void* data) {
+  UNUSED(file);
+  spec_stream_t* log = data;
+  assert(log->size + chunk.size <= (index_t)sizeof(log->data));
+
+  memcpy(log->data + log->size, chunk.begin, chunk.size);
+  log->size += chunk.size;
+  log->largest = MAX(log->largest, chunk.size);
+
+  ++log->calls;
+  if (last) {
+    ++log->last_calls;
+    log->last_at = log->calls;
+  }
+
+  return !log->stop_after || log->calls < log->stop_after;
+}
+
+static void _spec_write(const char* text, size_t size) {
+  FILE* f = fopen(SPEC_FILE, "wb");
+  assert(f);
+  fwrite(text, 1, size, f);
+  fclose(f);
+}
+
+// Pumps the loading manager until the stream is done with, failing the wait
+//    after a couple of seconds rather than hanging
+static void _spec_run(File file) {
+  for (int i = 0; i < 2000 && file->status == S_LOADING; ++i) {
+    file_loading_manager();
+    if (file->status == S_LOADING) SDL_Delay(1);
+  }
+}
+
+#endif
+
+describe(file_new_stream) {
+
+#ifndef __WASM__
+
+  it("delivers the whole file in chunks no larger than asked for") {
+    spec_stream_t log = { 0 };
+    _spec_write(SPEC_TEXT, SPEC_TEXT_SIZE);
+
+    File file = file_new_stream(S(SPEC_FILE), 5, _spec_chunk, &log);
+    _spec_run(file);
+
+    expect(file->status == S_READY);
+    expect(log.size == SPEC_TEXT_SIZE);
+    expect(memcmp(log.data, SPEC_TEXT, SPEC_TEXT_SIZE) == 0);
+    expect(log.largest == 5);
+    expect(log.calls == (SPEC_TEXT_SIZE + 4) / 5);
+
+    file_delete(&file);
+  }
+
+  it("sets the last flag once, on the final chunk") {
+    spec_stream_t log = { 0 };
+    _spec_write(SPEC_TEXT, SPEC_TEXT_SIZE);
+
+    // a chunk size that divides the file evenly has no short final chunk
+    File file = file_new_stream(S(SPEC_FILE), 4, _spec_chunk, &log);
+    _spec_run(file);
+
+    expect(file->status == S_READY);
+    expect(log.last_calls == 1);
+    expect(log.last_at == log.calls);
+    expect(log.calls == SPEC_TEXT_SIZE / 4);
+
+    file_delete(&file);
+  }
+
+  it("makes one empty last call for an empty file") {
+    spec_stream_t log = { 0 };
+    _spec_write("", 0);
+
+    File file = file_new_stream(S(SPEC_FILE), 4, _spec_chunk, &log);
+    _spec_run(file);
+
+    expect(file->status == S_READY);
+    expect(log.calls == 1);
+    expect(log.last_calls == 1);
+    expect(log.size == 0);
+
+    file_delete(&file);
+  }
+
+  it("stops reading when the consumer returns false") {
+    spec_stream_t log = { .stop_after = 2 };
+    _spec_write(SPEC_TEXT, SPEC_TEXT_SIZE);
+
+    File file = file_new_stream(S(SPEC_FILE), 5, _spec_chunk, &log);
+    _spec_run(file);
+
+    expect(file->status == S_CLOSED);
+    expect(log.calls == 2);
+    expect(log.last_calls == 0);
+    expect(log.size == 10);
+    expect(file_loading_count() == 0);
+
+    file_delete(&file);
+  }
+
+  it("fails for a missing file without calling the consumer") {
+    spec_stream_t log = { 0 };
+    remove(SPEC_FILE);
+
+    File file = file_new_stream(S(SPEC_FILE), 5, _spec_chunk, &log);
+    _spec_run(file);
+
+    expect(file->status == S_FAILED);
+    expect(log.calls == 0);
+
+    file_delete(&file);
+  }
+
+  it("leaves nothing loading once the streams are done") {
+    remove(SPEC_FILE);
+    expect(file_loading_count() == 0);
+  }
+
+#endif
+
+}
+
+test_suite(tests_file) {
+  test_group(file_new_stream),
+  test_suite_end
+};
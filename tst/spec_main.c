@@ -28,6 +28,8 @@
 
 extern TestSuite tests_cspec;
 extern TestSuite tests_string;
+extern TestSuite tests_file;
+extern TestSuite tests_wmesh;
 
 // Main
 
@@ -42,7 +44,9 @@ int main(int argc, char* argv[]) {
 #endif
   TestSuite* test_suites[] = {
     &tests_cspec,
-    &tests_string
+    &tests_string,
+    &tests_file,
+    &tests_wmesh
   };
 
   return cspec_run_all(test_suites);
@@ -0,0 +1,188 @@
+/*******************************************************************************
+* MIT License
+*
+* Copyright (c) 2026 Curtis McCoy
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "cspec.h"
+#include "../src/loaders/wmesh.h"
+
+#include <string.h>
+
+// A one-triangle mesh laid out the way wmesh_write does it
+#define SPEC_VERTS      3
+#define SPEC_NAME       "tri"
+#define SPEC_ALIGN(x)   (((x) + WMESH_ALIGNMENT - 1) & ~(WMESH_ALIGNMENT - 1))
+
+typedef struct spec_mesh_t {
+  byte    data[512];
+  index_t size;
+} spec_mesh_t;
+
+// What the reader handed on, put back together
+typedef struct spec_read_t {
+  byte    blocks[WMESH_BLOCK_COUNT][256];
+  index_t sizes[WMESH_BLOCK_COUNT];
+  index_t headers;
+  index_t stop_after;   // blocks pieces before stopping, 0 for never
+  index_t pieces;
+} spec_read_t;
+
+static void _spec_mesh(spec_mesh_t* mesh, uint index) {
+  index_t stride = vertex_size(VF_UV_NORM);
+
+  wmesh_header_t header = {
+    .magic = WMESH_MAGIC,
+    .version = WMESH_VERSION,
+    .format = VF_UV_NORM,
+    .vert_count = SPEC_VERTS,
+    .index_count = 3,
+    .name_size = sizeof(SPEC_NAME) - 1,
+  };
+
+  header.vert_offset = SPEC_ALIGN(sizeof(header));
+  header.index_offset = SPEC_ALIGN(header.vert_offset + stride * SPEC_VERTS);
+  header.name_offset = SPEC_ALIGN(header.index_offset + 3 * sizeof(uint));
+  mesh->size = header.name_offset + header.name_size;
+  assert(mesh->size <= (index_t)sizeof(mesh->data));
+
+  memset(mesh->data, 0, sizeof(mesh->data));
+  memcpy(mesh->data, &header, sizeof(header));
+
+  for (index_t i = 0; i < stride * SPEC_VERTS; ++i) {
+    mesh->data[header.vert_offset + i] = (byte)i;
+  }
+
+  uint indices[3] = { 0, 1, index };
+  memcpy(mesh->data + header.index_offset, indices, sizeof(indices));
+  memcpy(mesh->data + header.name_offset, SPEC_NAME, header.name_size);
+}
+
+static bool _spec_header(void* data, const wmesh_header_t* header) {
+  UNUSED(header);
+  ++((spec_read_t*)data)->headers;
+  return true;
+}
+
+static bool _spec_block(
+  void* data, wmesh_block_t block, index_t offset, slice_t bytes
+) {
+  spec_read_t* read = data;
+  assert(offset + bytes.size <= (index_t)sizeof(read->blocks[block]));
+
+  // pieces of a block arrive in order with nothing skipped
+  if (offset != read->sizes[block]) return false;
+
+  memcpy(read->blocks[block] + offset, bytes.begin, bytes.size);
+  read->sizes[block] += bytes.size;
+
+  return !read->stop_after || ++read->pieces < read->stop_after;
+}
+
+// Feeds the mesh in pieces of `step` bytes, the last piece flagged as such
+static bool _spec_feed(
+  const spec_mesh_t* mesh, index_t step, index_t size, spec_read_t* read
+) {
+  wmesh_reader_t reader = {
+    .on_header = _spec_header,
+    .on_block = _spec_block,
+    .data = read,
+  };
+
+  for (index_t at = 0; at < size || at == 0; at += step) {
+    index_t n = MIN(step, size - at);
+    slice_t piece = { .begin = (const char*)mesh->data + at, .size = n };
+    if (!wmesh_reader_feed(&reader, piece, at + n >= size)) return false;
+    if (!n) break;
+  }
+
+  return true;
+}
+
+describe(wmesh_reader_feed) {
+
+  it("reads the same blocks however the file is split") {
+    spec_mesh_t mesh;
+    _spec_mesh(&mesh, 2);
+
+    wmesh_t whole;
+    slice_t all = { .begin = (const char*)mesh.data, .size = mesh.size };
+    expect(wmesh_parse(all, &whole));
+
+    for (index_t step = 1; step <= mesh.size; ++step) {
+      spec_read_t read = { 0 };
+      expect(_spec_feed(&mesh, step, mesh.size, &read));
+
+      expect(read.headers == 1);
+      expect(read.sizes[WMESH_BLOCK_VERTS] == whole.verts_size);
+      expect(read.sizes[WMESH_BLOCK_INDICES] == whole.indices_size);
+      expect(read.sizes[WMESH_BLOCK_NAME] == whole.name.size);
+      expect(memcmp(read.blocks[WMESH_BLOCK_VERTS], whole.verts
+      , whole.verts_size) == 0
+      );
+      expect(memcmp(read.blocks[WMESH_BLOCK_INDICES], whole.indices
+      , whole.indices_size) == 0
+      );
+      expect(memcmp(read.blocks[WMESH_BLOCK_NAME], SPEC_NAME
+      , whole.name.size) == 0
+      );
+    }
+  }
+
+  it("rejects a file that ends early on the last piece") {
+    spec_mesh_t mesh;
+    _spec_mesh(&mesh, 2);
+
+    spec_read_t read = { 0 };
+    expect(!_spec_feed(&mesh, 7, mesh.size - 1, &read));
+
+    spec_read_t header_only = { 0 };
+    expect(!_spec_feed(&mesh, 7, 10, &header_only));
+    expect(header_only.headers == 0);
+  }
+
+  it("rejects an index past the vertex count, even split across pieces") {
+    spec_mesh_t mesh;
+    _spec_mesh(&mesh, SPEC_VERTS);
+
+    for (index_t step = 1; step <= 8; ++step) {
+      spec_read_t read = { 0 };
+      expect(!_spec_feed(&mesh, step, mesh.size, &read));
+      expect(read.sizes[WMESH_BLOCK_INDICES] < 3 * (index_t)sizeof(uint));
+    }
+  }
+
+  it("stops when a consumer returns false") {
+    spec_mesh_t mesh;
+    _spec_mesh(&mesh, 2);
+
+    spec_read_t read = { .stop_after = 1 };
+    expect(!_spec_feed(&mesh, 16, mesh.size, &read));
+    expect(read.pieces == 1);
+    expect(read.sizes[WMESH_BLOCK_NAME] == 0);
+  }
+
+}
+
+test_suite(tests_wmesh) {
+  test_group(wmesh_reader_feed),
+  test_suite_end
+};
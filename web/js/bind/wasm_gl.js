@@ -1,6 +1,7 @@
 import { types } from "./wasm_const.js";
 
 function wasm_import_gl(imports, game) {
+  const existing = new Set(Object.keys(imports));
 
   imports["glGetError"] = () => {
     return game.gl.getError();
@@ -10,27 +11,31 @@ function wasm_import_gl(imports, game) {
     return game.gl.getParameter(pname);
   }
 
-  imports["glViewport"] = (x, y, width, height) => {
+  imports["js_glGetExtension"] = (name, len) => {
+    return game.gl.getExtension(game.str(name, len)) ? 1 : 0;
+  }
+
+  imports["js_glViewport"] = (x, y, width, height) => {
     game.gl.viewport(x, y, width, height);
   }
 
-  imports["glEnable"] = (cap) => {
+  imports["js_glEnable"] = (cap) => {
     game.gl.enable(cap);
   }
 
-  imports["glDisable"] = (cap) => {
+  imports["js_glDisable"] = (cap) => {
     game.gl.disable(cap);
   }
 
-  imports["glBlendFunc"] = (sfactor, dfactor) => {
+  imports["js_glBlendFunc"] = (sfactor, dfactor) => {
     game.gl.blendFunc(sfactor, dfactor);
   }
 
-  imports["glClear"] = (mask) => {
+  imports["js_glClear"] = (mask) => {
     game.gl.clear(mask);
   }
 
-  imports["glClearColor"] = (red, green, blue, alpha) => {
+  imports["js_glClearColor"] = (red, green, blue, alpha) => {
     game.gl.clearColor(red, green, blue, alpha);
   }
 
@@ -115,7 +120,9 @@ function wasm_import_gl(imports, game) {
     if (pname == 0x8b84) { // case: GL_INFO_LOG_LENGTH
       return game.gl.getProgramInfoLog(data.shader).length + 1;
     }
-    return game.gl.getProgramParameter(data.program, pname) ? 1 : 0;
+    // counts (active uniforms, attributes...) come back as numbers
+    let value = game.gl.getProgramParameter(data.program, pname);
+    return typeof value == "number" ? value : (value ? 1 : 0);
   };
 
   imports["js_glGetProgramInfoLog"] = (data_id, exp_len, out_buf) => {
@@ -133,7 +140,7 @@ function wasm_import_gl(imports, game) {
     return i;
   }
 
-  imports["glUseProgram"] = (data_id) => {
+  imports["js_glUseProgram"] = (data_id) => {
     let data = game.data[data_id];
     if (!data || data.type != types.sprog) return;
     game.gl.useProgram(data.program);
@@ -147,45 +154,89 @@ function wasm_import_gl(imports, game) {
 
   imports["js_glGetUniformLocation"] = (program_id, name, len) => {
     let data = game.data[program_id];
-    if (!data || data.type != types.sprog) return 0;
+    if (!data || data.type != types.sprog) return -1;
+    let location =
+      game.gl.getUniformLocation(data.program, game.str(name, len));
+    if (location === null) return -1;
     // TODO: also store ref in program data so we can delete them later
     return game.store({
       type: types.uniform,
       ready: true,
-      location: game.gl.getUniformLocation(data.program, game.str(name, len))
+      location: location,
     });
   }
 
+  // Writes a WebGLActiveInfo out through glGetActive* style pointers
+  const write_active_info = (info, max, out_len, out_size, out_type, out) => {
+    let length = 0;
+    if (info) {
+      let name = game.utf8.encoder.encode(info.name);
+      length = Math.min(max - 1, name.length);
+      let dat = game.memory(out, length + 1);
+      dat.set(name.subarray(0, length));
+      dat[length] = 0;
+      game.memory_i(out_size, 1)[0] = info.size;
+      game.memory_i(out_type, 1)[0] = info.type;
+    }
+    game.memory_i(out_len, 1)[0] = length;
+  }
+
+  imports["glGetActiveUniform"] = (data_id, i, max, len, size, type, out) => {
+    let data = game.data[data_id];
+    if (!data || data.type != types.sprog) return;
+    let info = game.gl.getActiveUniform(data.program, i);
+    write_active_info(info, max, len, size, type, out);
+  }
+
+  imports["glGetActiveAttrib"] = (data_id, i, max, len, size, type, out) => {
+    let data = game.data[data_id];
+    if (!data || data.type != types.sprog) return;
+    let info = game.gl.getActiveAttrib(data.program, i);
+    write_active_info(info, max, len, size, type, out);
+  }
+
+  imports["js_glGetUniformBlockIndex"] = (data_id, name, len) => {
+    let data = game.data[data_id];
+    if (!data || data.type != types.sprog) return game.gl.INVALID_INDEX;
+    return game.gl.getUniformBlockIndex(data.program, game.str(name, len));
+  }
+
+  imports["glUniformBlockBinding"] = (data_id, index, binding) => {
+    let data = game.data[data_id];
+    if (!data || data.type != types.sprog) return;
+    game.gl.uniformBlockBinding(data.program, index, binding);
+  }
+
   // Shader uniforms
 
-  imports["glUniform1i"] = (loc_id, v0) => {
+  imports["js_glUniform1i"] = (loc_id, v0) => {
     let data = game.data[loc_id];
     if (!data || data.type != types.uniform) return 0;
     game.gl.uniform1i(data.location, v0);
   }
 
-  imports["glUniform2fv"] = (loc_id, count, ptr) => {
+  imports["js_glUniform2fv"] = (loc_id, count, ptr) => {
     let data = game.data[loc_id];
     if (!data || data.type != types.uniform) return 0;
     let bytes = game.memory_f(ptr, count * 2);
     game.gl.uniform2fv(data.location, bytes, 0);
   }
 
-  imports["glUniform3fv"] = (loc_id, count, ptr) => {
+  imports["js_glUniform3fv"] = (loc_id, count, ptr) => {
     let data = game.data[loc_id];
     if (!data || data.type != types.uniform) return 0;
     let bytes = game.memory_f(ptr, count * 3);
     game.gl.uniform3fv(data.location, bytes, 0);
   }
 
-  imports["glUniform4fv"] = (loc_id, count, ptr) => {
+  imports["js_glUniform4fv"] = (loc_id, count, ptr) => {
     let data = game.data[loc_id];
     if (!data || data.type != types.uniform) return 0;
     let bytes = game.memory_f(ptr, count * 4);
     game.gl.uniform4fv(data.location, bytes, 0);
   }
 
-  imports["glUniformMatrix4fv"] = (loc_id, count, transpose, ptr) => {
+  imports["js_glUniformMatrix4fv"] = (loc_id, count, transpose, ptr) => {
     let data = game.data[loc_id];
     if (!data || data.type != types.uniform) return 0;
     let bytes = game.memory_f(ptr, count * 16);
@@ -202,7 +253,7 @@ function wasm_import_gl(imports, game) {
     });
   }
 
-  imports["glBindBuffer"] = (target, data_id) => {
+  imports["js_glBindBuffer"] = (target, data_id) => {
     let buffer_obj = null;
     if (data_id != 0) {
       let data = game.data[data_id];
@@ -212,15 +263,29 @@ function wasm_import_gl(imports, game) {
     game.gl.bindBuffer(target, buffer_obj);
   }
 
+  imports["glBindBufferBase"] = (target, index, data_id) => {
+    let buffer_obj = null;
+    if (data_id != 0) {
+      let data = game.data[data_id];
+      if (!data || data.type != types.buffer) return;
+      buffer_obj = data.buffer;
+    }
+    game.gl.bindBufferBase(target, index, buffer_obj);
+  }
+
   imports["glBufferData"] = (target, size, src, usage) => {
-    game.gl.bufferData(target, game.memory(src, size), usage);
+    if (src == 0) {
+      game.gl.bufferData(target, size, usage);
+    } else {
+      game.gl.bufferData(target, game.memory(src, size), usage);
+    }
   }
 
   imports["glBufferSubData"] = (target, offset, size, src) => {
     game.gl.bufferSubData(target, offset, game.memory(src, size));
   }
 
-  imports["glDeleteBuffer"] = (data_id) => {
+  imports["js_glDeleteBuffer"] = (data_id) => {
     let data = game.data[data_id];
     if (!data || data.type != types.buffer) return;
     game.gl.deleteBuffer(data.buffer);
@@ -235,54 +300,54 @@ function wasm_import_gl(imports, game) {
     })
   }
 
-  imports["glBindVertexArray"] = (data_id) => {
+  imports["js_glBindVertexArray"] = (data_id) => {
     let data = game.data[data_id];
     if (!data || data.type != types.vao) return;
     game.gl.bindVertexArray(data.vao);
   }
 
-  imports["glDeleteVertexArray"] = (data_id) => {
+  imports["js_glDeleteVertexArray"] = (data_id) => {
     let data = game.data[data_id];
     if (!data || data.type != types.vao) return;
     game.gl.deleteVertexArray(data.vao);
     game.free(data_id);
   }
 
-  imports["glVertexAttribDivisor"] = (index, divisor) => {
+  imports["js_glVertexAttribDivisor"] = (index, divisor) => {
     game.gl.vertexAttribDivisor(index, divisor);
   }
 
-  imports["glVertexAttribPointer"] = (index, size, type, norm, stride, ptr) => {
-    game.gl.vertexAttribPointer(index, size, type, norm, stride, ptr);
+  imports["js_glVertexAttribPointer"] = (i, size, type, norm, stride, p) => {
+    game.gl.vertexAttribPointer(i, size, type, norm, stride, p);
   }
 
-  imports["glVertexAttribIPointer"] = (index, size, type, stride, ptr) => {
+  imports["js_glVertexAttribIPointer"] = (index, size, type, stride, ptr) => {
     game.gl.vertexAttribIPointer(index, size, type, stride, ptr);
   }
 
-  imports["glEnableVertexAttribArray"] = (index) => {
+  imports["js_glEnableVertexAttribArray"] = (index) => {
     game.gl.enableVertexAttribArray(index);
   }
 
-  imports["glDisableVertexAttribArray"] = (index) => {
+  imports["js_glDisableVertexAttribArray"] = (index) => {
     game.gl.disableVertexAttribArray(index);
   }
 
-  imports["glDrawArrays"] = (mode, first, count) => {
+  imports["js_glDrawArrays"] = (mode, first, count) => {
     game.gl.drawArrays(mode, first, count);
   }
 
-  imports["glDrawElements"] = (mode, count, type, index_offset) => {
+  imports["js_glDrawElements"] = (mode, count, type, index_offset) => {
     game.gl.drawElements(mode, count, type, index_offset);
   }
 
-  imports["glDrawArraysInstanced"] = (
+  imports["js_glDrawArraysInstanced"] = (
     mode, first, count, prim_count
   ) => {
     game.gl.drawArraysInstanced(mode, first, count, prim_count);
   }
 
-  imports["glDrawElementsInstanced"] = (
+  imports["js_glDrawElementsInstanced"] = (
     mode, count, type, ind_offset, prim_count
   ) => {
     game.gl.drawElementsInstanced(mode, count, type, ind_offset, prim_count);
@@ -298,11 +363,11 @@ function wasm_import_gl(imports, game) {
     })
   }
 
-  imports["glActiveTexture"] = (texture) => {
+  imports["js_glActiveTexture"] = (texture) => {
     game.gl.activeTexture(texture);
   }
 
-  imports["glBindTexture"] = (target, data_id) => {
+  imports["js_glBindTexture"] = (target, data_id) => {
     let texture = null;
     if (data_id != null && data_id != 0) {
       let data = game.data[data_id];
@@ -345,6 +410,44 @@ function wasm_import_gl(imports, game) {
             target, level, iFmt, width, height, 0, fmt, sType, buffer
           );
         }
+        else if (sType == game.gl.UNSIGNED_INT) {
+          let buffer = game.memory_i(data.buffer.begin, data.buffer.size / 4);
+          game.gl.texImage2D(
+            target, level, iFmt, width, height, 0, fmt, sType, buffer
+          );
+        }
+        else {
+          console.log("Unknown buffer vs data type match");
+        }
+      break;
+      default: return;
+    }
+  }
+
+  imports["glTexSubImage2D"] = (
+    target, level, x, y, w, h, fmt, type, data_id
+  ) => {
+    let data = game.data[data_id];
+    if (!data || !data.ready) return;
+
+    switch (data.type) {
+      case types.image:
+        game.gl.texSubImage2D(target, level, x, y, fmt, type, data.image);
+      break;
+      case types.bytes:
+        if (type == game.gl.BYTE || type == game.gl.UNSIGNED_BYTE) {
+          game.gl.texSubImage2D(
+            target, level, x, y, w, h, fmt, type, data.get_buffer()
+          );
+        }
+        else if (type == game.gl.FLOAT) {
+          let buffer = game.memory_f(data.buffer.begin, data.buffer.size / 4);
+          game.gl.texSubImage2D(target, level, x, y, w, h, fmt, type, buffer);
+        }
+        else if (type == game.gl.UNSIGNED_INT) {
+          let buffer = game.memory_i(data.buffer.begin, data.buffer.size / 4);
+          game.gl.texSubImage2D(target, level, x, y, w, h, fmt, type, buffer);
+        }
         else {
           console.log("Unknown buffer vs data type match");
         }
@@ -379,15 +482,23 @@ function wasm_import_gl(imports, game) {
     }
   }
 
-  imports["glGenerateMipmap"] = (target) => {
+  imports["glCompressedTexSubImage3D"] = (
+    target, level, x, y, z, w, h, d, fmt, size, src
+  ) => {
+    game.gl.compressedTexSubImage3D(
+      target, level, x, y, z, w, h, d, fmt, game.memory(src, size)
+    );
+  }
+
+  imports["js_glGenerateMipmap"] = (target) => {
     game.gl.generateMipmap(target);
   }
 
-  imports["glTexParameteri"] = (target, pname, param) => {
+  imports["js_glTexParameteri"] = (target, pname, param) => {
     game.gl.texParameteri(target, pname, param);
   }
 
-  imports["glPixelStorei"] = (pname, param) => {
+  imports["js_glPixelStorei"] = (pname, param) => {
     game.gl.pixelStorei(pname, param);
   }
 
@@ -408,7 +519,7 @@ function wasm_import_gl(imports, game) {
     });
   }
 
-  imports["glBindFramebuffer"] = (target, framebuffer) => {
+  imports["js_glBindFramebuffer"] = (target, framebuffer) => {
     let fbo = null;
     if (framebuffer != 0) {
       let data = game.data[framebuffer];
@@ -457,7 +568,7 @@ function wasm_import_gl(imports, game) {
     });
   }
 
-  imports["glBindRenderbuffer"] = (target, renderbuffer) => {
+  imports["js_glBindRenderbuffer"] = (target, renderbuffer) => {
     let rbo = null;
     if (renderbuffer != 0) {
       let data = game.data[renderbuffer];
@@ -482,6 +593,99 @@ function wasm_import_gl(imports, game) {
     game.gl.drawBuffers(Array.from(game.memory_i(ptr, n)));
   }
 
+  // Command batching (see src/wasm/gl.c)
+
+  // Replay table indexed by opcode, in the same order as gl_op_t. Each letter
+  //    of the signature reads one argument word as an int (i) or a float (f).
+  const ops = [
+    [imports["js_glViewport"], "iiii"],
+    [imports["js_glEnable"], "i"],
+    [imports["js_glDisable"], "i"],
+    [imports["js_glBlendFunc"], "ii"],
+    [imports["js_glClear"], "i"],
+    [imports["js_glClearColor"], "ffff"],
+    [imports["js_glUseProgram"], "i"],
+    [imports["js_glUniform1i"], "ii"],
+    [imports["js_glUniform2fv"], "iii"],
+    [imports["js_glUniform3fv"], "iii"],
+    [imports["js_glUniform4fv"], "iii"],
+    [imports["js_glUniformMatrix4fv"], "iiii"],
+    [imports["js_glBindBuffer"], "ii"],
+    [imports["js_glBindVertexArray"], "i"],
+    [imports["js_glVertexAttribPointer"], "iiiiii"],
+    [imports["js_glVertexAttribIPointer"], "iiiii"],
+    [imports["js_glEnableVertexAttribArray"], "i"],
+    [imports["js_glDisableVertexAttribArray"], "i"],
+    [imports["js_glVertexAttribDivisor"], "ii"],
+    [imports["js_glDrawArrays"], "iii"],
+    [imports["js_glDrawElements"], "iiii"],
+    [imports["js_glDrawArraysInstanced"], "iiii"],
+    [imports["js_glDrawElementsInstanced"], "iiiii"],
+    [imports["js_glActiveTexture"], "i"],
+    [imports["js_glBindTexture"], "ii"],
+    [imports["js_glGenerateMipmap"], "i"],
+    [imports["js_glTexParameteri"], "iii"],
+    [imports["js_glPixelStorei"], "ii"],
+    [imports["js_glBindFramebuffer"], "ii"],
+    [imports["js_glBindRenderbuffer"], "ii"],
+  ];
+
+  imports["js_gl_flush"] = (ptr, words) => {
+    const buffer = game.wasm.exports.memory.buffer;
+    const i32 = new Int32Array(buffer, ptr, words);
+    const f32 = new Float32Array(buffer, ptr, words);
+    const args = [];
+
+    for (let i = 0; i < words;) {
+      const [fn, sig] = ops[i32[i] & 0xffff];
+      args.length = sig.length;
+      for (let a = 0; a < sig.length; ++a) {
+        args[a] = sig[a] == "f" ? f32[i + 1 + a] : i32[i + 1 + a];
+      }
+      fn(...args);
+      i += i32[i] >>> 16;
+    }
+  }
+
+  let batching = false;
+  game.gl_crossings = 0;
+  game.gl_crossings_last = 0;
+
+  imports["js_gl_batch_enable"] = (enable) => {
+    batching = enable != 0;
+  }
+
+  imports["js_gl_crossings_take"] = () => {
+    game.gl_crossings_last = game.gl_crossings;
+    game.gl_crossings = 0;
+    return game.gl_crossings_last;
+  }
+
+  // Count every crossing into the bindings above. While batching, anything
+  //    that isn't recorded replays the pending batch first to keep call order.
+  const batched = new Set(ops.map((op) => op[0]));
+  const internal = new Set([
+    "js_gl_flush", "js_gl_batch_enable", "js_gl_crossings_take"
+  ]);
+
+  for (const name of Object.keys(imports)) {
+    if (existing.has(name) || internal.has(name)) continue;
+    const fn = imports[name];
+    const recorded = batched.has(fn);
+
+    imports[name] = (...args) => {
+      ++game.gl_crossings;
+      if (batching && !recorded) game.wasm.exports.gl_batch_flush();
+      return fn(...args);
+    }
+  }
+
+  const flush = imports["js_gl_flush"];
+  imports["js_gl_flush"] = (ptr, words) => {
+    ++game.gl_crossings;
+    flush(ptr, words);
+  }
+
 }
 
 export { wasm_import_gl };
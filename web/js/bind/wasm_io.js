@@ -22,6 +22,12 @@ function wasm_import_stdio(imports, game) {
 
     data.buffer = await res.arrayBuffer();
 
+    // the file was deleted while the fetch was in flight
+    if (data.closed) {
+      --game.await_count;
+      return;
+    }
+
     console.log(`  Loaded File (${data_id}): ${data.buffer.byteLength} bytes`);
 
     data.ready = true;
@@ -30,20 +36,19 @@ function wasm_import_stdio(imports, game) {
     game.wasm.exports.file_open_async_done(data.wasm_ptr, data.buffer.byteLength);
   }
 
-  imports['js_file_read'] = (data_id, ptr, size) => {
+  imports['js_file_read'] = (data_id, ptr, offset, size) => {
     let data = game.data[data_id];
     if (!data || data.type != types.file || !data.ready) return false;
-    let src = new Uint8Array(data.buffer);
-    let dst = game.memory(ptr, size);
-    for (let i = 0; i < size; ++i) {
-      dst[i] = src[i];
-    }
+    if (offset + size > data.buffer.byteLength) return false;
+    let src = new Uint8Array(data.buffer, offset, size);
+    game.memory(ptr, size).set(src);
     return true;
   }
 
   imports['js_file_close'] = (data_id) => {
     let data = game.data[data_id];
     if (!data || data.type != types.file) return;
+    data.closed = true;
     if (data.ready == true) delete data.buffer;
     game.free(data_id);
   }
@@ -11,13 +11,14 @@ function render_timer(now) {
   game.frame_time = now;
 
   document.getElementById('console').textContent = `
-    WASM GL Test - FPS: ${Math.floor(fps)}
+    WASM GL Test - FPS: ${Math.floor(fps)}, GL calls: ${game.gl_crossings_last}
   `;
 
   wasp_loading_manager();
 
   wasp_update(game.handle, dt);
   wasp_render(game.handle);
+  game.wasm.exports.wasm_gl_frame_end();
 
   let err = gl.getError();
   if (err != gl.NO_ERROR) {
@@ -38,6 +39,11 @@ window.onload = async() => {
     let canvas = game.gl.canvas;
     game.handle = game.wasm.exports.game_init(canvas.width, canvas.height);
 
+    // Opt into batched GL calls with ?gl_batch in the page URL
+    if (new URLSearchParams(window.location.search).has("gl_batch")) {
+      game.wasm.exports.gl_batch_enable(1);
+    }
+
     if (!game.wasm.exports.wasp_load(game.handle)) {
       console.log("[Main.onload] Error: Failed on initial loading");
       return;
@@ -5,13 +5,32 @@ in highp vec2 vUV;
 
 out highp vec4 frag_color;
 
-uniform mat4 in_proj_inverse;
+// Per-frame values shared by all shaders, see gfx_update_frame
+layout(std140) uniform FrameConstants {
+  highp mat4  in_pv_matrix;
+  highp mat4  in_view_matrix;
+  highp mat4  in_proj_matrix;
+  highp mat4  in_proj_inverse;
+  highp vec2  in_resolution;
+  highp float in_time;
+  highp float in_frame_time;
+};
 
 uniform sampler2D samp_tex;
 uniform sampler2D samp_norm;
 uniform sampler2D samp_prop;
 uniform sampler2D samp_depth;
 uniform sampler2D samp_light;
+uniform int in_light_count;
+
+// Clustered light lists: the grid holds (offset, count) into the index list
+//    for each screen tile/depth slice, in_cluster_depth maps log(view depth)
+//    to a slice index.
+uniform highp usampler2D samp_light_grid;
+uniform highp usampler2D samp_light_index;
+uniform vec3 in_cluster_dims;
+uniform vec2 in_cluster_depth;
+uniform int in_cluster_enabled;
 
 #define PI 3.141592653589
 
@@ -93,6 +112,26 @@ LightColor get_light_color(int i) {
   return LightColor(T.xyz, T.w);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Light clusters
+
+uvec2 get_light_cluster(vec2 uv, float view_depth) {
+  ivec3 dims = ivec3(in_cluster_dims);
+  float slice = log(max(view_depth, 1e-4)) * in_cluster_depth.x;
+  ivec3 cell = ivec3(
+    int(uv.x * in_cluster_dims.x),
+    int(uv.y * in_cluster_dims.y),
+    int(floor(slice + in_cluster_depth.y))
+  );
+  cell = clamp(cell, ivec3(0), dims - 1);
+  return texelFetch(samp_light_grid, ivec2(cell.x, cell.y + cell.z * dims.y), 0).xy;
+}
+
+int get_light_index(int n) {
+  int width = textureSize(samp_light_index, 0).x;
+  return int(texelFetch(samp_light_index, ivec2(n % width, n / width), 0).r);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Geometric functions
 
@@ -141,9 +180,18 @@ void main() {
   vec3 F0 = mix(vec3(0.04), albedo.xyz, metallic);
   vec3 result = vec3(0.0);
 
-  // Run PBR lighting calaculations for each light in the scene
-  int light_buffer_size = textureSize(samp_light, 0).y;
-  for (int i = 0; i < light_buffer_size; ++i) {
+  // Only walk the lights binned into this fragment's cluster when available
+  int light_offset = 0;
+  int light_total = in_light_count;
+  if (in_cluster_enabled != 0) {
+    uvec2 cluster = get_light_cluster(uv, -frag_pos.z);
+    light_offset = int(cluster.x);
+    light_total = int(cluster.y);
+  }
+
+  // Run PBR lighting calaculations for each light affecting the fragment
+  for (int n = 0; n < light_total; ++n) {
+    int i = in_cluster_enabled != 0 ? get_light_index(light_offset + n) : n;
     Light light;
     light.transform = get_light_transform(i);
     vec3 light_center = light.transform.pos;
@@ -265,7 +313,7 @@ void main() {
   //*/
 
   /* // Test render the lights texture
-  ivec2 test = ivec2(int(uv.x * 3.0), int(uv.y * float(light_buffer_size)));
+  ivec2 test = ivec2(int(uv.x * 3.0), int(uv.y * float(in_light_count)));
   frag_color = texelFetch(samp_light, test, 0);
   //*/
 }
@@ -11,8 +11,16 @@ layout(location = 5 ) in mat4 model_matrix;
 layout(location = 9 ) in vec4 model_tint; // instance color
 layout(location = 10) in int  model_material_index;
 
-uniform mat4 in_pv_matrix;
-uniform mat4 in_view_matrix;
+// Per-frame values shared by all shaders, see gfx_update_frame
+layout(std140) uniform FrameConstants {
+  highp mat4  in_pv_matrix;
+  highp mat4  in_view_matrix;
+  highp mat4  in_proj_matrix;
+  highp mat4  in_proj_inverse;
+  highp vec2  in_resolution;
+  highp float in_time;
+  highp float in_frame_time;
+};
 
 out vec4 vNormal;
 out vec2 vUV;
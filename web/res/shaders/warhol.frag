@@ -5,7 +5,16 @@ in vec2 vUV;
 
 out vec4 frag_color;
 
-uniform mat4 in_proj_inverse;
+// Per-frame values shared by all shaders, see gfx_update_frame
+layout(std140) uniform FrameConstants {
+  highp mat4  in_pv_matrix;
+  highp mat4  in_view_matrix;
+  highp mat4  in_proj_matrix;
+  highp mat4  in_proj_inverse;
+  highp vec2  in_resolution;
+  highp float in_time;
+  highp float in_frame_time;
+};
 
 uniform sampler2D samp_tex;
 uniform sampler2D samp_norm;